@@ -7,6 +7,10 @@
 #include <assert.h>
 #include <cstdio>
 #include "AQueue.h"
+#include "Small_Array.h"
+#include "StaticArray.h"
+#include "COW_Array.h"
+#include <memory_resource>
 
 // typedef AQueue<char, std::vector > AQUEUE;
 typedef AQueue<char> AQUEUE;
@@ -249,6 +253,113 @@ testSwap (void)
   assert (a2 == a3);
 }
 
+void
+testSmallArrayQueue (void)
+{
+  std::cout << "--Testing AQueue over a Small_Array.--\n\n";
+
+  // 10 items + the dummy slot fit inline, so the queue never allocates.
+  typedef AQueue<char, Small_Array<char, 11> > SMALL_AQUEUE;
+
+  SMALL_AQUEUE q1 (10);
+
+  while (!q1.is_full ())
+    q1.enqueue ('s');
+
+  assert (q1.size () == 10);
+
+  SMALL_AQUEUE q2 (q1);
+  assert (q1 == q2);
+
+  q2.dequeue ();
+  q2.enqueue ('t');
+  q1.swap (q2);
+  assert (q2.front () == 's');
+  assert (q1.size () == 10);
+}
+
+void
+testStaticArrayQueue (void)
+{
+  std::cout << "--Testing AQueue over a StaticArray.--\n\n";
+
+  // 10 items + the dummy slot, all inline.
+  typedef AQueue<char, StaticArray<char, 11> > STATIC_AQUEUE;
+
+  STATIC_AQUEUE q1 (10);
+
+  while (!q1.is_full ())
+    q1.enqueue ('s');
+
+  assert (q1.size () == 10);
+
+  STATIC_AQUEUE q2 (q1);
+  assert (q1 == q2);
+
+  q2.dequeue ();
+  q2.enqueue ('t');
+  q1.swap (q2);
+  assert (q2.front () == 's');
+  assert (q1.size () == 10);
+
+  // Wrap around a few times.
+  for (int i = 0; i < 25; ++i)
+    {
+      q1.dequeue ();
+      q1.enqueue (char ('a' + i));
+    }
+  assert (q1.front () == 'a' + 15 && q1.is_full ());
+}
+
+void
+testArenaQueue (void)
+{
+  std::cout << "--Testing AQueue in a memory arena.--\n\n";
+
+  typedef std::pmr::polymorphic_allocator<char> ALLOC;
+  typedef AQueue<char, Array<char, ALLOC> > ARENA_AQUEUE;
+
+  char buffer[1024];
+  std::pmr::monotonic_buffer_resource arena (buffer, sizeof buffer,
+                                             std::pmr::null_memory_resource ());
+
+  ARENA_AQUEUE q1 (10, ALLOC (&arena));
+  q1.enqueue ('p');
+  q1.enqueue ('m');
+  q1.enqueue ('r');
+
+  ARENA_AQUEUE q2 (q1);
+  assert (q1 == q2);
+  assert (q2.front () == 'p');
+}
+
+void
+testSnapshotQueue (void)
+{
+  std::cout << "--Testing snapshots of a copy-on-write AQueue.--\n\n";
+
+  typedef AQueue<char, COW_Array<char> > COW_AQUEUE;
+
+  COW_AQUEUE q1 (1000);
+  for (int i = 0; i < 500; ++i)
+    q1.enqueue ('a' + i % 26);
+
+  // The snapshot shares the buffer until either queue enqueues.
+  const COW_AQUEUE snapshot (q1);
+  assert (snapshot == q1);
+
+  q1.dequeue ();
+  q1.enqueue ('z');
+  assert (snapshot.size () == 500);
+  assert (snapshot.front () == 'a');
+  assert (q1.front () == 'b');
+
+  COW_AQUEUE q2 (snapshot);
+  q2.enqueue ('y');
+  assert (q2.size () == 501);
+  assert (snapshot.size () == 500);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -276,6 +387,10 @@ main (int argc, char *argv[])
   delete [] queues;
 
   testSwap ();
+  testSmallArrayQueue ();
+  testStaticArrayQueue ();
+  testArenaQueue ();
+  testSnapshotQueue ();
 
   // you can comment out the following trycatch block to isolate
   // problems to the above tests (constructors, dequeues, and iterators).
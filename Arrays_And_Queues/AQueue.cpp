@@ -27,6 +27,14 @@ AQueue<T, ARRAY>::AQueue (size_t size) : queue_(ARRAY(size+1)), head_(0), tail_(
 {
 }
 
+// Constructor with an allocator for the queue's storage.
+
+template <typename T, typename ARRAY> 
+template <typename ALLOC>
+AQueue<T, ARRAY>::AQueue (size_t size, const ALLOC &alloc) : queue_(size+1, alloc), head_(0), tail_(0), count_(0) // +1 for the dummy node
+{
+}
+
 // Copy constructor.
 
 template <typename T, typename ARRAY> 
@@ -96,7 +104,9 @@ void
 AQueue<T, ARRAY>::enqueue (const T &new_item)
 {
     if (count_ == queue_.size()-1) throw Overflow();
-    queue_[tail_] = new_item;
+    // set() rather than operator[], so a copy-on-write ARRAY only
+    // detaches its buffer instead of also making it unshareable.
+    queue_.set (new_item, tail_);
     tail_ = increment(tail_);
     ++count_;
     /*
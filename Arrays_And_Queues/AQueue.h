@@ -43,6 +43,13 @@ public:
   // Constructor.
   AQueue (size_t size);
 
+  // Constructor whose storage is obtained from <alloc>, e.g., an
+  // AQueue<T, Array<T, std::pmr::polymorphic_allocator<T> > > whose
+  // buffer lives in a request's memory arena.  Requires an <ARRAY>
+  // constructor taking (size, alloc).
+  template <typename ALLOC>
+  AQueue (size_t size, const ALLOC &alloc);
+
   // Copy constructor.
   AQueue (const AQueue<T, ARRAY> &rhs);
 
@@ -0,0 +1,641 @@
+/* -*- C++ -*- */
+
+// Benchmarks for class Array<>.  Build with "make bench".
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <utility>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+#include "Array.h"
+#include "Array_SIMD.h"
+#include "Array_Huge_Page_Allocator.h"
+#include "SortedArray.h"
+#include "FlatMap.h"
+#include "Bit_Array.h"
+#include "Compressed_Array.h"
+#include "Hash_Map.h"
+
+// An element type that counts how often it is copied and moved.
+class Tracked
+{
+public:
+  Tracked (void) : payload_ () {}
+
+  explicit Tracked (size_t len) : payload_ (len, 'p') {}
+
+  Tracked (const Tracked &rhs) : payload_ (rhs.payload_) { ++copies; }
+
+  Tracked (Tracked &&rhs) noexcept : payload_ (std::move (rhs.payload_)) { ++moves; }
+
+  Tracked &operator= (const Tracked &rhs)
+  {
+    payload_ = rhs.payload_;
+    ++copies;
+    return *this;
+  }
+
+  Tracked &operator= (Tracked &&rhs) noexcept
+  {
+    payload_ = std::move (rhs.payload_);
+    ++moves;
+    return *this;
+  }
+
+  static void reset (void) { copies = moves = 0; }
+
+  static size_t copies;
+  static size_t moves;
+
+private:
+  std::string payload_;
+};
+
+size_t Tracked::copies = 0;
+size_t Tracked::moves = 0;
+
+typedef std::chrono::steady_clock CLOCK;
+
+static double
+elapsed_ms (CLOCK::time_point start)
+{
+  return std::chrono::duration<double, std::milli> (CLOCK::now () - start).count ();
+}
+
+static void
+report (const char *name, double ms)
+{
+  std::cout << std::left << std::setw (40) << name
+            << std::right << std::setw (10) << Tracked::copies << " copies"
+            << std::setw (10) << Tracked::moves << " moves"
+            << std::setw (12) << std::fixed << std::setprecision (2) << ms << " ms\n";
+}
+
+// Compare building, growing and reassigning an array of heavy
+// elements through the copying and the moving interfaces.
+static void
+benchMoves (size_t count, size_t payload)
+{
+  std::cout << "\n== Copies vs. moves, " << count << " elements of "
+            << payload << " bytes ==\n";
+
+  {
+    Tracked::reset ();
+    CLOCK::time_point start = CLOCK::now ();
+    Array<Tracked> a (0);
+    for (size_t i = 0; i < count; ++i)
+      {
+        Tracked t (payload);
+        a.set (t, i);
+      }
+    Array<Tracked> b (0);
+    b = a;
+    Array<Tracked> c (b);
+    report ("set(const T&) + copy assign", elapsed_ms (start));
+  }
+
+  {
+    Tracked::reset ();
+    CLOCK::time_point start = CLOCK::now ();
+    Array<Tracked> a (0);
+    for (size_t i = 0; i < count; ++i)
+      a.set (Tracked (payload), i);
+    Array<Tracked> b (0);
+    b = std::move (a);
+    Array<Tracked> c (std::move (b));
+    report ("set(T&&) + move assign", elapsed_ms (start));
+  }
+
+  {
+    Tracked::reset ();
+    CLOCK::time_point start = CLOCK::now ();
+    Array<Tracked> a (0);
+    for (size_t i = 0; i < count; ++i)
+      a.emplace (i, payload);
+    report ("emplace", elapsed_ms (start));
+  }
+}
+
+// Print one line of a bulk-operation comparison.
+static void
+report_bulk (const char *name, size_t bytes, size_t reps, double old_ms, double new_ms)
+{
+  double mb = double (bytes) * reps / (1024.0 * 1024.0);
+  std::cout << std::left << std::setw (10) << name
+            << std::right << std::fixed << std::setprecision (1)
+            << std::setw (12) << mb / (old_ms / 1000.0) << " MB/s"
+            << std::setw (12) << mb / (new_ms / 1000.0) << " MB/s"
+            << std::setw (9) << old_ms / new_ms << "x\n";
+}
+
+// Compare the bulk copy/compare/fill paths of Array<char> with the
+// element-at-a-time, range-checked loops that Array used before.
+static void
+benchBulk (size_t max_bytes)
+{
+  std::cout << "\n== Element-wise (old) vs. bulk (new) paths for Array<char> ==\n";
+
+  for (size_t bytes = 1024; bytes <= max_bytes; bytes *= 32)
+    {
+      // Touch about 256 MB per measurement so small sizes are timed
+      // over many repetitions.
+      const size_t reps = std::max<size_t> (1, (256u << 20) / bytes);
+      std::cout << "-- " << bytes << " bytes x " << reps << "\n";
+
+      Array<char> src (bytes, 'x');
+      Array<char> dst (src);
+      volatile size_t sink = 0;
+
+      CLOCK::time_point start = CLOCK::now ();
+      for (size_t r = 0; r < reps; ++r)
+        {
+          Array<char> copy (bytes);
+          for (size_t i = 0; i < bytes; ++i)
+            copy.at (i) = src.at (i);
+          sink = sink + copy[r % bytes];
+        }
+      double old_ms = elapsed_ms (start);
+
+      start = CLOCK::now ();
+      for (size_t r = 0; r < reps; ++r)
+        {
+          Array<char> copy (src);
+          sink = sink + copy[r % bytes];
+        }
+      report_bulk ("copy", bytes, reps, old_ms, elapsed_ms (start));
+
+      start = CLOCK::now ();
+      for (size_t r = 0; r < reps; ++r)
+        {
+          bool equal = true;
+          for (size_t i = 0; i < bytes && equal; ++i)
+            equal = src.at (i) == dst.at (i);
+          sink = sink + equal;
+        }
+      old_ms = elapsed_ms (start);
+
+      start = CLOCK::now ();
+      for (size_t r = 0; r < reps; ++r)
+        sink = sink + (src == dst);
+      report_bulk ("equal", bytes, reps, old_ms, elapsed_ms (start));
+
+      start = CLOCK::now ();
+      for (size_t r = 0; r < reps; ++r)
+        {
+          Array<char> filled (bytes);
+          for (size_t i = 0; i < bytes; ++i)
+            filled.at (i) = 'd';
+          sink = sink + filled[r % bytes];
+        }
+      old_ms = elapsed_ms (start);
+
+      start = CLOCK::now ();
+      for (size_t r = 0; r < reps; ++r)
+        {
+          Array<char> filled (bytes, 'd');
+          sink = sink + filled[r % bytes];
+        }
+      report_bulk ("fill", bytes, reps, old_ms, elapsed_ms (start));
+    }
+}
+
+// Compare scans of an Array<float> through the checked at() with the
+// SIMD kernels of each instruction set this CPU supports.
+static void
+benchSIMD (size_t max_bytes)
+{
+  const size_t n = std::min<size_t> (max_bytes, 64u << 20) / sizeof (float);
+  const size_t reps = std::max<size_t> (1, (512u << 20) / (n * sizeof (float)));
+  std::cout << "\n== SIMD kernels, Array<float> of " << n << " elements x "
+            << reps << " ==\n";
+
+  Array<float> a (n, 1.0f);
+  Array<float> b (a);
+  volatile float sink = 0;
+
+  CLOCK::time_point start = CLOCK::now ();
+  for (size_t r = 0; r < reps; ++r)
+    {
+      float s = 0;
+      for (size_t i = 0; i < n; ++i)
+        s += a.at (i);
+      sink = sink + s;
+    }
+  const double sum_ms = elapsed_ms (start);
+
+  start = CLOCK::now ();
+  for (size_t r = 0; r < reps; ++r)
+    {
+      size_t c = 0;
+      for (size_t i = 0; i < n; ++i)
+        c += a.at (i) == 2.0f;
+      sink = sink + c;
+    }
+  const double count_ms = elapsed_ms (start);
+
+  start = CLOCK::now ();
+  for (size_t r = 0; r < reps; ++r)
+    {
+      float s = 0;
+      for (size_t i = 0; i < n; ++i)
+        s += a.at (i) * b.at (i);
+      sink = sink + s;
+    }
+  const double dot_ms = elapsed_ms (start);
+
+  for (int isa = Array_SIMD::SCALAR; isa <= Array_SIMD::best_isa (); ++isa)
+    {
+      const Array_SIMD_Kernels<float> &k = Array_SIMD::kernels<float> (Array_SIMD::ISA (isa));
+      std::cout << "-- " << Array_SIMD::isa_name (Array_SIMD::ISA (isa)) << "\n";
+
+      start = CLOCK::now ();
+      for (size_t r = 0; r < reps; ++r)
+        sink = sink + k.sum (a.data (), n);
+      report_bulk ("sum", n * sizeof (float), reps, sum_ms, elapsed_ms (start));
+
+      start = CLOCK::now ();
+      for (size_t r = 0; r < reps; ++r)
+        sink = sink + k.count (a.data (), n, 2.0f);
+      report_bulk ("count", n * sizeof (float), reps, count_ms, elapsed_ms (start));
+
+      start = CLOCK::now ();
+      for (size_t r = 0; r < reps; ++r)
+        sink = sink + k.dot (a.data (), b.data (), n);
+      report_bulk ("dot", n * sizeof (float), reps, dot_ms, elapsed_ms (start));
+    }
+}
+
+// Measure how construction with a default, copying, transform and
+// reduce of a large Array<double> scale with the number of threads.
+// Each line compares one thread (old) with <threads> threads (new).
+static void
+benchParallel (size_t max_bytes)
+{
+  const size_t n = std::min<size_t> (max_bytes, 256u << 20) / sizeof (double);
+  const size_t bytes = n * sizeof (double);
+  const size_t hardware = Array_Parallel_Policy ().threads ();
+  std::cout << "\n== Parallel paths, Array<double> of " << n << " elements, "
+            << hardware << " hardware threads ==\n";
+
+  const Array_Parallel_Policy old_defaults = Array_Parallel_Policy::defaults ();
+  volatile double sink = 0;
+  double one_ms[4] = { 0, 0, 0, 0 };
+  for (size_t threads = 1; threads <= std::max<size_t> (hardware, 4); threads *= 2)
+    {
+      const Array_Parallel_Policy policy (threads);
+      Array_Parallel_Policy::set_defaults (policy);
+      std::cout << "-- " << threads << " thread(s)\n";
+
+      CLOCK::time_point start = CLOCK::now ();
+      Array<double> a (n, 1.5);
+      double ms[4];
+      ms[0] = elapsed_ms (start);
+
+      start = CLOCK::now ();
+      Array<double> b (a);
+      ms[1] = elapsed_ms (start);
+      sink = sink + b[n / 2];
+
+      start = CLOCK::now ();
+      a.parallel_transform ([] (double x) { return x * 2.0 + 1.0; }, policy);
+      ms[2] = elapsed_ms (start);
+
+      start = CLOCK::now ();
+      sink = sink + a.parallel_reduce (0.0, [] (double x, double y) { return x + y; }, policy);
+      ms[3] = elapsed_ms (start);
+
+      static const char *const names[4] = { "fill", "copy", "transform", "reduce" };
+      for (int i = 0; i < 4; ++i)
+        {
+          if (threads == 1)
+            one_ms[i] = ms[i];
+          report_bulk (names[i], bytes, 1, one_ms[i], ms[i]);
+        }
+    }
+  Array_Parallel_Policy::set_defaults (old_defaults);
+}
+
+// Compare random lookups in a large Array<uint64_t> on ordinary pages
+// (old) and on huge pages (new).
+static void
+benchHugePages (size_t max_bytes)
+{
+  const size_t n = std::min<size_t> (max_bytes, 1024u << 20) / sizeof (uint64_t);
+  const size_t lookups = 1u << 24;
+  std::cout << "\n== Random lookups, Array<uint64_t> of " << n << " elements ==\n";
+
+  volatile uint64_t sink = 0;
+  Array<uint64_t> small (n, 1);
+  CLOCK::time_point start = CLOCK::now ();
+  uint64_t x = 88172645463325252ull, sum = 0;
+  for (size_t i = 0; i < lookups; ++i)
+    {
+      x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+      sum += small[x % n];
+    }
+  sink = sink + sum;
+  const double old_ms = elapsed_ms (start);
+
+  Array<uint64_t, Array_Huge_Page_Allocator<uint64_t> > huge (n, 1);
+  start = CLOCK::now ();
+  x = 88172645463325252ull;
+  sum = 0;
+  for (size_t i = 0; i < lookups; ++i)
+    {
+      x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+      sum += huge[x % n];
+    }
+  sink = sink + sum;
+  report_bulk ("lookup", lookups * sizeof (uint64_t), 1, old_ms, elapsed_ms (start));
+
+  const Array_Huge_Pages::Stats stats = Array_Huge_Pages::stats ();
+  std::cout << "huge pages: " << stats.hugetlb_pages << " hugetlb, "
+            << stats.transparent_pages << " transparent, "
+            << Array_Huge_Pages::backed_bytes (huge.data ()) / Array_Huge_Pages::HUGE_PAGE_SIZE
+            << " backed\n";
+}
+
+// Print one line of a comparison in millions of operations per second.
+static void
+report_ops (const char *name, size_t ops, double old_ms, double new_ms)
+{
+  std::cout << std::left << std::setw (10) << name
+            << std::right << std::fixed << std::setprecision (1)
+            << std::setw (12) << ops / (old_ms * 1000.0) << " M/s"
+            << std::setw (13) << ops / (new_ms * 1000.0) << " M/s"
+            << std::setw (9) << old_ms / new_ms << "x\n";
+}
+
+// Compare SortedArray and FlatMap with std::set and std::map: random
+// lookups (half of them misses), and inserting a batch of n/16 new
+// keys at once.
+static void
+benchSorted (size_t max_bytes)
+{
+  const size_t lookups = 1u << 22;
+  volatile size_t sink = 0;
+
+  for (size_t n = 1024; n * sizeof (uint64_t) <= max_bytes && n <= (4u << 20); n *= 32)
+    {
+      std::cout << "\n== " << n << " keys: std::set/map vs. SortedArray/FlatMap ==\n";
+
+      uint64_t x = 88172645463325252ull;
+      std::vector<uint64_t> keys (n), probes (lookups), batch (n / 16);
+      for (size_t i = 0; i < n; ++i)
+        {
+          x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+          keys[i] = x & ~1ull;
+        }
+      for (size_t i = 0; i < lookups; ++i)
+        probes[i] = keys[i % n] | (i & 1);
+      for (size_t i = 0; i < batch.size (); ++i)
+        batch[i] = keys[i * 16] | 1;
+
+      std::set<uint64_t> set (keys.begin (), keys.end ());
+      SortedArray<uint64_t> sorted (keys.begin (), keys.end ());
+      size_t hits = 0;
+      CLOCK::time_point start = CLOCK::now ();
+      for (size_t i = 0; i < lookups; ++i)
+        hits += set.count (probes[i]);
+      double old_ms = elapsed_ms (start);
+      start = CLOCK::now ();
+      for (size_t i = 0; i < lookups; ++i)
+        hits += sorted.contains (probes[i]);
+      report_ops ("set find", lookups, old_ms, elapsed_ms (start));
+
+      start = CLOCK::now ();
+      set.insert (batch.begin (), batch.end ());
+      old_ms = elapsed_ms (start);
+      start = CLOCK::now ();
+      sorted.insert (batch.begin (), batch.end ());
+      report_ops ("set batch", batch.size (), old_ms, elapsed_ms (start));
+
+      std::map<uint64_t, uint64_t> map;
+      std::vector<std::pair<uint64_t, uint64_t> > pairs (n);
+      for (size_t i = 0; i < n; ++i)
+        pairs[i] = std::make_pair (keys[i], i);
+      map.insert (pairs.begin (), pairs.end ());
+      FlatMap<uint64_t, uint64_t> flat (pairs.begin (), pairs.end ());
+      uint64_t sum = 0;
+      start = CLOCK::now ();
+      for (size_t i = 0; i < lookups; ++i)
+        {
+          std::map<uint64_t, uint64_t>::const_iterator j = map.find (probes[i]);
+          if (j != map.end ())
+            sum += j->second;
+        }
+      old_ms = elapsed_ms (start);
+      start = CLOCK::now ();
+      for (size_t i = 0; i < lookups; ++i)
+        if (const uint64_t *v = flat.find (probes[i]))
+          sum += *v;
+      report_ops ("map find", lookups, old_ms, elapsed_ms (start));
+
+      for (size_t i = 0; i < batch.size (); ++i)
+        pairs[i] = std::make_pair (batch[i], i);
+      start = CLOCK::now ();
+      map.insert (pairs.begin (), pairs.begin () + batch.size ());
+      old_ms = elapsed_ms (start);
+      start = CLOCK::now ();
+      flat.insert (pairs.begin (), pairs.begin () + batch.size ());
+      report_ops ("map batch", batch.size (), old_ms, elapsed_ms (start));
+
+      sink = sink + hits + sum + (set.size () == sorted.size () && map.size () == flat.size ());
+    }
+}
+
+// Compare a Bit_Array with an Array<bool> holding the same flags, one
+// in 64 of them set: counting the set flags, visiting each of them,
+// and combining two bitmaps.
+static void
+benchBits (size_t max_bytes)
+{
+  const size_t n = std::min<size_t> (max_bytes, 1024u << 20);
+  std::cout << "\n== " << n << " flags: Array<bool> (" << (n >> 20) << " MB) vs. Bit_Array ("
+            << (n >> 23) << " MB) ==\n";
+
+  Array<bool> flags (n, false), other (n, false);
+  Bit_Array<> bits (n), other_bits (n);
+  uint64_t x = 88172645463325252ull;
+  for (size_t i = 0; i < n / 64; ++i)
+    {
+      x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+      flags[x % n] = true;
+      bits.set (x % n);
+      other[i * 64] = true;
+      other_bits.set (i * 64);
+    }
+
+  volatile size_t sink = 0;
+  CLOCK::time_point start = CLOCK::now ();
+  size_t c = 0;
+  for (size_t i = 0; i < n; ++i)
+    c += flags[i];
+  double old_ms = elapsed_ms (start);
+  start = CLOCK::now ();
+  sink = sink + (c == bits.count ());
+  report_ops ("count", n, old_ms, elapsed_ms (start));
+
+  start = CLOCK::now ();
+  size_t sum = 0;
+  for (size_t i = 0; i < n; ++i)
+    if (flags[i])
+      sum += i;
+  old_ms = elapsed_ms (start);
+  start = CLOCK::now ();
+  for (size_t i = bits.find_first (); i != Bit_Array<>::npos; i = bits.find_next (i))
+    sum -= i;
+  report_ops ("scan", n, old_ms, elapsed_ms (start));
+  sink = sink + sum;
+
+  start = CLOCK::now ();
+  for (size_t i = 0; i < n; ++i)
+    flags[i] = flags[i] | other[i];
+  old_ms = elapsed_ms (start);
+  start = CLOCK::now ();
+  bits |= other_bits;
+  report_ops ("or", n, old_ms, elapsed_ms (start));
+  sink = sink + bits.count ();
+}
+
+// Compare a Compressed_Array of timestamps with gaps under 64 to the
+// same values in an Array<uint64_t>: random lookups, and summing them
+// in order by decoding a block at a time.
+static void
+benchCompressed (size_t max_bytes)
+{
+  const size_t n = std::min<size_t> (max_bytes, 512u << 20) / sizeof (uint64_t);
+  const size_t lookups = 1u << 24;
+
+  Array<uint64_t> plain (n);
+  Compressed_Array<uint64_t> packed;
+  uint64_t x = 88172645463325252ull, t = 1700000000000ull;
+  for (size_t i = 0; i < n; ++i)
+    {
+      x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+      t += x % 64;
+      plain[i] = t;
+      packed.append (t);
+    }
+  std::cout << "\n== " << n << " timestamps: Array (" << (n * sizeof (uint64_t) >> 20)
+            << " MB) vs. Compressed_Array (" << (packed.bytes () >> 20) << " MB) ==\n";
+
+  volatile uint64_t sink = 0;
+  uint64_t sum = 0;
+  CLOCK::time_point start = CLOCK::now ();
+  for (size_t i = 0; i < lookups; ++i)
+    {
+      x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+      sum += plain[x % n];
+    }
+  double old_ms = elapsed_ms (start);
+  start = CLOCK::now ();
+  for (size_t i = 0; i < lookups; ++i)
+    {
+      x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+      sum += packed[x % n];
+    }
+  report_ops ("lookup", lookups, old_ms, elapsed_ms (start));
+
+  start = CLOCK::now ();
+  for (size_t i = 0; i < n; ++i)
+    sum += plain[i];
+  old_ms = elapsed_ms (start);
+  start = CLOCK::now ();
+  uint64_t block[Compressed_Array<uint64_t>::block_size ()];
+  for (size_t i = 0; i < n; i += packed.block_size ())
+    {
+      const size_t run = std::min (packed.block_size (), n - i);
+      packed.decode (i, run, block);
+      for (size_t j = 0; j < run; ++j)
+        sum -= block[j];
+    }
+  report_bulk ("decode", n * sizeof (uint64_t), 1, old_ms, elapsed_ms (start));
+  sink = sink + sum;
+}
+
+// Compare Hash_Map with std::unordered_map: inserting random keys,
+// looking them up (half of the lookups miss), and erasing them.
+static void
+benchHashMap (size_t max_bytes)
+{
+  const size_t lookups = 1u << 22;
+
+  for (size_t n = 1024; n * 64 <= max_bytes && n <= (4u << 20); n *= 32)
+    {
+      std::cout << "\n== " << n << " keys: std::unordered_map vs. Hash_Map ==\n";
+
+      uint64_t x = 88172645463325252ull;
+      std::vector<uint64_t> keys (n), probes (lookups);
+      for (size_t i = 0; i < n; ++i)
+        {
+          x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+          keys[i] = x & ~1ull;
+        }
+      for (size_t i = 0; i < lookups; ++i)
+        probes[i] = keys[(i * 7919) % n] | (i & 1);
+
+      std::unordered_map<uint64_t, uint64_t> std_map;
+      Hash_Map<uint64_t, uint64_t> map;
+      CLOCK::time_point start = CLOCK::now ();
+      for (size_t i = 0; i < n; ++i)
+        std_map[keys[i]] = i;
+      double old_ms = elapsed_ms (start);
+      start = CLOCK::now ();
+      for (size_t i = 0; i < n; ++i)
+        map[keys[i]] = i;
+      report_ops ("insert", n, old_ms, elapsed_ms (start));
+
+      uint64_t sum = 0;
+      start = CLOCK::now ();
+      for (size_t i = 0; i < lookups; ++i)
+        {
+          std::unordered_map<uint64_t, uint64_t>::const_iterator j = std_map.find (probes[i]);
+          if (j != std_map.end ())
+            sum += j->second;
+        }
+      old_ms = elapsed_ms (start);
+      start = CLOCK::now ();
+      for (size_t i = 0; i < lookups; ++i)
+        if (const uint64_t *v = map.find (probes[i]))
+          sum -= *v;
+      report_ops ("find", lookups, old_ms, elapsed_ms (start));
+
+      start = CLOCK::now ();
+      for (size_t i = 0; i < n; ++i)
+        std_map.erase (keys[i]);
+      old_ms = elapsed_ms (start);
+      start = CLOCK::now ();
+      for (size_t i = 0; i < n; ++i)
+        map.erase (keys[i]);
+      report_ops ("erase", n, old_ms, elapsed_ms (start));
+
+      volatile uint64_t sink = sum + std_map.size () + map.size ();
+      (void) sink;
+    }
+}
+
+// Usage: Array-bench [max-megabytes]
+// The bulk comparison runs from 1 KB up to <max-megabytes> (1 GB by
+// default); each size needs roughly three times that much memory.
+int
+main (int argc, char *argv[])
+{
+  size_t max_mb = argc > 1 ? std::strtoul (argv[1], 0, 10) : 1024;
+
+  benchMoves (100000, 256);
+  benchBulk (max_mb << 20);
+  benchSIMD (max_mb << 20);
+  benchParallel (max_mb << 20);
+  benchHugePages (max_mb << 20);
+  benchSorted (max_mb << 20);
+  benchBits (max_mb << 20);
+  benchCompressed (max_mb << 20);
+  benchHashMap (max_mb << 20);
+
+  return 0;
+}
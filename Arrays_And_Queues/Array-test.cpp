@@ -0,0 +1,1750 @@
+/* -*- C++ -*- */
+
+// Exercises the capacity management of class Array<>.
+
+// Count allocations, so that testTelemetry can check the counters.
+#define ARRAY_TELEMETRY 1
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <stdexcept>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <cmath>
+#include <list>
+#include <type_traits>
+#include <memory_resource>
+#include <thread>
+#include <functional>
+#include <set>
+#include <map>
+#include <unordered_map>
+#include <string_view>
+#include <assert.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "Array.h"
+#include "Small_Array.h"
+#include "COW_Array.h"
+#include "Mapped_Array.h"
+#include "ArraySoA.h"
+#include "Array_SIMD.h"
+#include "Array_Aligned_Allocator.h"
+#include "Segmented_Array.h"
+#include "Array_Huge_Page_Allocator.h"
+#include "StaticArray.h"
+#include "SortedArray.h"
+#include "FlatMap.h"
+#include "Bit_Array.h"
+#include "Compressed_Array.h"
+#include "Hash_Map.h"
+
+typedef Array<char> ARRAY;
+
+// Counts every way an element can be initialized or written.
+class Counted
+{
+public:
+  Counted (void) { ++defaults; ++live; }
+  Counted (const Counted &) { ++copies; ++live; }
+  Counted &operator= (const Counted &) { ++assignments; return *this; }
+  ~Counted (void) { --live; }
+
+  static void reset (void) { defaults = copies = assignments = 0; }
+
+  static int defaults;
+  static int copies;
+  static int assignments;
+  static int live;
+};
+
+int Counted::defaults = 0;
+int Counted::copies = 0;
+int Counted::assignments = 0;
+int Counted::live = 0;
+
+// Append <count> items one at a time via set() and return the number
+// of times the underlying buffer had to be reallocated.
+static size_t
+fill_by_set (ARRAY &a, size_t count)
+{
+  size_t reallocations = 0;
+
+  for (size_t i = 0; i < count; ++i)
+    {
+      size_t old_capacity = a.capacity ();
+      a.set ('a' + i % 26, i);
+      if (a.capacity () != old_capacity)
+        ++reallocations;
+    }
+
+  return reallocations;
+}
+
+void testGrowthPolicies (void)
+{
+  std::cout << "--Testing growth policies--\n";
+
+  ARRAY doubling (0);
+  assert (fill_by_set (doubling, 1000) <= 11);
+  assert (doubling.size () == 1000);
+  assert (doubling.capacity () >= 1000);
+
+  ARRAY one_and_half (0, Array_Growth_Policy::one_and_half ());
+  assert (fill_by_set (one_and_half, 1000) <= 20);
+  assert (one_and_half.size () == 1000);
+
+  ARRAY fixed (0, Array_Growth_Policy::fixed_step (100));
+  assert (fill_by_set (fixed, 1000) == 10);
+  assert (fixed.capacity () == 1000);
+
+  for (size_t i = 0; i < 1000; ++i)
+    {
+      assert (doubling[i] == (char) ('a' + i % 26));
+      assert (doubling[i] == one_and_half[i]);
+      assert (doubling[i] == fixed[i]);
+    }
+
+  // Growing with a default value must initialize the gap.
+  ARRAY defaults (1, 'x');
+  defaults.set ('y', 9);
+  assert (defaults.size () == 10);
+  for (size_t i = 0; i < 9; ++i)
+    assert (defaults[i] == 'x');
+  assert (defaults[9] == 'y');
+
+  // Shrinking and re-growing within capacity must re-apply the default.
+  defaults.resize (2);
+  defaults.resize (5);
+  assert (defaults[4] == 'x');
+
+  std::cout << "--Growth policy tests have finished--\n";
+}
+
+void testReserve (void)
+{
+  std::cout << "--Testing reserve/shrink_to_fit--\n";
+
+  ARRAY a (3, 'r');
+  a.reserve (100);
+  assert (a.size () == 3);
+  assert (a.capacity () == 100);
+
+  // Nothing past the reservation should reallocate.
+  assert (fill_by_set (a, 100) == 0);
+
+  // Reserving less than the capacity is a no-op.
+  a.reserve (10);
+  assert (a.capacity () == 100);
+
+  a.resize (42);
+  a.shrink_to_fit ();
+  assert (a.size () == 42);
+  assert (a.capacity () == 42);
+
+  ARRAY copy (a);
+  assert (copy == a);
+  assert (copy.capacity () == copy.size ());
+
+  std::cout << "--Reserve tests have finished--\n";
+}
+
+void testMoves (void)
+{
+  std::cout << "--Testing move semantics--\n";
+
+  Array<std::string> a (2, std::string ("default"));
+  std::string heavy (1000, 'h');
+
+  a.set (std::move (heavy), 1);
+  assert (a[1].size () == 1000);
+
+  std::string &e = a.emplace (4, 3, 'e');
+  assert (a.size () == 5);
+  assert (e == "eee");
+  assert (a[3] == "default");
+
+  Array<std::string> b (std::move (a));
+  assert (b.size () == 5);
+  assert (a.size () == 0 && a.capacity () == 0);
+  assert (b[4] == "eee");
+
+  // A moved-from array must still be usable.
+  a.set ("again", 0);
+  assert (a.size () == 1 && a[0] == "again");
+
+  Array<std::string> c (1);
+  c = std::move (b);
+  assert (c.size () == 5);
+  assert (c[1].size () == 1000);
+  assert (b.size () == 0);
+
+  std::cout << "--Move semantics tests have finished--\n";
+}
+
+void testSingleWrite (void)
+{
+  std::cout << "--Testing element initialization--\n";
+
+  {
+    Counted prototype;
+    Counted::reset ();
+
+    Array<Counted> a (1000, prototype);
+    assert (Counted::copies == 1001);   // 1000 elements + the default
+    assert (Counted::defaults == 0);
+    assert (Counted::assignments == 0);
+
+    Counted::reset ();
+    a.resize (10);
+    a.resize (20);
+    assert (Counted::copies == 10);
+    assert (Counted::assignments == 0);
+
+    Counted::reset ();
+    a.set (prototype, 20);
+    assert (a.size () == 21);
+    assert (Counted::assignments == 0);
+
+    Array<Counted> b (5);
+    assert (b.size () == 5);
+  }
+
+  // Every constructed element must have been destroyed exactly once.
+  assert (Counted::live == 0);
+
+  std::cout << "--Element initialization tests have finished--\n";
+}
+
+void testAt (void)
+{
+  std::cout << "--Testing checked access--\n";
+
+  ARRAY a (4, 'q');
+  const ARRAY &ca = a;
+
+  a.at (3) = 'r';
+  assert (ca.at (3) == 'r');
+  assert (a[3] == 'r');
+
+  bool thrown = false;
+  try
+    {
+      a.at (4);
+    }
+  catch (std::out_of_range &)
+    {
+      thrown = true;
+    }
+  assert (thrown);
+
+  thrown = false;
+  try
+    {
+      ca.at (100);
+    }
+  catch (std::out_of_range &)
+    {
+      thrown = true;
+    }
+  assert (thrown);
+
+#if ARRAY_BOUNDS_CHECK
+  thrown = false;
+  try
+    {
+      a[4];
+    }
+  catch (std::out_of_range &)
+    {
+      thrown = true;
+    }
+  assert (thrown);
+#endif /* ARRAY_BOUNDS_CHECK */
+
+  std::cout << "--Checked access tests have finished--\n";
+}
+
+// The iterators must be usable by the random access (and, with C++20,
+// contiguous) specializations of the standard algorithms.
+static_assert (std::is_same<std::iterator_traits<ARRAY::iterator>::iterator_category,
+                            std::random_access_iterator_tag>::value,
+               "Array::iterator must be random access");
+static_assert (std::is_same<std::iterator_traits<ARRAY::const_iterator>::difference_type,
+                            std::ptrdiff_t>::value,
+               "Array::const_iterator must use ptrdiff_t");
+#if defined (__cpp_lib_concepts)
+static_assert (std::contiguous_iterator<ARRAY::iterator>,
+               "Array::iterator must be contiguous");
+static_assert (std::contiguous_iterator<ARRAY::const_iterator>,
+               "Array::const_iterator must be contiguous");
+#endif /* __cpp_lib_concepts */
+
+void testIterators (void)
+{
+  std::cout << "--Testing random access iterators--\n";
+
+  Array<int> a (0);
+  for (int i = 0; i < 100; ++i)
+    a.set ((i * 37) % 100, i);
+
+  std::sort (a.begin (), a.end ());
+  assert (std::is_sorted (a.begin (), a.end ()));
+  assert (std::distance (a.begin (), a.end ()) == 100);
+
+  const Array<int> &ca = a;
+  Array<int>::const_iterator found = std::lower_bound (ca.begin (), ca.end (), 42);
+  assert (found != ca.end () && *found == 42);
+  assert (found - ca.begin () == 42);
+  assert (&*found == ca.data () + 42);
+  assert (ca.begin ()[7] == 7);
+
+  Array<int>::iterator i = a.begin ();
+  i += 10;
+  assert (*i == 10 && *(i - 5) == 5 && *(2 + i) == 12);
+  assert (i > a.begin () && a.begin () <= i);
+
+  Array<int>::const_iterator ci = i;
+  assert (*ci == 10);
+
+  int copy[100];
+  std::copy (ca.begin (), ca.end (), copy);
+  assert (std::equal (copy, copy + 100, a.data ()));
+
+  std::cout << "--Random access iterator tests have finished--\n";
+}
+
+void testBulkPaths (void)
+{
+  std::cout << "--Testing bulk copy/fill/compare--\n";
+
+  // A fill value whose bytes differ takes the block-replication path.
+  Array<int> a (10000, 0x01020304);
+  for (size_t i = 0; i < a.size (); ++i)
+    assert (a[i] == 0x01020304);
+
+  a.resize (20000);
+  Array<int> b (a);
+  assert (a == b);
+  b[19999] = 7;
+  assert (a != b);
+
+  Array<int> z (5000, 0);
+  z.resize (8000);
+  assert (std::count (z.begin (), z.end (), 0) == 8000);
+
+  // Floating point equality must not be bitwise: -0.0 == 0.0.
+  Array<double> d1 (3, 0.0);
+  Array<double> d2 (3, -0.0);
+  assert (d1 == d2);
+
+  std::cout << "--Bulk copy/fill/compare tests have finished--\n";
+}
+
+void testSmallArray (void)
+{
+  std::cout << "--Testing Small_Array--\n";
+
+  typedef Small_Array<char, 16> SMALL;
+
+  SMALL a (10, 'i');
+  assert (a.is_inline ());
+  assert (a.size () == 10 && a.capacity () == 16);
+
+  // Growing past the inline capacity spills to the heap.
+  a.set ('h', 40);
+  assert (!a.is_inline ());
+  assert (a.size () == 41 && a[39] == 'i' && a[40] == 'h');
+
+  SMALL b (a);
+  assert (a == b);
+
+  // Shrinking enough brings the elements back inline.
+  b.resize (5);
+  b.shrink_to_fit ();
+  assert (b.is_inline () && b.size () == 5 && b[4] == 'i');
+
+  // Moving a heap array steals the buffer; moving an inline array
+  // moves the elements.
+  SMALL c (std::move (a));
+  assert (c.size () == 41 && !c.is_inline ());
+  assert (a.size () == 0 && a.is_inline ());
+
+  SMALL d (std::move (b));
+  assert (d.size () == 5 && d.is_inline ());
+
+  c.swap (d);
+  assert (c.size () == 5 && d.size () == 41);
+
+  std::sort (d.begin (), d.end ());
+  assert (d[0] == 'h');
+
+  {
+    Counted prototype;
+    Small_Array<Counted, 4> e (3, prototype);
+    e.resize (20);
+    Small_Array<Counted, 4> f (e);
+    f = std::move (e);
+    e = f;
+    f.resize (2);
+    f.shrink_to_fit ();
+  }
+  assert (Counted::live == 0);
+
+  std::cout << "--Small_Array tests have finished--\n";
+}
+
+// A minimal standard conforming allocator that counts its calls.
+template <typename T>
+class Counting_Allocator
+{
+public:
+  typedef T value_type;
+
+  Counting_Allocator (void) {}
+
+  template <typename U>
+  Counting_Allocator (const Counting_Allocator<U> &) {}
+
+  T *allocate (size_t n)
+  {
+    ++allocations;
+    return std::allocator<T> ().allocate (n);
+  }
+
+  void deallocate (T *p, size_t n)
+  {
+    ++deallocations;
+    std::allocator<T> ().deallocate (p, n);
+  }
+
+  bool operator== (const Counting_Allocator &) const { return true; }
+  bool operator!= (const Counting_Allocator &) const { return false; }
+
+  static int allocations;
+  static int deallocations;
+};
+
+template <typename T> int Counting_Allocator<T>::allocations = 0;
+template <typename T> int Counting_Allocator<T>::deallocations = 0;
+
+void testAllocators (void)
+{
+  std::cout << "--Testing allocators--\n";
+
+  {
+    Array<int, Counting_Allocator<int> > a (0);
+    for (int i = 0; i < 100; ++i)
+      a.set (i, i);
+    Array<int, Counting_Allocator<int> > b (a);
+    b = a;
+    assert (Counting_Allocator<int>::allocations > 0);
+  }
+  assert (Counting_Allocator<int>::allocations
+          == Counting_Allocator<int>::deallocations);
+
+  // Everything must come out of the arena: its upstream refuses to
+  // allocate.
+  char buffer[64 * 1024];
+  std::pmr::monotonic_buffer_resource arena (buffer, sizeof buffer,
+                                             std::pmr::null_memory_resource ());
+  typedef std::pmr::polymorphic_allocator<std::pmr::string> STRING_ALLOC;
+  {
+    Array<std::pmr::string, STRING_ALLOC> names (0, STRING_ALLOC (&arena));
+    for (size_t i = 0; i < 20; ++i)
+      names.emplace (i, 40, 'n');
+
+    // The strings must have been built with the array's allocator.
+    assert (names[19].get_allocator ().resource () == &arena);
+
+    Array<std::pmr::string, STRING_ALLOC> copy (names, STRING_ALLOC (&arena));
+    assert (copy == names);
+
+    // Moving between arrays on different resources moves elementwise.
+    std::pmr::monotonic_buffer_resource other_arena;
+    Array<std::pmr::string, STRING_ALLOC> other (0, STRING_ALLOC (&other_arena));
+    other = std::move (names);
+    assert (other.size () == 20 && names.size () == 0);
+    assert (other[0].get_allocator ().resource () == &other_arena);
+  }
+
+  typedef std::pmr::polymorphic_allocator<char> CHAR_ALLOC;
+  Small_Array<char, 4, CHAR_ALLOC> small (2, CHAR_ALLOC (&arena));
+  small.set ('s', 100);
+  assert (!small.is_inline ());
+  assert (small.get_allocator ().resource () == &arena);
+
+  std::cout << "--Allocator tests have finished--\n";
+}
+
+void testRanges (void)
+{
+  std::cout << "--Testing bulk range methods--\n";
+
+  const char name[] = "Douglas";
+  ARRAY a (0);
+  a.assign (name, 7);
+  assert (a.size () == 7 && a.capacity () == 7);
+  assert (std::equal (a.begin (), a.end (), name));
+
+  // A shorter assign reuses the buffer.
+  a.assign (name, name + 3);
+  assert (a.size () == 3 && a.capacity () == 7 && a[2] == 'u');
+
+  a.append (name + 3, 4);
+  assert (a.size () == 7 && std::equal (a.begin (), a.end (), name));
+
+  // Writing past the end grows the array as set() does.
+  ARRAY b (2, '-');
+  b.set_range (4, name, name + 3);
+  assert (b.size () == 7);
+  char out[8] = {};
+  assert (b.get_range (0, 7, out) == out + 7);
+  assert (std::string (out) == "----Dou");
+  b.set_range (0, "ab", 2);
+  assert (b[0] == 'a' && b[1] == 'b' && b[2] == '-');
+
+  bool caught = false;
+  try { b.get_range (5, 3, out); }
+  catch (std::out_of_range &) { caught = true; }
+  assert (caught);
+
+  // The source may be part of the array itself, even when it grows.
+  ARRAY c (0);
+  c.assign (name, 7);
+  c.shrink_to_fit ();
+  c.append (c.begin (), c.end ());
+  assert (c.size () == 14 && std::equal (c.begin () + 7, c.end (), name));
+  c.set_range (0, c.begin () + 1, c.begin () + 4);
+  assert (c[0] == 'o' && c[2] == 'g' && c[3] == 'g');
+
+  // Iterators of other containers, including single-pass ones.
+  std::list<char> letters (name, name + 7);
+  ARRAY d (0);
+  d.assign (letters.begin (), letters.end ());
+  assert (d.size () == 7 && std::equal (d.begin (), d.end (), name));
+  std::istringstream in ("xyz");
+  d.set_range (6, std::istreambuf_iterator<char> (in), std::istreambuf_iterator<char> ());
+  assert (d.size () == 9 && d[6] == 'x' && d[8] == 'z');
+  std::string copy;
+  d.get_range (0, d.size (), std::back_inserter (copy));
+  assert (copy == "Douglaxyz");
+
+  // Types that aren't trivially copyable: one allocation per call,
+  // and every element written exactly once.
+  Array<std::string> s (0);
+  std::vector<std::string> words = { "a", "b", "c", "d" };
+  s.append (words.begin (), words.end ());
+  s.append (s.begin (), s.begin () + 2);
+  assert (s.size () == 6 && s[4] == "a" && s[5] == "b");
+  s.assign (words.data () + 2, 2);
+  assert (s.size () == 2 && s[0] == "c" && s[1] == "d");
+
+  Counted::reset ();
+  {
+    Array<Counted> counted (0);
+    Counted items[5];
+    Counted::reset ();
+    counted.append (items, 5);
+    assert (Counted::copies == 5 && Counted::assignments == 0);
+    counted.set_range (3, items, items + 2);
+    assert (Counted::copies == 5 && Counted::assignments == 2);
+  }
+  assert (Counted::live == 0);
+
+  std::cout << "--Bulk range tests have finished--\n";
+}
+
+void testCOW (void)
+{
+  std::cout << "--Testing COW_Array--\n";
+
+  typedef COW_Array<std::string> STRINGS;
+
+  STRINGS a (3, std::string ("x"));
+  assert (a.use_count () == 1 && !a.is_shared ());
+
+  // Copies share the buffer...
+  STRINGS b (a);
+  STRINGS c (0);
+  c = b;
+  assert (a.use_count () == 3 && b.is_shared ());
+  const STRINGS &cb = b;
+  assert (cb.data () == static_cast<const STRINGS &> (a).data ());
+  assert (a == b && b == c);
+
+  // ...until one of them is written to.
+  b.set ("y", 1);
+  assert (a.use_count () == 2 && b.use_count () == 1);
+  assert (cb[1] == "y");
+  assert (static_cast<const STRINGS &> (a)[1] == "x");
+  assert (a != b);
+
+  // Writing an element of a shared buffer into itself.
+  c.set (static_cast<const STRINGS &> (c)[0], 5);
+  assert (c.size () == 6 && static_cast<const STRINGS &> (c)[5] == "x");
+  assert (a.size () == 3);
+
+  // A mutable reference makes the buffer unshareable, so it isn't
+  // silently changed behind the back of a later copy.
+  std::string &ref = b[0];
+  STRINGS d (b);
+  assert (!b.is_shared () && !d.is_shared ());
+  ref = "changed";
+  assert (static_cast<const STRINGS &> (d)[0] == "x");
+  b.make_shareable ();
+  STRINGS e (b);
+  assert (b.is_shared () && e == b);
+
+  // Bulk writes and growth detach as well.
+  STRINGS f (e);
+  f.append (static_cast<const STRINGS &> (f).begin (), static_cast<const STRINGS &> (f).end ());
+  assert (f.size () == 6 && e.size () == 3);
+  e.resize (10);
+  assert (e.size () == 10 && b.size () == 3);
+
+  // Moving leaves the source empty but usable.
+  STRINGS g (std::move (f));
+  assert (f.size () == 0 && f.use_count () == 0 && g.size () == 6);
+  f.set ("new", 0);
+  assert (f.size () == 1);
+
+  // An Array can be turned into a COW_Array without copying.
+  Array<int> ints (1000, 7);
+  const int *storage = ints.data ();
+  const COW_Array<int> shared (std::move (ints));
+  assert (shared.data () == storage && shared.size () == 1000);
+
+  // Snapshots taken by other threads are released safely.
+  {
+    COW_Array<int> snapshot (shared);
+    std::thread t ([snapshot] () mutable { snapshot.set (1, 0); });
+    t.join ();
+  }
+  assert (shared.use_count () == 1 && shared[0] == 7);
+
+  // Detached copies stay in the allocator's arena.
+  {
+    typedef std::pmr::polymorphic_allocator<int> INT_ALLOC;
+    alignas (std::max_align_t) char buffer[16384];
+    std::pmr::monotonic_buffer_resource arena (buffer, sizeof buffer,
+                                               std::pmr::null_memory_resource ());
+    const auto in_arena = [&] (const int *p) {
+      return (const char *) p >= buffer && (const char *) p < buffer + sizeof buffer;
+    };
+    COW_Array<int, INT_ALLOC> original (100, 3, Array_Growth_Policy (), INT_ALLOC (&arena));
+    COW_Array<int, INT_ALLOC> copy (original);
+    copy.set (4, 0);
+    assert (original[0] == 3 && copy[0] == 4 && copy.use_count () == 1);
+    assert (in_arena (copy.data ()) && copy.get_allocator ().resource () == &arena);
+
+    // So do copies of an unshareable array.
+    copy[1] = 5;
+    const COW_Array<int, INT_ALLOC> unshared (copy);
+    assert (unshared.data () != copy.data () && unshared[1] == 5);
+    assert (in_arena (unshared.data ()));
+  }
+
+  // Assigning to a shared array keeps its growth policy and default
+  // value.
+  COW_Array<int> growing (2, -1, Array_Growth_Policy::fixed_step (100));
+  const COW_Array<int> before (growing);
+  const int values[] = {1, 2, 3};
+  growing.assign (values, values+3);
+  assert (before.size () == 2 && before[0] == -1);
+  assert (growing.size () == 3 && growing.growth_policy ().strategy () == Array_Growth_Policy::FIXED_STEP);
+  growing.resize (10);
+  assert (growing[2] == 3 && growing[3] == -1 && growing[9] == -1);
+  assert (growing.capacity () >= 103);
+
+  std::cout << "--COW_Array tests have finished--\n";
+}
+
+void testMappedArray (void)
+{
+  std::cout << "--Testing Mapped_Array--\n";
+
+  const std::string path = "/tmp/Array-test-" + std::to_string (getpid ()) + ".map";
+  ::unlink (path.c_str ());
+
+  {
+    Mapped_Array<long> m (path);
+    assert (m.size () == 0 && !m.is_read_only ());
+    for (long i = 0; i < 10000; ++i)
+      m.set (i * i, i);
+    assert (m.size () == 10000 && m.capacity () >= 10000);
+    assert (m[9999] == 9999L * 9999L);
+
+    // Shrinking and growing again zero-fills.
+    m.resize (10);
+    m.resize (20);
+    assert (m[10] == 0 && m[19] == 0 && m[9] == 81);
+    m.resize (10000);
+    for (long i = 10; i < 10000; ++i)
+      m[i] = i * i;
+    m.shrink_to_fit ();
+    assert (m.capacity () == 10000);
+    m.flush ();
+  }
+
+  // Reopening maps the same data, with nothing to parse.
+  {
+    const Mapped_Array<long> m (path, Mapped_Array<long>::READ_ONLY);
+    assert (m.size () == 10000 && m.is_read_only ());
+    for (long i = 0; i < 10000; ++i)
+      assert (m[i] == i * i);
+    assert (std::count (m.begin (), m.end (), 81) == 1);
+    long item;
+    m.get (item, 100);
+    assert (item == 10000);
+
+    Mapped_Array<long> w (path);
+    assert (w == m);
+    w[5] = -1;
+    assert (m[5] == -1);
+
+    bool caught = false;
+    try { const_cast<Mapped_Array<long> &> (m).resize (1); }
+    catch (std::logic_error &) { caught = true; }
+    assert (caught);
+
+    // Moving hands over the mapping.
+    Mapped_Array<long> moved (std::move (w));
+    assert (w.size () == 0 && moved.size () == 10000);
+  }
+
+  // Files of another element type are rejected.
+  bool caught = false;
+  try { Mapped_Array<char> wrong (path); }
+  catch (std::runtime_error &) { caught = true; }
+  assert (caught);
+
+  ::unlink (path.c_str ());
+  std::cout << "--Mapped_Array tests have finished--\n";
+}
+
+void testSoA (void)
+{
+  std::cout << "--Testing ArraySoA--\n";
+
+  typedef ArraySoA<int, double, char> RECORDS;
+
+  RECORDS r (0);
+  for (int i = 0; i < 1000; ++i)
+    r.append (std::make_tuple (i, i * 0.5, char ('a' + i % 26)));
+  assert (r.size () == 1000);
+  assert (r.column<0> ().size () == 1000 && r.column<2> ().size () == 1000);
+
+  // Proxy references read and write whole records or single fields.
+  std::tuple<int, double, char> rec = r[10];
+  assert (std::get<0> (rec) == 10 && std::get<2> (rec) == 'k');
+  r[10].get<1> () = 100.0;
+  r[11] = std::make_tuple (-1, -1.0, 'z');
+  r[12] = r[11];
+  assert (r[12].get<0> () == -1 && r[10].get<1> () == 100.0);
+  r.get (rec, 12);
+  assert (std::get<2> (rec) == 'z');
+
+  // Each field is a contiguous column.
+  long sum = 0;
+  const int *ids = r.column_data<0> ();
+  for (size_t i = 0; i < r.size (); ++i)
+    sum += ids[i];
+  assert (sum == 999 * 1000 / 2 - 11 - 12 - 1 - 1);
+  assert (Array_SIMD::count (r.column<2> (), 'z') == 38 + 2);
+
+  // Iterators visit records.
+  const RECORDS &cr = r;
+  size_t n = 0;
+  for (RECORDS::const_iterator i = cr.begin (); i != cr.end (); ++i)
+    if ((*i).get<0> () < 0)
+      ++n;
+  assert (n == 2);
+  assert (cr.end () - cr.begin () == 1000);
+  RECORDS::iterator it = std::find_if (r.begin (), r.end (),
+                                       [] (RECORDS::iterator::reference x) { return x.get<2> () == 'c'; });
+  assert (it.index () == 2 && it[1].get<0> () == 3);
+
+  // The columns are resized in lockstep.
+  RECORDS d (5, std::make_tuple (7, 1.5, 'd'));
+  d.resize (8);
+  assert (d.size () == 8 && d[7].get<0> () == 7 && d[7].get<2> () == 'd');
+  d.set (std::make_tuple (1, 2.0, 'e'), 20);
+  assert (d.size () == 21 && d.column<1> ().size () == 21 && d[20].get<2> () == 'e');
+  d.reserve (100);
+  assert (d.capacity () >= 100);
+
+  RECORDS e (d);
+  assert (e == d);
+  e[0].get<1> () = 0.0;
+  assert (e != d);
+  e.swap (d);
+  assert (d[0].get<1> () == 0.0 && e[0].get<1> () == 1.5);
+
+  bool caught = false;
+  try { cr.at (1000); }
+  catch (std::out_of_range &) { caught = true; }
+  assert (caught);
+
+  std::cout << "--ArraySoA tests have finished--\n";
+}
+
+void testParallel (void)
+{
+  std::cout << "--Testing parallel methods--\n";
+
+  // Force several threads, whatever the machine has.
+  const Array_Parallel_Policy policy (4, 1000);
+
+  Array<long> a (100000, 1L);
+  a.parallel_for_each ([] (long &x) { x += 1; }, policy);
+  a.parallel_transform ([] (long x) { return x * 3; }, policy);
+  assert (a[0] == 6 && a[99999] == 6);
+  assert (a.parallel_reduce (0L, std::plus<long> (), policy) == 600000);
+
+  // Results are combined in order, so <op> needn't be commutative.
+  Array<std::string> s (5000, std::string ("x"));
+  s[0] = "a";
+  s[4999] = "b";
+  std::string joined = s.parallel_reduce (std::string (), std::plus<std::string> (),
+                                          Array_Parallel_Policy (4, 100));
+  assert (joined.size () == 5000 && joined[0] == 'a' && joined[4999] == 'b');
+
+  // An empty array reduces to <init>.
+  Array<int> empty (0);
+  assert (empty.parallel_reduce (7, std::plus<int> (), policy) == 7);
+
+  // Exceptions reach the caller, and the pool stays usable.
+  bool caught = false;
+  try
+    {
+      a.parallel_for_each ([] (long &x) { if (x == 6) throw std::runtime_error ("boom"); }, policy);
+    }
+  catch (std::runtime_error &) { caught = true; }
+  assert (caught);
+
+  // Nested parallel calls run serially on the calling thread.
+  Array<int> rows (64, 0);
+  Array<int> inner (5000, 1);
+  rows.parallel_for_each ([&inner, &policy] (int &r) { r = inner.parallel_reduce (0, std::plus<int> (), policy); },
+                          Array_Parallel_Policy (4, 1));
+  assert (rows[0] == 5000 && rows[63] == 5000);
+
+  // With a low threshold the bulk fill and copy paths go parallel too.
+  const size_t old_threshold = Array_Parallel_Policy::bulk_threshold ();
+  const Array_Parallel_Policy old_defaults = Array_Parallel_Policy::defaults ();
+  Array_Parallel_Policy::set_bulk_threshold (1024);
+  Array_Parallel_Policy::set_defaults (Array_Parallel_Policy (4, 1));
+  Array<int> big (3 << 20, 0x01020304);
+  assert (big[0] == 0x01020304 && big[(3 << 20) - 1] == 0x01020304);
+  big[12345] = 5;
+  Array<int> copy (big);
+  assert (copy == big);
+  copy.resize (4 << 20);
+  assert (copy[(4 << 20) - 1] == 0x01020304 && copy[12345] == 5);
+  Array_Parallel_Policy::set_bulk_threshold (old_threshold);
+  Array_Parallel_Policy::set_defaults (old_defaults);
+
+  std::cout << "--Parallel tests have finished--\n";
+}
+
+template <typename ARRAY>
+static bool
+isAligned (const ARRAY &a, size_t alignment)
+{
+  return reinterpret_cast<uintptr_t> (a.data ()) % alignment == 0;
+}
+
+void testAligned (void)
+{
+  std::cout << "--Testing aligned buffers--\n";
+
+  // Every buffer is aligned, however the array grows.
+  Aligned_Array<char> a (1, 'a');
+  assert (isAligned (a, 64));
+  for (size_t i = 1; i < 5000; ++i)
+    {
+      a.set (char ('a' + i % 26), i);
+      assert (isAligned (a, 64));
+    }
+  a.shrink_to_fit ();
+  assert (isAligned (a, 64) && a[4999] == 'a' + 4999 % 26);
+
+  Aligned_Array<double, Array_Alignment::PAGE, true> p (3, 1.0);
+  assert (isAligned (p, 4096));
+  Aligned_Array<double, Array_Alignment::PAGE, true> q (p);
+  assert (isAligned (q, 4096) && q == p);
+
+  Aligned_Array<int, Array_Alignment::HUGE_PAGE> h (10, 7);
+  assert (isAligned (h, 2u << 20) && h[9] == 7);
+
+  // The allocator rebinds, so other containers can use it too.
+  COW_Array<float, Array_Aligned_Allocator<float> > c (100, 0.5f);
+  COW_Array<float, Array_Aligned_Allocator<float> > d (c);
+  d.set (1.5f, 200);
+  assert (isAligned (d, 64) && c[99] == 0.5f);
+
+  // Neighboring arrays never share a cache line.
+  Aligned_Array<int, Array_Alignment::CACHE_LINE, true> x (1, 1);
+  Aligned_Array<int, Array_Alignment::CACHE_LINE, true> y (1, 2);
+  assert (reinterpret_cast<uintptr_t> (x.data ()) / 64 != reinterpret_cast<uintptr_t> (y.data ()) / 64);
+
+  std::cout << "--Aligned buffer tests have finished--\n";
+}
+
+void testSegmented (void)
+{
+  std::cout << "--Testing Segmented_Array--\n";
+
+  typedef Segmented_Array<std::string, 8> SEGMENTED;
+
+  SEGMENTED a (3, std::string ("d"));
+  assert (a.size () == 3 && a.capacity () == 8 && a[2] == "d");
+
+  // Growing adds chunks and never moves an element.
+  const std::string *first = &a[0];
+  std::string *seventh = &a.emplace (7, "seven");
+  for (size_t i = 8; i < 1000; ++i)
+    a.set (std::to_string (i), i);
+  assert (&a[0] == first && &a[7] == seventh && *seventh == "seven");
+  assert (a.size () == 1000 && a.capacity () == 1000 && a.chunks () == 125);
+  assert (a[5] == "d" && a[999] == "999");
+
+  // Elements may be set from elements of the same array.
+  a.set (a[999], 1200);
+  assert (a[1200] == "999" && a[1100] == "d");
+
+  std::string item;
+  a.get (item, 8);
+  assert (item == "8");
+  bool caught = false;
+  try { a.get (item, 5000); }
+  catch (std::out_of_range &) { caught = true; }
+  assert (caught);
+
+  // Iterators are random access across the chunks.
+  SEGMENTED::iterator it = std::find (a.begin (), a.end (), std::string ("500"));
+  assert (it.index () == 500 && it[1] == "501" && it->size () == 3);
+  assert (a.end () - a.begin () == 1201);
+  Segmented_Array<int, 16> n (0);
+  for (int i = 0; i < 100; ++i)
+    n.set (99 - i, i);
+  std::sort (n.begin (), n.end ());
+  const Segmented_Array<int, 16> &cn = n;
+  assert (std::is_sorted (cn.begin (), cn.end ()) && cn[0] == 0 && cn[99] == 99);
+  assert (n.chunk (1)[0] == 16);
+
+  SEGMENTED b (a);
+  assert (b == a && &b[0] != &a[0]);
+  b[0] = "changed";
+  assert (b != a);
+
+  // Moves keep the elements where they are.
+  SEGMENTED c (std::move (b));
+  assert (b.size () == 0 && c[0] == "changed");
+  const std::string *c0 = &c[0];
+  b = std::move (c);
+  assert (&b[0] == c0);
+
+  b.resize (10);
+  assert (b.size () == 10 && b.chunks () == 151);
+  b.shrink_to_fit ();
+  assert (b.chunks () == 2 && b[9] == "9");
+  b.resize (20);
+  assert (b[19] == "d");
+
+  // The default chunk is 64 KB.
+  assert (Segmented_Array<char>::chunk_size () == 65536);
+  assert (Segmented_Array<double>::chunk_size () == 8192);
+
+  std::cout << "--Segmented_Array tests have finished--\n";
+}
+
+void testHugePages (void)
+{
+  std::cout << "--Testing huge page allocation--\n";
+
+  const size_t n = (6u << 20) / sizeof (uint64_t);
+  const Array_Huge_Pages::Stats before = Array_Huge_Pages::stats ();
+  {
+    Array<uint64_t, Array_Huge_Page_Allocator<uint64_t> > a (n, 1);
+    assert (isAligned (a, Array_Huge_Pages::HUGE_PAGE_SIZE));
+    a.set (2, n + 10);
+    assert (isAligned (a, Array_Huge_Pages::HUGE_PAGE_SIZE) && a[n - 1] == 1 && a[n + 10] == 2);
+
+    // The kernel decides whether the pages are really huge.
+    const Array_Huge_Pages::Stats after = Array_Huge_Pages::stats ();
+    assert (after.transparent_pages + after.failures > before.transparent_pages + before.failures);
+    assert (Array_Huge_Pages::backed_bytes (a.data ()) <= a.capacity () * sizeof (uint64_t)
+                                                          + Array_Huge_Pages::HUGE_PAGE_SIZE);
+  }
+
+  // MAP_HUGETLB falls back when no huge pages are reserved.
+  Array<char, Array_Huge_Page_Allocator<char, Array_Huge_Pages::HUGETLB> > b (5u << 20, 'h');
+  assert (isAligned (b, Array_Huge_Pages::HUGE_PAGE_SIZE) && b[(5u << 20) - 1] == 'h');
+  const Array_Huge_Pages::Stats s = Array_Huge_Pages::stats ();
+  assert (s.hugetlb_pages + s.transparent_pages >= 3);
+
+  // Small arrays use the heap.
+  Array<int, Array_Huge_Page_Allocator<int> > c (10, 3);
+  assert (c[9] == 3);
+
+  std::cout << "--Huge page tests have finished--\n";
+}
+
+// Returns the number of bytes of memory the process has resident.
+static size_t
+residentBytes (void)
+{
+  std::ifstream statm ("/proc/self/statm");
+  size_t total = 0, resident = 0;
+  statm >> total >> resident;
+  return resident * sysconf (_SC_PAGESIZE);
+}
+
+void testLazyZero (void)
+{
+  std::cout << "--Testing lazy zero initialization--\n";
+
+  // A zero default doesn't touch the pages of a large array.
+  const size_t n = (64u << 20) / sizeof (long);
+  const size_t before = residentBytes ();
+  Array<long> a (n, 0L);
+  assert (a.size () == n && a[0] == 0 && a[n / 2] == 0 && a[n - 1] == 0);
+  if (before != 0)
+    assert (residentBytes () - before < (16u << 20));
+
+  // Growing past the capacity stays lazy, and the old elements move.
+  a[n - 1] = 7;
+  a.resize (n + n / 2);
+  assert (a[n - 1] == 7 && a[n] == 0 && a[n + n / 2 - 1] == 0);
+  a.set (9, 3 * n);
+  assert (a[3 * n] == 9 && a[3 * n - 1] == 0 && a[n - 1] == 7);
+
+  // Shrinking and growing again within the capacity still zeroes.
+  Array<int> b (100, 0);
+  b[90] = 5;
+  b.resize (50);
+  b.resize (100);
+  assert (b[90] == 0);
+
+  // So does a telemetry tag on std::allocator.
+  {
+    struct Lazy_Tag {};
+    const size_t tagged_before = residentBytes ();
+    Array<long, Array_Tagged_Allocator<long, Lazy_Tag> > t (n, 0L);
+    assert (t[0] == 0 && t[n - 1] == 0);
+    if (tagged_before != 0)
+      assert (residentBytes () - tagged_before < (16u << 20));
+    t[n - 1] = 7;
+    t.resize (2 * n);
+    assert (t[n - 1] == 7 && t[2 * n - 1] == 0);
+  }
+
+  // Other allocators are cleared with memset, nonzero defaults filled.
+  Array<int, Counting_Allocator<int> > c (100, 0);
+  assert (c[99] == 0);
+  Array<double> d (10, -0.0);
+  assert (d[9] == 0.0 && std::signbit (d[9]));
+
+  std::cout << "--Lazy zero tests have finished--\n";
+}
+
+// Build a StaticArray at compile time.
+static constexpr StaticArray<int, 5>
+makeSquares (void)
+{
+  StaticArray<int, 5> a;
+  for (size_t i = 0; i < a.size (); ++i)
+    a.set (int (i * i), i);
+  return a;
+}
+
+void testStaticArray (void)
+{
+  std::cout << "--Testing StaticArray--\n";
+
+  constexpr StaticArray<int, 5> squares = makeSquares ();
+  static_assert (squares[4] == 16 && squares.at (2) == 4, "constexpr StaticArray");
+  static_assert (StaticArray<int, 5>::size () == 5, "size is a constant");
+  static_assert (sizeof (StaticArray<char, 7>) == 7, "storage is inline");
+
+  StaticArray<std::string, 3> a (3, std::string ("x"));
+  a.emplace (1, 2, 'y');
+  assert (a[0] == "x" && a[1] == "yy");
+  std::string item;
+  a.get (item, 2);
+  assert (item == "x");
+  assert (std::count (a.begin (), a.end (), std::string ("x")) == 2);
+
+  StaticArray<std::string, 3> b (a);
+  assert (b == a);
+  b.fill ("z");
+  a.swap (b);
+  assert (a[1] == "z" && b[1] == "yy");
+
+  bool caught = false;
+  try { a.set ("w", 3); }
+  catch (std::out_of_range &) { caught = true; }
+  assert (caught);
+  caught = false;
+  try { StaticArray<int, 4> wrong (5); }
+  catch (std::length_error &) { caught = true; }
+  assert (caught);
+
+  std::cout << "--StaticArray tests have finished--\n";
+}
+
+void testAssignReuse (void)
+{
+  std::cout << "--Testing copy assignment buffer reuse--\n";
+
+  typedef Array<int, Counting_Allocator<int> > COUNTED_ARRAY;
+  COUNTED_ARRAY a (100, 1);
+  COUNTED_ARRAY b (100, 2);
+  COUNTED_ARRAY c (10, 3);
+
+  // Assigning arrays that fit doesn't allocate.
+  const int allocations = Counting_Allocator<int>::allocations;
+  for (int i = 0; i < 10; ++i)
+    {
+      b = a;
+      b = c;
+    }
+  assert (Counting_Allocator<int>::allocations == allocations);
+  assert (b == c && b.capacity () == 100);
+  b.resize (20);
+  assert (b[19] == 3);
+
+  // One that doesn't fit does.
+  c = a;
+  assert (c == a && Counting_Allocator<int>::allocations == allocations + 1);
+
+  // Elements with a nothrow copy are assigned, built and destroyed in
+  // place.  (Each array also keeps a copy of <p> as its default.)
+  std::shared_ptr<int> p (new int (7));
+  Array<std::shared_ptr<int> > x (5, p);
+  Array<std::shared_ptr<int> > y (8);
+  const std::shared_ptr<int> *buffer = y.data ();
+  y = x;
+  assert (y.data () == buffer && y.size () == 5 && *y[4] == 7 && p.use_count () == 13);
+  y = Array<std::shared_ptr<int> > (2, p);
+  x = y;
+  assert (p.use_count () == 7);
+
+  // Elements whose copy may throw still go through copy-and-swap.
+  Array<Counted> m (4);
+  Array<Counted> n (8);
+  Counted::reset ();
+  n = m;
+  assert (Counted::copies == 4 && Counted::assignments == 0 && n.capacity () == 4);
+
+  std::cout << "--Copy assignment tests have finished--\n";
+}
+
+void testSortedArray (void)
+{
+  std::cout << "--Testing sorted arrays--\n";
+
+  // Bulk construction sorts and drops duplicates.
+  const int init[] = { 5, 3, 9, 3, 1, 5, 7 };
+  SortedArray<int> s (init, init + 7);
+  const int sorted[] = { 1, 3, 5, 7, 9 };
+  assert (s.size () == 5 && std::equal (s.begin (), s.end (), sorted));
+  assert (s.contains (7) && !s.contains (4) && s.find (4) == s.end ());
+  assert (*s.lower_bound (4) == 5 && *s.upper_bound (5) == 7);
+
+  assert (s.insert (4).second && !s.insert (4).second && *s.insert (0).first == 0);
+  assert (s.erase (9) == 1 && s.erase (9) == 0 && s.size () == 6);
+
+  // Batched inserts must agree with std::set, including batches with
+  // duplicates of their own and of elements already present.
+  std::set<int> ref (s.begin (), s.end ());
+  unsigned seed = 1;
+  for (int round = 0; round < 50; ++round)
+    {
+      std::vector<int> batch;
+      for (int i = round % 7; i >= 0; --i)
+        {
+          seed = seed * 1103515245 + 12345;
+          batch.push_back ((seed >> 16) % 200);
+        }
+      s.insert (batch.begin (), batch.end ());
+      ref.insert (batch.begin (), batch.end ());
+      assert (s.size () == ref.size () && std::equal (s.begin (), s.end (), ref.begin ()));
+    }
+  s.insert (ref.begin (), ref.end ());
+  assert (s.size () == ref.size ());
+
+  // Of equivalent elements, the first one is kept.
+  typedef std::pair<int, int> PAIR;
+  auto by_first = [] (const PAIR &a, const PAIR &b) { return a.first < b.first; };
+  const PAIR pairs[] = { PAIR (2, 0), PAIR (1, 0), PAIR (2, 1) };
+  SortedArray<PAIR, decltype (by_first)> p (pairs, pairs + 3, by_first);
+  assert (p.size () == 2 && p[1] == PAIR (2, 0));
+
+  // Transparent comparators allow lookups without building a key.
+  SortedArray<std::string, std::less<> > names;
+  const std::string words[] = { "pear", "apple", "fig" };
+  names.insert (words, words + 3);
+  assert (names.contains (std::string_view ("fig")) && !names.contains ("kiwi"));
+  assert (names.erase ("apple") == 1 && names[0] == "fig");
+
+  // FlatMap keeps keys and values in step.
+  FlatMap<std::string, int, std::less<> > m;
+  assert (m.insert ("b", 2) && !m.insert ("b", 20) && m.at ("b") == 2);
+  assert (!m.insert_or_assign ("b", 3) && m.at ("b") == 3);
+  m["a"] = 1;
+  const std::pair<std::string, int> more[] =
+    { { "d", 4 }, { "c", 30 }, { "a", 10 }, { "c", 31 }, { "e", 5 } };
+  m.insert (more, more + 5);
+  assert (m.size () == 5 && m.key (2) == "c" && m.value (2) == 30 && m.at ("a") == 1);
+  assert (m.find ("z") == 0 && *m.find ("e") == 5 && m.index ("d") == 3);
+  assert (m.erase ("c") == 1 && m.key (2) == "d" && m.value (2) == 4);
+
+  bool threw = false;
+  try { m.at ("c"); } catch (const std::out_of_range &) { threw = true; }
+  assert (threw);
+
+  // Batched map inserts must agree with std::map.
+  std::map<int, int> ref_map;
+  FlatMap<int, int> fm;
+  for (int round = 0; round < 50; ++round)
+    {
+      std::vector<std::pair<int, int> > batch;
+      for (int i = round % 9; i >= 0; --i)
+        {
+          seed = seed * 1103515245 + 12345;
+          batch.push_back (std::make_pair ((seed >> 16) % 300, round));
+        }
+      fm.insert (batch.begin (), batch.end ());
+      ref_map.insert (batch.begin (), batch.end ());
+    }
+  FlatMap<int, int> copy (ref_map.begin (), ref_map.end ());
+  assert (fm == copy && fm.size () == ref_map.size ());
+  for (size_t i = 0; i < fm.size (); ++i)
+    assert (ref_map[fm.key (i)] == fm.value (i));
+
+  // Inserting one key at a time grows the capacity geometrically.
+  FlatMap<int, int> grown;
+  size_t growths = 0;
+  for (int i = 0; i < 1000; ++i)
+    {
+      const size_t capacity = grown.capacity ();
+      grown[999 - i] = i;
+      if (grown.capacity () != capacity)
+        ++growths;
+    }
+  assert (grown.size () == 1000 && grown.at (0) == 999 && growths <= 12);
+
+  std::cout << "--Sorted array tests have finished--\n";
+}
+
+void testBitArray (void)
+{
+  std::cout << "--Testing bit arrays--\n";
+
+  Bit_Array<> b (200);
+  assert (b.size () == 200 && b.words () == 4 && b.count () == 0);
+  assert (b.find_first () == Bit_Array<>::npos);
+
+  b.set (3);
+  b.set (64);
+  b.set (199);
+  b.flip (100);
+  b.flip (3);
+  assert (!b.get (3) && b[64] && b.get (100) && b.get (199) && b.count () == 3);
+  assert (b.find_first () == 64 && b.find_next (64) == 100 && b.find_next (100) == 199);
+  assert (b.find_next (199) == Bit_Array<>::npos);
+  b.reset (100);
+  assert (b.find_next (64) == 199);
+
+  bool threw = false;
+  try { b.set (200); } catch (const std::out_of_range &) { threw = true; }
+  assert (threw);
+  threw = false;
+  try { b.set_range (150, 201); } catch (const std::out_of_range &) { threw = true; }
+  assert (threw);
+
+  // Ranges and counts must agree with a reference, for ranges that
+  // start and end inside, on and across word boundaries.
+  std::vector<bool> ref (b.size ());
+  ref[64] = ref[199] = true;
+  unsigned seed = 7;
+  for (int round = 0; round < 500; ++round)
+    {
+      seed = seed * 1103515245 + 12345;
+      size_t first = (seed >> 8) % 201;
+      seed = seed * 1103515245 + 12345;
+      size_t last = (seed >> 8) % 201;
+      if (first > last)
+        std::swap (first, last);
+      const bool value = round % 3 != 0;
+      if (value)
+        b.set_range (first, last);
+      else
+        b.reset_range (first, last);
+      std::fill (ref.begin () + first, ref.begin () + last, value);
+      assert (b.count (first, last) == (value ? last - first : 0));
+      assert (b.count () == size_t (std::count (ref.begin (), ref.end (), true)));
+    }
+  size_t n = 0;
+  for (size_t i = b.find_first (); i != Bit_Array<>::npos; i = b.find_next (i), ++n)
+    assert (ref[i]);
+  assert (n == b.count ());
+
+  // The bits past the end stay clear, whatever the ranges did.
+  Bit_Array<> full (130, true);
+  assert (full.count () == 130 && full.data ()[2] == 3);
+  full.resize (70);
+  assert (full.count () == 70 && full.data ()[1] == 0x3f);
+  full.resize (300);
+  assert (full.count () == 70 && !full.get (70) && full.find_next (69) == Bit_Array<>::npos);
+
+  // Word-parallel operations.
+  Bit_Array<> x (1000), y (1000);
+  x.set_range (0, 600);
+  y.set_range (400, 1000);
+  Bit_Array<> z (x);
+  z &= y;
+  assert (z.count () == 200 && z.find_first () == 400);
+  z = x;
+  z |= y;
+  assert (z == Bit_Array<> (1000, true));
+  z = x;
+  z ^= y;
+  assert (z.count () == 800 && z.count (400, 600) == 0 && z.find_next (399) == 600);
+  threw = false;
+  try { z &= b; } catch (const std::length_error &) { threw = true; }
+  assert (threw);
+
+  // Both popcount kernels must agree.
+  assert (Bit_Array_Popcount::portable (z.data (), z.words ())
+          == Bit_Array_Popcount::best () (z.data (), z.words ()));
+
+  // Moved-from arrays have no bits and can grow again, clear.
+  const size_t bits = z.count ();
+  Bit_Array<> moved (std::move (z));
+  assert (moved.count () == bits && z.size () == 0 && z.count () == 0);
+  assert (z.find_first () == Bit_Array<>::npos && z == Bit_Array<> (0));
+  z.resize (300);
+  assert (z.count () == 0 && z.find_first () == Bit_Array<>::npos);
+  z.set (299);
+  assert (z[299] && z.count () == 1);
+  Bit_Array<> target (10, true);
+  target = std::move (moved);
+  assert (target.count () == bits && moved.size () == 0 && moved.count () == 0);
+  moved.resize (1000);
+  assert (moved.count () == 0);
+
+  std::cout << "--Bit array tests have finished--\n";
+}
+
+void testCompressedArray (void)
+{
+  std::cout << "--Testing compressed arrays--\n";
+
+  // Timestamps with small gaps compress to a few bits per value.
+  std::vector<uint64_t> stamps;
+  uint64_t t = 1700000000000ull;
+  unsigned seed = 3;
+  for (size_t i = 0; i < 10000; ++i)
+    {
+      seed = seed * 1103515245 + 12345;
+      t += (seed >> 16) % 50;
+      stamps.push_back (t);
+    }
+  Compressed_Array<uint64_t> c (stamps.begin (), stamps.end ());
+  assert (c.size () == 10000 && c.blocks () == 10000 / 128);
+  for (size_t i = 0; i < c.blocks (); ++i)
+    assert (c.width (i) <= 13);
+  assert (c.bytes () < stamps.size () * sizeof (uint64_t) / 2);
+  for (size_t i = 0; i < stamps.size (); ++i)
+    assert (c[i] == stamps[i]);
+
+  // Decoding runs that start and end mid-block and in the tail.
+  std::vector<uint64_t> out (stamps.size ());
+  c.decode (0, stamps.size (), out.data ());
+  assert (out == stamps);
+  c.decode (100, 9850, out.data ());
+  assert (std::equal (out.begin (), out.begin () + 9850, stamps.begin () + 100));
+
+  bool threw = false;
+  try { c.decode (9000, 1001, out.data ()); } catch (const std::out_of_range &) { threw = true; }
+  assert (threw);
+  threw = false;
+  try { c.at (10000); } catch (const std::out_of_range &) { threw = true; }
+  assert (threw);
+
+  // Appending moves values from the tail into new blocks.
+  for (size_t i = 0; i < 100; ++i)
+    c.append (t + i);
+  assert (c.size () == 10100 && c.blocks () == 78 && c[10099] == t + 99 && c[10000] == t);
+
+  // Every width from 0 to 64 bits, with signed values.
+  Compressed_Array<int64_t, 64> w;
+  std::vector<int64_t> values;
+  for (unsigned bits = 0; bits <= 64; ++bits)
+    for (size_t i = 0; i < 64; ++i)
+      {
+        seed = seed * 1103515245 + 12345;
+        const uint64_t r = (uint64_t (seed) << 32 | seed >> 3) * 0x9e3779b97f4a7c15ull;
+        values.push_back (int64_t (bits == 0 ? 42 : bits == 64 ? r : r >> (64 - bits)) - 5);
+      }
+  w.append (values.begin (), values.end ());
+  assert (w.blocks () == 65 && w.width (0) == 0 && w.width (64) == 64);
+  for (size_t i = 0; i < values.size (); ++i)
+    assert (w[i] == values[i]);
+  Compressed_Array<int64_t, 64> copy (w);
+  assert (copy == w);
+  copy.append (1);
+  assert (copy != w);
+  copy.clear ();
+  assert (copy.size () == 0);
+  copy.append (values.begin (), values.end ());
+  assert (copy == w);
+
+  // 32-bit IDs.
+  Compressed_Array<uint32_t> ids;
+  for (uint32_t i = 0; i < 1000; ++i)
+    ids.append (4000000000u + i * 3);
+  assert (ids[999] == 4000000000u + 2997 && ids.width (0) == 9);
+
+  // Moved-from arrays are empty and can be appended to again.
+  Compressed_Array<int64_t, 64> moved (std::move (w));
+  assert (moved == copy && w.size () == 0);
+  w.append (values.begin (), values.end ());
+  assert (w == moved);
+  copy = std::move (w);
+  assert (copy == moved && w.size () == 0);
+  w.clear ();
+  w.append (values.begin (), values.end ());
+  assert (w == moved);
+
+  std::cout << "--Compressed array tests have finished--\n";
+}
+
+// A transparent string hash, so Hash_Map<std::string, ...> can be
+// searched with string_views and literals.
+struct String_Hash
+{
+  typedef void is_transparent;
+  size_t operator() (std::string_view s) const { return std::hash<std::string_view> () (s); }
+};
+
+// Sends every key to the same home slot.
+struct Constant_Hash
+{
+  size_t operator() (int) const { return 42; }
+};
+
+void testHashMap (void)
+{
+  std::cout << "--Testing hash maps--\n";
+
+  Hash_Map<int, int> h;
+  assert (h.empty () && h.capacity () == 0 && h.find (1) == 0);
+  assert (h.insert (1, 10) && !h.insert (1, 11) && h.at (1) == 10);
+  assert (!h.insert_or_assign (1, 12) && h.insert_or_assign (2, 20) && h[1] == 12);
+  h[3] += 30;
+  assert (h.size () == 3 && *h.find (3) == 30 && h.contains (2) && !h.contains (4));
+  assert (h.erase (2) == 1 && h.erase (2) == 0 && !h.contains (2) && h.size () == 2);
+
+  bool threw = false;
+  try { h.at (2); } catch (const std::out_of_range &) { threw = true; }
+  assert (threw);
+
+  // Random inserts, overwrites and erases must agree with
+  // std::unordered_map, through growth and backward shifts.
+  std::unordered_map<int, int> ref;
+  h.clear ();
+  unsigned seed = 11;
+  for (int i = 0; i < 200000; ++i)
+    {
+      seed = seed * 1103515245 + 12345;
+      const int key = (seed >> 8) % 5000;
+      switch ((seed >> 4) % 4)
+        {
+        case 0:
+          assert (h.erase (key) == ref.erase (key));
+          break;
+        case 1:
+          h[key] = i;
+          ref[key] = i;
+          break;
+        default:
+          assert (h.insert (key, i) == ref.insert (std::make_pair (key, i)).second);
+          break;
+        }
+      assert (h.size () == ref.size () && h.load_factor () <= h.max_load_factor ());
+    }
+  for (const std::pair<const int, int> &e : ref)
+    assert (h.at (e.first) == e.second);
+  size_t visited = 0;
+  h.for_each ([&] (const int &key, int &value) { assert (ref.at (key) == value); ++visited; });
+  assert (visited == ref.size ());
+
+  // reserve () makes room without later rehashing.
+  Hash_Map<int, int> r;
+  r.reserve (1000);
+  const size_t capacity = r.capacity ();
+  for (int i = 0; i < 1000; ++i)
+    r.insert (i, i);
+  assert (r.capacity () == capacity && r.load_factor () <= r.max_load_factor ());
+  r.max_load_factor (0.5f);
+  assert (r.load_factor () <= 0.5f && r.size () == 1000 && r.at (999) == 999);
+
+  // Heterogeneous lookup.
+  Hash_Map<std::string, int, String_Hash, std::equal_to<> > names;
+  names["apple"] = 1;
+  names["pear"] = 2;
+  assert (names.contains (std::string_view ("pear")) && names.at ("apple") == 1);
+  assert (names.erase ("apple") == 1 && !names.contains ("apple") && names.size () == 1);
+
+  // A hash that puts everything in one cluster pushes entries more
+  // than 255 slots from home.
+  Hash_Map<int, int, Constant_Hash> c;
+  for (int i = 0; i < 600; ++i)
+    c.insert (i, -i);
+  for (int i = 0; i < 600; i += 2)
+    assert (c.erase (i) == 1);
+  for (int i = 0; i < 600; ++i)
+    assert ((c.find (i) != 0) == (i % 2 == 1) && (i % 2 == 0 || c.at (i) == -i));
+
+  // A moved-from map is empty and can be used again.
+  Hash_Map<int, int> moved (std::move (r));
+  assert (moved.size () == 1000 && moved.at (5) == 5);
+  assert (r.size () == 0 && r.capacity () == 0 && !r.contains (5) && r.erase (5) == 0);
+  r[5] = 50;
+  assert (r.size () == 1 && r.at (5) == 50);
+  Hash_Map<int, int> target;
+  target.insert (1, 1);
+  target = std::move (moved);
+  assert (target.size () == 1000 && !target.contains (1000) && target.at (999) == 999);
+  assert (moved.size () == 0 && moved.find (999) == 0);
+  for (int i = 0; i < 100; ++i)
+    moved.insert (i, -i);
+  assert (moved.size () == 100 && moved.at (99) == -99);
+
+  std::cout << "--Hash map tests have finished--\n";
+}
+
+// Tags for testTelemetry.
+struct Telemetry_Tag {};
+struct Telemetry_Map_Tag {};
+
+void testTelemetry (void)
+{
+  typedef Array<long, Array_Tagged_Allocator<long, Telemetry_Tag> > Tagged;
+  Array_Telemetry::reset<Telemetry_Tag> ();
+  const Array_Telemetry::Stats untagged = Array_Telemetry::stats<long> ();
+
+  // Growing one element at a time counts each new buffer, and the
+  // elements moved out of each old one.
+  Tagged a (0);
+  size_t allocations = 0, reallocations = 0, copied = 0;
+  for (long i = 0; i < 1000; ++i)
+    {
+      const size_t capacity = a.capacity ();
+      a.set (i, i);
+      if (a.capacity () != capacity)
+        {
+          ++allocations;
+          if (capacity != 0)
+            {
+              ++reallocations;
+              copied += i * sizeof (long);
+            }
+        }
+    }
+  Array_Telemetry::Stats s = Array_Telemetry::stats<Telemetry_Tag> ();
+  assert (s.allocations == allocations && allocations > 1);
+  assert (s.reallocations == reallocations && s.bytes_copied == copied);
+  assert (s.peak_capacity == a.capacity ());
+  assert (s.bytes_allocated >= a.capacity () * sizeof (long));
+
+  // Copies allocate without reallocating, and reserve () reallocates.
+  Tagged b (a);
+  b.reserve (4 * a.capacity ());
+  s = Array_Telemetry::stats<Telemetry_Tag> ();
+  assert (s.allocations == allocations + 2 && s.reallocations == reallocations + 1);
+  assert (s.bytes_copied == copied + 1000 * sizeof (long));
+  assert (s.peak_capacity == b.capacity ());
+
+  // The tagged arrays aren't counted under their element type.
+  const Array_Telemetry::Stats after = Array_Telemetry::stats<long> ();
+  assert (after.allocations == untagged.allocations && after.reallocations == untagged.reallocations);
+
+  // Untagged arrays are counted under their element type.
+  Array_Telemetry::reset<short> ();
+  Array<short> plain (10);
+  plain.resize (100);
+  s = Array_Telemetry::stats<short> ();
+  assert (s.allocations == 2 && s.reallocations == 1 && s.bytes_copied == 10 * sizeof (short));
+  assert (s.bytes_allocated == (10 + plain.capacity ()) * sizeof (short));
+
+  // The tag follows the allocator when it is rebound, and wraps any
+  // other allocator.
+  Array_Telemetry::reset<Telemetry_Map_Tag> ();
+  typedef std::pmr::polymorphic_allocator<std::pair<int, int> > PAIR_ALLOC;
+  typedef Array_Tagged_Allocator<std::pair<int, int>, Telemetry_Map_Tag, PAIR_ALLOC> TAGGED_ALLOC;
+  std::pmr::monotonic_buffer_resource pool;
+  const TAGGED_ALLOC tagged = PAIR_ALLOC (&pool);
+  Hash_Map<int, int, std::hash<int>, std::equal_to<int>, TAGGED_ALLOC>
+    h (std::hash<int> (), std::equal_to<int> (), tagged);
+  for (int i = 0; i < 1000; ++i)
+    h.insert (i, i);
+  assert (h.at (999) == 999);
+  s = Array_Telemetry::stats<Telemetry_Map_Tag> ();
+  assert (s.allocations > 0 && s.peak_capacity == h.capacity ());
+
+  // A snapshot lists every tag with its counters.
+  bool found = false;
+  for (const Array_Telemetry::Entry &e : Array_Telemetry::snapshot ())
+    if (e.tag == "Telemetry_Tag")
+      {
+        assert (!found && e.stats.allocations == allocations + 2);
+        found = true;
+      }
+  assert (found);
+
+  Array_Telemetry::reset_all ();
+  s = Array_Telemetry::stats<Telemetry_Tag> ();
+  assert (s.allocations == 0 && s.bytes_allocated == 0 && s.reallocations == 0
+          && s.bytes_copied == 0 && s.peak_capacity == 0);
+
+  std::cout << "--Telemetry tests have finished--\n";
+}
+
+// Check every kernel of every instruction set this CPU supports
+// against the scalar kernels, for sizes around the vector widths.
+template <typename T>
+static void
+checkSIMDKernels (void)
+{
+  const Array_SIMD_Kernels<T> &ref = Array_SIMD::kernels<T> (Array_SIMD::SCALAR);
+
+  for (int isa = Array_SIMD::SSE2; isa <= Array_SIMD::best_isa (); ++isa)
+    {
+      const Array_SIMD_Kernels<T> &k = Array_SIMD::kernels<T> (Array_SIMD::ISA (isa));
+
+      for (size_t n : { 1, 3, 15, 16, 17, 63, 64, 65, 200, 1000, 40000 })
+        {
+          Array<T> a (n), b (n);
+          for (size_t i = 0; i < n; ++i)
+            {
+              a[i] = T ((i * 7 + 3) % 11);
+              b[i] = T ((i * 5 + 1) % 7);
+            }
+          a[n / 2] = T (-2);
+          b[n - 1] = T (12);
+
+          assert (k.find (a.data (), n, T (12)) == n);
+          assert (k.find (b.data (), n, T (12)) == ref.find (b.data (), n, T (12)));
+          assert (k.find (a.data (), n, T (5)) == ref.find (a.data (), n, T (5)));
+          assert (k.count (a.data (), n, T (3)) == ref.count (a.data (), n, T (3)));
+          assert (k.min (a.data (), n) == ref.min (a.data (), n));
+          assert (k.max (b.data (), n) == ref.max (b.data (), n));
+
+          // Small integral values keep floating point sums exact.
+          if (sizeof (T) > 1)
+            {
+              assert (k.sum (a.data (), n) == ref.sum (a.data (), n));
+              assert (k.dot (a.data (), b.data (), n) == ref.dot (a.data (), b.data (), n));
+            }
+
+          Array<T> c (a);
+          assert (k.equal (a.data (), c.data (), n));
+          c[n - 1] = T (13);
+          assert (!k.equal (a.data (), c.data (), n));
+
+          k.fill (c.data (), n, T (9));
+          assert (ref.count (c.data (), n, T (9)) == n);
+        }
+    }
+}
+
+void testSIMD (void)
+{
+  std::cout << "--Testing SIMD kernels ("
+            << Array_SIMD::isa_name (Array_SIMD::best_isa ()) << ")--\n";
+
+  checkSIMDKernels<signed char> ();
+  checkSIMDKernels<unsigned short> ();
+  checkSIMDKernels<int> ();
+  checkSIMDKernels<long long> ();
+  checkSIMDKernels<float> ();
+  checkSIMDKernels<double> ();
+
+  // The counts of 8-bit lanes must not wrap.
+  Array<char> chars (100000, 'q');
+  assert (Array_SIMD::count (chars, 'q') == 100000);
+  assert (Array_SIMD::find (chars, 'r') == chars.size ());
+
+  Array<int> ints (1000, 1);
+  ints[500] = -4;
+  ints[999] = 8;
+  assert (Array_SIMD::min (ints) == -4);
+  assert (Array_SIMD::max (ints) == 8);
+  assert (Array_SIMD::sum (ints) == 998 - 4 + 8);
+  assert (Array_SIMD::dot (ints, ints) == 998 + 16 + 64);
+  assert (Array_SIMD::equal (ints, Array<int> (ints)));
+  Array_SIMD::fill (ints, 2);
+  assert (Array_SIMD::sum (ints) == 2000);
+
+  // Floating point equality is by value: -0.0 == 0.0.
+  Array<double> zeros (100, 0.0), negative_zeros (100, -0.0);
+  assert (Array_SIMD::equal (zeros, negative_zeros));
+
+  Small_Array<float, 32> small (20, 1.5f);
+  assert (Array_SIMD::sum (small) == 30.0f);
+
+  Array<int> empty (0);
+  bool caught = false;
+  try { Array_SIMD::min (empty); }
+  catch (std::out_of_range &) { caught = true; }
+  assert (caught);
+  caught = false;
+  try { Array_SIMD::dot (empty, ints); }
+  catch (std::length_error &) { caught = true; }
+  assert (caught);
+
+  std::cout << "--SIMD kernel tests have finished--\n";
+}
+
+int
+main (int, char *[])
+{
+  testGrowthPolicies ();
+  testReserve ();
+  testMoves ();
+  testSingleWrite ();
+  testAt ();
+  testIterators ();
+  testBulkPaths ();
+  testSmallArray ();
+  testAllocators ();
+  testRanges ();
+  testCOW ();
+  testMappedArray ();
+  testSoA ();
+  testParallel ();
+  testAligned ();
+  testSegmented ();
+  testHugePages ();
+  testLazyZero ();
+  testStaticArray ();
+  testAssignReuse ();
+  testSortedArray ();
+  testBitArray ();
+  testCompressedArray ();
+  testHashMap ();
+  testTelemetry ();
+  testSIMD ();
+
+  return 0;
+}
@@ -4,133 +4,463 @@
 #include <sys/types.h>
 
 #include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
 #include <memory>
+#include <mutex>
 #include <sstream>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "Array.h"
+#include "Array_Ops.h"
 
 #if !defined (__INLINE__)
 #define INLINE
 #include "Array.inl"
 #endif /* __INLINE__ */
 
-template <typename T> 
-Array<T>::Array (size_t size) : cur_size_ (size), max_size_ (size), array_ (new T[size])
+// Elements are constructed directly in raw storage, so each one is
+// written exactly once.
+
+template <typename T, typename ALLOC> 
+Array<T, ALLOC>::Array (size_t size,
+			const Array_Growth_Policy &growth,
+			const ALLOC &alloc) : max_size_ (size), cur_size_ (size), growth_ (growth), array_ (size, alloc)
+{
+	Array_Telemetry::allocated<TELEMETRY_TAG> (max_size_, sizeof (T));
+	Array_Ops<T, ALLOC>::default_construct (array_.get_allocator(), array_.get(), array_.get()+cur_size_);
+}
+
+template <typename T, typename ALLOC> 
+Array<T, ALLOC>::Array (size_t size,
+			const ALLOC &alloc) : max_size_ (size), cur_size_ (size), array_ (size, alloc)
 {
+	Array_Telemetry::allocated<TELEMETRY_TAG> (max_size_, sizeof (T));
+	Array_Ops<T, ALLOC>::default_construct (array_.get_allocator(), array_.get(), array_.get()+cur_size_);
 }
 
-template <typename T> 
-Array<T>::Array (size_t size, 
-		 const T &default_value) : cur_size_ (size), max_size_ (size) , default_value_ (new T(default_value)), array_(new T[size])
+template <typename T, typename ALLOC> 
+Array<T, ALLOC>::Array (size_t size, 
+			const T &default_value,
+			const Array_Growth_Policy &growth,
+			const ALLOC &alloc) : max_size_ (size), cur_size_ (size), default_value_ (default_value), growth_ (growth), array_(size, alloc, is_zero (default_value))
 {
-	std::fill(array_.get(), array_.get()+cur_size_,default_value);
+	Array_Telemetry::allocated<TELEMETRY_TAG> (max_size_, sizeof (T));
+	if (!is_zero (default_value))
+		Array_Ops<T, ALLOC>::fill_construct (array_.get_allocator(), array_.get(), array_.get()+cur_size_, default_value);
 }
 
 // The copy constructor (performs initialization).
 
-template <typename T> 
-Array<T>::Array (const Array<T> &s) : cur_size_(s.size()), max_size_(s.size()), array_(new T[s.size()])
+template <typename T, typename ALLOC> 
+Array<T, ALLOC>::Array (const Array<T, ALLOC> &s) : max_size_(s.size()), cur_size_(s.size()), default_value_ (s.default_value_), growth_ (s.growth_), array_(s.size(), traits::select_on_container_copy_construction (s.get_allocator()))
+{
+	Array_Telemetry::allocated<TELEMETRY_TAG> (max_size_, sizeof (T));
+	Array_Ops<T, ALLOC>::copy_construct (array_.get_allocator(), s.array_.get(), s.array_.get()+cur_size_, array_.get());
+}
+
+template <typename T, typename ALLOC> 
+Array<T, ALLOC>::Array (const Array<T, ALLOC> &s,
+			const ALLOC &alloc) : max_size_(s.size()), cur_size_(s.size()), default_value_ (s.default_value_), growth_ (s.growth_), array_(s.size(), alloc)
+{
+	Array_Telemetry::allocated<TELEMETRY_TAG> (max_size_, sizeof (T));
+	Array_Ops<T, ALLOC>::copy_construct (array_.get_allocator(), s.array_.get(), s.array_.get()+cur_size_, array_.get());
+}
+
+template <typename T, typename ALLOC> bool
+Array<T, ALLOC>::is_zero (const T &value)
+{
+	if constexpr (std::is_trivial<T>::value) {
+		const unsigned char *bytes = reinterpret_cast<const unsigned char *> (&value);
+		return std::all_of (bytes, bytes+sizeof (T), [] (unsigned char b) { return b == 0; });
+	}
+	else
+		return false;
+}
+
+template <typename T, typename ALLOC> void
+Array<T, ALLOC>::reallocate (size_t new_capacity, bool zeroed)
 {
-	if (s.default_value_) default_value_.reset (new T(s.default_value_));
-	std::copy (s.begin(),s.end(),array_.get());
+	scoped_array<T, ALLOC> new_array (new_capacity, array_.get_allocator(), zeroed);
+	Array_Ops<T, ALLOC>::relocate (array_.get_allocator(), array_.get(), array_.get()+cur_size_, new_array.get());
+	Array_Ops<T, ALLOC>::destroy (array_.get_allocator(), array_.get(), array_.get()+cur_size_);
+	array_.swap (new_array);
+	max_size_ = new_capacity;
+	// <new_array> now holds the old buffer, if there was one to move
+	// out of.
+	Array_Telemetry::allocated<TELEMETRY_TAG> (new_capacity, sizeof (T));
+	if (new_array.get() != 0)
+		Array_Telemetry::reallocated<TELEMETRY_TAG> (cur_size_ * sizeof (T));
 }
 
-template <typename T> void
-Array<T>::resize (size_t new_size)
+template <typename T, typename ALLOC> void
+Array<T, ALLOC>::resize (size_t new_size)
 {
 	if (new_size == cur_size_) return;
 	else if (new_size < cur_size_) {
+		Array_Ops<T, ALLOC>::destroy (array_.get_allocator(), array_.get()+new_size, array_.get()+cur_size_);
 		cur_size_ = new_size;
 	}
 	else {
-		if (new_size < max_size_ && default_value_.get())  {
-			std::fill (array_.get()+cur_size_, array_.get()+new_size, *default_value_.get());
-			cur_size_ = new_size;
-		}
-		else {
-			scoped_array<T> new_array (new T[new_size]);
-			std::copy (begin(),end(),new_array.get());
-			if (default_value_.get())
-				std::fill (new_array.get()+cur_size_,new_array.get()+new_size, *default_value_.get());
-			array_.swap (new_array);
-			cur_size_ = max_size_ = new_size;
+		// Grow geometrically (per <growth_>) so that repeated calls to
+		// set() past the end cost amortized O(1) instead of O(n).
+		if (new_size > max_size_) {
+			const bool zeroed = default_value_ && is_zero (*default_value_);
+			reallocate (growth_.next_capacity (max_size_, new_size), zeroed);
+			if (zeroed) {
+				cur_size_ = new_size;
+				return;
+			}
 		}
+		if (default_value_)
+			Array_Ops<T, ALLOC>::fill_construct (array_.get_allocator(), array_.get()+cur_size_, array_.get()+new_size, *default_value_);
+		else
+			Array_Ops<T, ALLOC>::default_construct (array_.get_allocator(), array_.get()+cur_size_, array_.get()+new_size);
+		cur_size_ = new_size;
+	}
+}
+
+template <typename T, typename ALLOC> template <typename... ARGS> T &
+Array<T, ALLOC>::construct_past_end (size_t index, ARGS &&... args)
+{
+	if (index >= max_size_) {
+		// <args> may refer to one of our own elements, so build the
+		// item before the old buffer goes away.
+		T item (std::forward<ARGS> (args)...);
+		const bool zeroed = default_value_ && is_zero (*default_value_);
+		reallocate (growth_.next_capacity (max_size_, index+1), zeroed);
+		if (zeroed)
+			cur_size_ = index;
+		else
+			resize (index);
+		traits::construct (array_.get_allocator(), array_.get()+index, std::move (item));
+	}
+	else {
+		resize (index);
+		traits::construct (array_.get_allocator(), array_.get()+index, std::forward<ARGS> (args)...);
 	}
+	cur_size_ = index+1;
+	return array_[index];
 }
 
-template <typename T> void
-Array<T>::swap (Array<T> &new_array)
+template <typename T, typename ALLOC> void
+Array<T, ALLOC>::reserve (size_t new_capacity)
+{
+	if (new_capacity > max_size_)
+		reallocate (new_capacity);
+}
+
+template <typename T, typename ALLOC> void
+Array<T, ALLOC>::shrink_to_fit (void)
+{
+	if (cur_size_ < max_size_)
+		reallocate (cur_size_);
+}
+
+template <typename T, typename ALLOC> void
+Array<T, ALLOC>::swap (Array<T, ALLOC> &new_array)
 {
 	std::swap (cur_size_,new_array.cur_size_);
 	std::swap (max_size_,new_array.max_size_);
-	default_value_.swap(new_array.default_value_);
+	std::swap (growth_,new_array.growth_);
+	std::swap (default_value_,new_array.default_value_);
 	array_.swap(new_array.array_);
 }
 
-// Assignment operator (performs assignment). 
+// Assignment operator (performs assignment).  If copying a T can't
+// throw and <s> fits in our buffer, the elements are copied in place:
+// nothing can fail halfway, so the strong guarantee holds without
+// allocating a temporary.  Otherwise copy-and-swap provides it.
 
-template <typename T> Array<T> &
-Array<T>::operator= (const Array<T> &s)
+template <typename T, typename ALLOC> Array<T, ALLOC> &
+Array<T, ALLOC>::operator= (const Array<T, ALLOC> &s)
 {
 	if (this == &s) return *this;
-	Array<T> temp(s);
+	if constexpr (std::is_nothrow_copy_constructible<T>::value
+		      && std::is_nothrow_copy_assignable<T>::value) {
+		if (s.cur_size_ <= max_size_) {
+			const size_t common = std::min (cur_size_, s.cur_size_);
+			Array_Ops<T, ALLOC>::copy_assign_n (s.array_.get(), common, array_.get());
+			if (s.cur_size_ > cur_size_)
+				Array_Ops<T, ALLOC>::copy_construct (array_.get_allocator(), s.array_.get()+common, s.array_.get()+s.cur_size_, array_.get()+common);
+			else
+				Array_Ops<T, ALLOC>::destroy (array_.get_allocator(), array_.get()+common, array_.get()+cur_size_);
+			cur_size_ = s.cur_size_;
+			default_value_ = s.default_value_;
+			growth_ = s.growth_;
+			return *this;
+		}
+	}
+	Array<T, ALLOC> temp(s, get_allocator());
 	swap(temp);
 	return *this;
 }
 
+// Move constructor (takes over the storage of <s>).
+
+template <typename T, typename ALLOC> 
+Array<T, ALLOC>::Array (Array<T, ALLOC> &&s) noexcept : max_size_ (0), cur_size_ (0), growth_ (s.growth_), array_ (std::move (s.get_allocator()))
+{
+	swap (s);
+}
+
+// Allocator-extended move constructor.  The storage of <s> can only be
+// taken over if it came from an allocator equal to <alloc>; otherwise
+// the elements are moved one by one.
+
+template <typename T, typename ALLOC> 
+Array<T, ALLOC>::Array (Array<T, ALLOC> &&s,
+			const ALLOC &alloc) : max_size_ (0), cur_size_ (0), growth_ (s.growth_), array_ (alloc)
+{
+	if (traits::is_always_equal::value || alloc == s.get_allocator())
+		swap (s);
+	else {
+		reserve (s.cur_size_);
+		Array_Ops<T, ALLOC>::relocate (array_.get_allocator(), s.array_.get(), s.array_.get()+s.cur_size_, array_.get());
+		cur_size_ = s.cur_size_;
+		std::swap (default_value_, s.default_value_);
+		s.resize (0);
+	}
+}
+
+// Move assignment operator.
+
+template <typename T, typename ALLOC> Array<T, ALLOC> &
+Array<T, ALLOC>::operator= (Array<T, ALLOC> &&s)
+  noexcept (std::allocator_traits<ALLOC>::is_always_equal::value
+	    || std::allocator_traits<ALLOC>::propagate_on_container_move_assignment::value)
+{
+	if (this == &s) return *this;
+	if constexpr (traits::propagate_on_container_move_assignment::value) {
+		// Release our storage while we still have its allocator, then
+		// adopt the allocator of <s> along with its storage.
+		Array<T, ALLOC> temp (std::move (s));
+		resize (0);
+		array_.reset ();
+		max_size_ = 0;
+		array_.get_allocator() = temp.array_.get_allocator();
+		swap (temp);
+	}
+	else {
+		Array<T, ALLOC> temp (std::move (s), get_allocator());
+		swap (temp);
+	}
+	return *this;
+}
+
 // Clean up the array (e.g., delete dynamically allocated memory).
 
-template <typename T> 
-Array<T>::~Array (void)
+template <typename T, typename ALLOC> 
+Array<T, ALLOC>::~Array (void)
 {
+	Array_Ops<T, ALLOC>::destroy (array_.get_allocator(), array_.get(), array_.get()+cur_size_);
 }
 
 // = Set/get methods.
 
 // Set an item in the array at location index.  
 
-template <typename T> void
-Array<T>::set (const T &new_item, size_t index)
+template <typename T, typename ALLOC> void
+Array<T, ALLOC>::set (const T &new_item, size_t index)
+{
+	if (index >= cur_size_)
+		construct_past_end (index, new_item);
+	else
+		array_[index] = new_item;
+}
+
+template <typename T, typename ALLOC> void
+Array<T, ALLOC>::set (T &&new_item, size_t index)
 {
-	if (index >= cur_size_) {
-		resize(index+1);
-	}//throw std::out_of_range("Index out of range");
-	array_[index] = new_item;
+	if (index >= cur_size_)
+		construct_past_end (index, std::move (new_item));
+	else
+		array_[index] = std::move (new_item);
+}
+
+template <typename T, typename ALLOC> template <typename... ARGS> T &
+Array<T, ALLOC>::emplace (size_t index, ARGS &&... args)
+{
+	if (index >= cur_size_)
+		return construct_past_end (index, std::forward<ARGS> (args)...);
+	array_[index] = T (std::forward<ARGS> (args)...);
+	return array_[index];
 }
 
 // Get an item in the array at location index.
 
-template <typename T> void
-Array<T>::get (T &item, size_t index)
+template <typename T, typename ALLOC> void
+Array<T, ALLOC>::get (T &item, size_t index)
 {
 	if (index >= cur_size_) throw std::out_of_range("Index out of range");
 	item = array_[index];
 }
 
-// Compare this array with <s> for equality.
+// = Bulk set/get methods.
 
-template <typename T> bool
-Array<T>::operator== (const Array<T> &s) const
+template <typename T, typename ALLOC> template <typename ITER> bool
+Array<T, ALLOC>::aliases (ITER first, size_t n) const
 {
-	return cur_size_ == s.cur_size_ && std::equal(begin(),end(),s.begin());
+	const void *p = 0;
+#if defined (__cpp_lib_concepts)
+	if constexpr (std::contiguous_iterator<ITER>)
+		p = n ? std::to_address (first) : 0;
+#else
+	if constexpr (std::is_pointer<ITER>::value)
+		p = first;
+#endif /* __cpp_lib_concepts */
+	std::less<const void *> less;
+	return n != 0 && p != 0
+		&& !less (p, array_.get()) && less (p, array_.get()+cur_size_);
 }
 
-// Compare this array with <s> for inequality.
+template <typename T, typename ALLOC> template <typename ITER> void
+Array<T, ALLOC>::write_range (size_t offset, ITER first, size_t n)
+{
+	const size_t end = offset+n;
+	if (end < offset) throw std::length_error ("Range too long");
+	if (end > max_size_) {
+		if (aliases (first, n)) {
+			// Copy the source out of the buffer before it goes away.
+			Array<T, ALLOC> temp (0, get_allocator());
+			temp.assign (first, std::next (first, n));
+			reallocate (growth_.next_capacity (max_size_, end));
+			write_range (offset, temp.array_.get(), n);
+			return;
+		}
+		reallocate (growth_.next_capacity (max_size_, end));
+	}
+	if (offset > cur_size_)
+		resize (offset);
+
+	// Overwrite the live elements, then construct the rest past the end.
+	const size_t live = std::min (n, cur_size_-offset);
+	first = Array_Ops<T, ALLOC>::copy_assign_n (first, live, array_.get()+offset);
+	Array_Ops<T, ALLOC>::copy_construct_n (array_.get_allocator(), first, n-live, array_.get()+cur_size_);
+	cur_size_ = std::max (cur_size_, end);
+}
 
-template <typename T> bool
-Array<T>::operator!= (const Array<T> &s) const
+template <typename T, typename ALLOC> template <typename ITER> void
+Array<T, ALLOC>::assign (ITER first, ITER last)
 {
-	return !(cur_size_ == s.cur_size_ && std::equal(begin(),end(),s.begin()));
+	if constexpr (std::is_base_of<std::forward_iterator_tag,
+		      typename std::iterator_traits<ITER>::iterator_category>::value) {
+		const size_t n = std::distance (first, last);
+		if (n > max_size_) {
+			scoped_array<T, ALLOC> new_array (n, array_.get_allocator());
+			Array_Ops<T, ALLOC>::copy_construct_n (new_array.get_allocator(), first, n, new_array.get());
+			Array_Ops<T, ALLOC>::destroy (array_.get_allocator(), array_.get(), array_.get()+cur_size_);
+			array_.swap (new_array);
+			max_size_ = cur_size_ = n;
+			Array_Telemetry::allocated<TELEMETRY_TAG> (n, sizeof (T));
+		}
+		else {
+			write_range (0, first, n);
+			resize (n);
+		}
+	}
+	else {
+		resize (0);
+		for (size_t i = 0; first != last; ++first, ++i)
+			set (*first, i);
+	}
 }
 
-template <typename T>
-Array_Iterator<T>::Array_Iterator (Array<T> &array, size_t pos) : array_ (array), pos_ (pos)
+template <typename T, typename ALLOC> template <typename ITER> void
+Array<T, ALLOC>::append (ITER first, ITER last)
 {
+	set_range (cur_size_, first, last);
 }
 
-template <typename T>
-Const_Array_Iterator<T>::Const_Array_Iterator (const Array<T> &array, size_t pos) : array_ (array), pos_ (pos)
+template <typename T, typename ALLOC> template <typename ITER> void
+Array<T, ALLOC>::set_range (size_t offset, ITER first, ITER last)
+{
+	if constexpr (std::is_base_of<std::forward_iterator_tag,
+		      typename std::iterator_traits<ITER>::iterator_category>::value)
+		write_range (offset, first, std::distance (first, last));
+	else
+		for (; first != last; ++first, ++offset)
+			set (*first, offset);
+}
+
+template <typename T, typename ALLOC> template <typename OUT> OUT
+Array<T, ALLOC>::get_range (size_t offset, size_t n, OUT out) const
+{
+	if (offset > cur_size_ || n > cur_size_-offset) throw std::out_of_range("Index out of range");
+	if constexpr (Array_Bitwise_Iterator<T, OUT>::value) {
+		if (n != 0)
+			std::memmove (static_cast<void *> (&*out), array_.get()+offset, n*sizeof (T));
+		return out + n;
+	}
+	else
+		return std::copy_n (array_.get()+offset, n, out);
+}
+
+// = Parallel methods.
+
+template <typename T, typename ALLOC> template <typename F> void
+Array<T, ALLOC>::parallel_for_each (F f, const Array_Parallel_Policy &policy)
+{
+	T *items = array_.get();
+	Array_Thread_Pool::for_each_range (cur_size_, policy,
+					   [items, &f] (size_t begin, size_t end) {
+						   for (size_t i = begin; i < end; ++i)
+							   f (items[i]);
+					   });
+}
+
+template <typename T, typename ALLOC> template <typename F> void
+Array<T, ALLOC>::parallel_transform (F f, const Array_Parallel_Policy &policy)
+{
+	T *items = array_.get();
+	Array_Thread_Pool::for_each_range (cur_size_, policy,
+					   [items, &f] (size_t begin, size_t end) {
+						   for (size_t i = begin; i < end; ++i)
+							   items[i] = f (items[i]);
+					   });
+}
+
+template <typename T, typename ALLOC> template <typename U, typename OP> U
+Array<T, ALLOC>::parallel_reduce (U init, OP op, const Array_Parallel_Policy &policy) const
+{
+	// Record each range's result, then combine them in order so the
+	// outcome doesn't depend on which thread finished first.
+	const T *items = array_.get();
+	std::vector<std::pair<size_t, U> > partials;
+	std::mutex lock;
+	Array_Thread_Pool::for_each_range (cur_size_, policy,
+					   [items, &op, &partials, &lock] (size_t begin, size_t end) {
+						   U result (items[begin]);
+						   for (size_t i = begin+1; i < end; ++i)
+							   result = op (std::move (result), items[i]);
+						   std::lock_guard<std::mutex> guard (lock);
+						   partials.push_back (std::make_pair (begin, std::move (result)));
+					   });
+	std::sort (partials.begin (), partials.end (),
+		   [] (const std::pair<size_t, U> &a, const std::pair<size_t, U> &b) { return a.first < b.first; });
+	for (size_t i = 0; i < partials.size (); ++i)
+		init = op (std::move (init), std::move (partials[i].second));
+	return init;
+}
+
+// Compare this array with <s> for equality.
+
+template <typename T, typename ALLOC> bool
+Array<T, ALLOC>::operator== (const Array<T, ALLOC> &s) const
+{
+	return cur_size_ == s.cur_size_ && Array_Ops<T, ALLOC>::elements_equal (array_.get(), s.array_.get(), cur_size_);
+}
+
+// Compare this array with <s> for inequality.
+
+template <typename T, typename ALLOC> bool
+Array<T, ALLOC>::operator!= (const Array<T, ALLOC> &s) const
 {
+	return !(*this == s);
 }
 
 #endif /* ARRAY_CPP */
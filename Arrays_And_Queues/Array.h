@@ -6,9 +6,101 @@
 
 // This header defines "size_t"
 #include <stdlib.h>
+#include <cstddef>
+#include <iterator>
 #include <stdexcept>
 #include <memory>
+#include <optional>
+#include <utility>
 #include "scoped_array.h"
+#include "Array_Parallel.h"
+#include "Array_Telemetry.h"
+
+// Controls whether <Array::operator[]> checks its index.  Unless it is
+// set explicitly (e.g., -DARRAY_BOUNDS_CHECK=1), indexing is checked in
+// debug builds and the check is compiled out completely when NDEBUG is
+// defined, so tight loops over an <Array> can be vectorized.
+// <Array::at> is always checked.
+#if !defined (ARRAY_BOUNDS_CHECK)
+# if defined (NDEBUG)
+#  define ARRAY_BOUNDS_CHECK 0
+# else
+#  define ARRAY_BOUNDS_CHECK 1
+# endif /* NDEBUG */
+#endif /* ARRAY_BOUNDS_CHECK */
+
+/**
+ * @class Array_Growth_Policy
+ * @brief Decides how much storage an <Array> reserves when it has to
+ *        grow past its current capacity.
+ *
+ * Growing geometrically (doubling or 1.5x) makes a sequence of
+ * <Array::set> calls at increasing indices amortized O(1) per call.
+ * A fixed step trades that guarantee for a tighter memory bound.
+ */
+class Array_Growth_Policy
+{
+public:
+  enum Strategy
+  {
+    DOUBLE,         // new capacity = 2 * old capacity
+    ONE_AND_HALF,   // new capacity = 1.5 * old capacity
+    FIXED_STEP      // new capacity = old capacity + step
+  };
+
+  explicit Array_Growth_Policy (Strategy strategy = DOUBLE, size_t step = 1)
+    : strategy_ (strategy), step_ (step == 0 ? 1 : step)
+  {
+  }
+
+  // = Factory methods for the common policies.
+  static Array_Growth_Policy doubling (void)
+  {
+    return Array_Growth_Policy (DOUBLE);
+  }
+
+  static Array_Growth_Policy one_and_half (void)
+  {
+    return Array_Growth_Policy (ONE_AND_HALF);
+  }
+
+  static Array_Growth_Policy fixed_step (size_t step)
+  {
+    return Array_Growth_Policy (FIXED_STEP, step);
+  }
+
+  // Returns the capacity to allocate when an array that currently
+  // holds <current> elements must hold at least <required> elements.
+  // The result is never smaller than <required>.
+  size_t next_capacity (size_t current, size_t required) const
+  {
+    size_t next = current;
+
+    switch (strategy_)
+      {
+      case DOUBLE:
+        next = current * 2;
+        break;
+      case ONE_AND_HALF:
+        next = current + current / 2;
+        break;
+      case FIXED_STEP:
+        next = current + step_;
+        break;
+      }
+
+    // Guard against overflow as well as against tiny starting sizes.
+    return next < required || next < current ? required : next;
+  }
+
+  Strategy strategy (void) const { return strategy_; }
+
+  size_t step (void) const { return step_; }
+
+private:
+  Strategy strategy_;
+  size_t step_;
+};
 
 // Solve circular include problem
 template <typename T>
@@ -21,40 +113,85 @@ class Const_Array_Iterator;
 /**
  * @class Array
  * @brief Implements a vector that resizes.
+ *
+ * The storage buffer is obtained from an allocator of type <ALLOC>,
+ * which may be any standard conforming allocator, e.g., std::allocator
+ * or std::pmr::polymorphic_allocator (so all the arrays of a request
+ * can live in one std::pmr::monotonic_buffer_resource).  Allocators are
+ * propagated like the standard containers do.  <Array_Aligned_Allocator>
+ * gives cache-line or page aligned buffers.
  */
-template <typename T>
+template <typename T, typename ALLOC = std::allocator<T> >
 class Array
 {
 public:
   // Define a "trait"
   typedef T value_type;
+  typedef ALLOC allocator_type;
 
   // = Initialization and termination methods.
 
-  // Dynamically create an uninitialized array.  Throws <std::bad_alloc>
-  // if allocation fails.
-  Array (size_t size);
+  // Dynamically create an uninitialized array.  The <growth> policy
+  // decides how much extra capacity to reserve whenever the array has
+  // to grow.  Throws <std::bad_alloc> if allocation fails.
+  Array (size_t size,
+         const Array_Growth_Policy &growth = Array_Growth_Policy (),
+         const ALLOC &alloc = ALLOC ());
+
+  // Dynamically create an uninitialized array in storage obtained from
+  // <alloc>.  Throws <std::bad_alloc> if allocation fails.
+  Array (size_t size, const ALLOC &alloc);
 
   // Dynamically initialize the entire array to the <default_value>.
-  // Throws <std::bad_alloc> if allocation fails.
-  Array (size_t size, const T &default_value);
+  // If T is trivial and <default_value> is all zero bytes, the buffer
+  // is allocated zeroed instead of filled (see <scoped_array>), so the
+  // pages of a large array are only touched when first used.  Throws
+  // <std::bad_alloc> if allocation fails.
+  Array (size_t size,
+         const T &default_value,
+         const Array_Growth_Policy &growth = Array_Growth_Policy (),
+         const ALLOC &alloc = ALLOC ());
 
   // The copy constructor performs initialization by making an exact
   // copy of the contents of parameter <s>, i.e., *this == s will
   // return true.  Throws <std::bad_alloc> if allocation fails.
-  Array (const Array<T> &s);
+  Array (const Array<T, ALLOC> &s);
+
+  // Same as above, but the copy allocates from <alloc>.
+  Array (const Array<T, ALLOC> &s, const ALLOC &alloc);
 
   // Assignment operator performs an assignment by making a copy of
   // the contents of parameter <s>, i.e., *this == s will return true.
   // Throws <std::bad_alloc> if allocation fails.  If any exceptions
   // occur, however, the state of the original array remains unchanged
   // (i.e., implement "strong exception guarantee" semantics).
-  Array<T> &operator= (const Array<T> &s);
+  // The array keeps its own allocator.  If <s> fits in the current
+  // buffer and copying a T can't throw, the buffer is reused instead
+  // of allocating a new one.
+  Array<T, ALLOC> &operator= (const Array<T, ALLOC> &s);
+
+  // The move constructor takes over the storage of <s> in O(1) and
+  // leaves <s> empty (size() and capacity() are both 0).  Does not
+  // throw an exception.
+  Array (Array<T, ALLOC> &&s) noexcept;
+
+  // Allocator-extended move constructor.  Takes over the storage of
+  // <s> if its allocator equals <alloc>, else moves the elements into
+  // new storage obtained from <alloc>.  Leaves <s> empty.
+  Array (Array<T, ALLOC> &&s, const ALLOC &alloc);
+
+  // Move assignment releases our storage and takes over that of <s>,
+  // leaving <s> empty.  If <ALLOC> doesn't propagate on move
+  // assignment and the allocators differ, the elements are moved one
+  // by one instead, which may throw <std::bad_alloc>.
+  Array<T, ALLOC> &operator= (Array<T, ALLOC> &&s)
+    noexcept (std::allocator_traits<ALLOC>::is_always_equal::value
+              || std::allocator_traits<ALLOC>::propagate_on_container_move_assignment::value);
 
   // Clean up the array (e.g., delete dynamically allocated memory).
   ~Array (void);
 
-  // = Forward iterator definitions
+  // = Random access iterator definitions
   typedef Array_Iterator<T> iterator;
   typedef Const_Array_Iterator<T> const_iterator;
 
@@ -70,6 +207,13 @@ public:
   // Get a const iterator that points to the end of the list.
   const_iterator end (void) const;
 
+  // Get a pointer to the first element of the array's contiguous
+  // storage.  [data(), data() + size()) is always a valid range.
+  T *data (void);
+
+  // Get a const pointer to the first element of the array.
+  const T *data (void) const;
+
   // = Set/get methods.
 
   // Set an item in the array at location index.  If <index> >=
@@ -77,46 +221,185 @@ public:
   // Throws <std::bad_alloc> if resizing the array fails.
   void set (const T &new_item, size_t index);
 
+  // Same as above, but moves <new_item> into the array instead of
+  // copying it.
+  void set (T &&new_item, size_t index);
+
+  // Build a new item in the array at location index from <args>,
+  // growing the array as <set> does.  Returns a reference to the new
+  // item.  Throws <std::bad_alloc> if resizing the array fails.
+  template <typename... ARGS>
+  T &emplace (size_t index, ARGS &&... args);
+
   // Get an item in the array at location index.  Throws <std::out_of_range>
   // of index is not <in_range>.
   void get (T &item, size_t index);
 
+  // = Bulk set/get methods.  Each allocates at most once (unless the
+  // source is part of this array and the array has to grow) and
+  // copies trivially copyable elements with memcpy/memmove.  The
+  // source may be part of this array, but for types that aren't
+  // trivially copyable it must not overlap the destination from below.
+  // Input iterators that can't be traversed twice are copied one
+  // element at a time.
+
+  // Replace the contents of the array with copies of [<first>,
+  // <last>).  If they don't fit in the current buffer, they are built
+  // in a new buffer of exactly that size and the array is unchanged if
+  // that fails.  Throws <std::bad_alloc> if allocation fails.
+  template <typename ITER>
+  void assign (ITER first, ITER last);
+
+  // Same as above, for the <n> elements at <src>.
+  void assign (const T *src, size_t n);
+
+  // Copy [<first>, <last>) to the end of the array, growing it
+  // according to its growth policy.  Throws <std::bad_alloc> if
+  // allocation fails.
+  template <typename ITER>
+  void append (ITER first, ITER last);
+
+  // Same as above, for the <n> elements at <src>.
+  void append (const T *src, size_t n);
+
+  // Copy [<first>, <last>) to the elements starting at <offset>.  If
+  // the range extends past <size>, the array grows as it does for
+  // <set>.  Throws <std::bad_alloc> if allocation fails.
+  template <typename ITER>
+  void set_range (size_t offset, ITER first, ITER last);
+
+  // Same as above, for the <n> elements at <src>.
+  void set_range (size_t offset, const T *src, size_t n);
+
+  // Copy the <n> elements starting at <offset> to <out>, which may be
+  // any output iterator (e.g., a T *).  Returns <out> advanced past
+  // the last element copied.  Throws <std::out_of_range> unless all of
+  // them are <in_range>.
+  template <typename OUT>
+  OUT get_range (size_t offset, size_t n, OUT out) const;
+
+  // = Parallel methods.  Each splits the array into ranges of at least
+  // <policy>.grain () elements and hands them to up to
+  // <policy>.threads () threads of <Array_Thread_Pool>, so <f> and
+  // <op> must be safe to call concurrently.  If a call throws, the
+  // ranges not yet started are skipped and the exception is rethrown
+  // once the others have finished.
+
+  // Call <f> (item) for every element of the array.
+  template <typename F>
+  void parallel_for_each (F f, const Array_Parallel_Policy &policy = Array_Parallel_Policy::defaults ());
+
+  // Replace every element of the array with <f> (element).
+  template <typename F>
+  void parallel_transform (F f, const Array_Parallel_Policy &policy = Array_Parallel_Policy::defaults ());
+
+  // Returns <init> combined with all the elements by the associative
+  // <op>, which is called as <op> (U, T) within a range and as <op>
+  // (U, U) to combine the results of the ranges, in order.  Each range
+  // starts from its first element converted to <U>.
+  template <typename U, typename OP>
+  U parallel_reduce (U init, OP op, const Array_Parallel_Policy &policy = Array_Parallel_Policy::defaults ()) const;
+
   // Returns the <cur_size_> of the array.
   size_t size (void) const;
 
-  // Returns a reference to the <index> element in the <Array> without
-  // checking for range errors.
+  // Returns the <max_size_> of the array, i.e., the number of elements
+  // it can hold before <resize> has to allocate a new buffer.
+  size_t capacity (void) const;
+
+  // Returns a reference to the <index> element in the <Array>.  The
+  // index is only checked if ARRAY_BOUNDS_CHECK is enabled, in which
+  // case <std::out_of_range> is thrown if it is not <in_range>.
   const T &operator[] (size_t index) const;
 
-  // Set an item in the array at location index without 
-  // checking for range errors.
+  // Set an item in the array at location index.  The index is only
+  // checked if ARRAY_BOUNDS_CHECK is enabled.
   T &operator[] (size_t index);
 
+  // Returns a reference to the <index> element in the <Array>.  Always
+  // throws <std::out_of_range> if <index> is not <in_range>.
+  const T &at (size_t index) const;
+
+  // Set an item in the array at location index.  Always throws
+  // <std::out_of_range> if <index> is not <in_range>.
+  T &at (size_t index);
+
   // Compare this array with <s> for equality.  Returns true if the
   // size()'s of the two arrays are equal and all the elements from 0
   // .. size() are equal, else false.
-  bool operator== (const Array<T> &s) const;
+  bool operator== (const Array<T, ALLOC> &s) const;
 
   // Compare this array with <s> for inequality such that <*this> !=
   // <s> is always the complement of the boolean return value of
   // <*this> == <s>.
-  bool operator!= (const Array<T> &s) const;
+  bool operator!= (const Array<T, ALLOC> &s) const;
 
   // Change the size of the array to be at least <new_size> elements.
   // If a <default_value> was given in the <Array> constructor then
-  // make sure any new elements are initialized accordingly.  Throws
-  // <std::bad_alloc> if allocation fails.
+  // make sure any new elements are initialized accordingly.  A zero
+  // default is applied lazily when the array reallocates, as in the
+  // constructor.  Throws <std::bad_alloc> if allocation fails.
   void resize (size_t new_size);
 
+  // Make sure the array can hold at least <new_capacity> elements
+  // without reallocating.  Does not change <size>.  Throws
+  // <std::bad_alloc> if allocation fails.
+  void reserve (size_t new_capacity);
+
+  // Release any capacity beyond <size>.  Throws <std::bad_alloc> if
+  // allocation fails, in which case the array is left unchanged.
+  void shrink_to_fit (void);
+
+  // Returns the policy used to grow the array.
+  const Array_Growth_Policy &growth_policy (void) const;
+
+  // Returns the default value given in the constructor, if any.
+  const std::optional<T> &default_value (void) const;
+
   // Efficiently swap the contents of this array with <new_array>.
-  // Does not throw an exception.
-  void swap (Array<T> &new_array);
+  // Does not throw an exception.  Unless <ALLOC> propagates on swap,
+  // the two arrays' allocators must compare equal.
+  void swap (Array<T, ALLOC> &new_array);
+
+  // Returns a copy of the allocator used for the array's storage.
+  ALLOC get_allocator (void) const;
 
 private:
+  typedef std::allocator_traits<ALLOC> traits;
+
+  // The tag our allocations are counted under (see <Array_Telemetry>).
+  typedef typename Array_Telemetry_Tag<T, ALLOC>::type TELEMETRY_TAG;
+
   // Returns true if <index> is within range, i.e., 0 <= <index> <
   // <cur_size_>, else returns false.
   bool in_range (size_t index) const;
 
+  // Move the live elements into a new buffer of <new_capacity>
+  // elements, which must be >= <cur_size_>.  Elements are moved if
+  // that can't throw and copied otherwise, so a failure leaves the
+  // array unchanged.  If <zeroed>, the rest of the new buffer is all
+  // zero bytes.
+  void reallocate (size_t new_capacity, bool zeroed = false);
+
+  // Returns true if <value> can be applied by zeroing storage, i.e., T
+  // is trivial and <value> is all zero bytes.
+  static bool is_zero (const T &value);
+
+  // Build a new item at location <index> >= <cur_size_> from <args>,
+  // initializing the elements in between as <resize> does.
+  template <typename... ARGS>
+  T &construct_past_end (size_t index, ARGS &&... args);
+
+  // Copy <n> elements read from the forward iterator <first> to the
+  // elements starting at <offset>, growing the array if needed.
+  template <typename ITER>
+  void write_range (size_t offset, ITER first, size_t n);
+
+  // Returns true if the <n> elements at <first> are stored in our own
+  // buffer, so they'd go away if it were reallocated.
+  template <typename ITER>
+  bool aliases (ITER first, size_t n) const;
+
   // Maximum size of the array, i.e., the total number of <T> elements
   // in <array_>.
   size_t max_size_;
@@ -126,40 +409,58 @@ private:
   // don't have to in the set() method. 
   size_t cur_size_;
 
-  // If a default value is needed, keep track of its value.
-  std::unique_ptr<T> default_value_;
+  // If a default value is needed, keep track of its value.  It is
+  // stored inline so that it doesn't cost an extra allocation.
+  std::optional<T> default_value_;
 
-  // @@ Replace unique_ptr with auto_ptr if your compiler doesn't support C++11.
-  // std::auto_ptr<T> default_value_;
+  // Decides the new <max_size_> whenever the array must grow.
+  Array_Growth_Policy growth_;
 
-  // Pointer to the array's storage buffer.
-  scoped_array<T> array_;
+  // Pointer to the array's storage buffer.  Only the first
+  // <cur_size_> elements are constructed; the rest is raw storage.
+  scoped_array<T, ALLOC> array_;
 };
 
 /**
  * @class Array_Iterator
- * @brief Implements a bidirectional iterator for array type classes.
+ * @brief Implements a contiguous random access iterator for array
+ *        type classes.
  *
- * Note:  Having a const Iterator does not guarantee that the current
- * *position* that it points to will not change, it only guarantees that
- * you cannot change the underlying array!
+ * The iterator is a thin wrapper around a pointer into the array's
+ * buffer, so standard algorithms (std::sort, std::copy, std::distance,
+ * ...) get their random access and contiguous specializations.  Like a
+ * pointer, it is invalidated when the array reallocates.
  */
 template <typename T>
 class Array_Iterator 
 {
-  friend class Array<T>;
+public:
+  // = Necessary traits
+  typedef std::random_access_iterator_tag iterator_category;
+#if defined (__cpp_lib_concepts)
+  typedef std::contiguous_iterator_tag iterator_concept;
+#endif /* __cpp_lib_concepts */
+  typedef T value_type;
+  typedef T element_type;
+  typedef T *pointer;
+  typedef T &reference;
+  typedef std::ptrdiff_t difference_type;
 
-private:
-  /// Construct an Array_Iterator at position pos.  
-  Array_Iterator (Array<T> &array, size_t pos = 0);
+  /// Construct a singular iterator.
+  Array_Iterator (void);
+
+  /// Construct an Array_Iterator that points to <ptr>.
+  explicit Array_Iterator (T *ptr);
 
-public:
   /// Dereference operator returns a reference to the item contained
   /// at the current position
-  T& operator* (void);
+  T &operator* (void) const;
 
-  /// Returns a const reference to the item contained at the current position
-  const T& operator* (void) const;
+  /// Returns a pointer to the item contained at the current position
+  T *operator-> (void) const;
+
+  /// Returns a reference to the item <n> positions away
+  T &operator[] (difference_type n) const;
 
   /// Preincrement operator
   Array_Iterator<T> &operator++ (void);
@@ -173,32 +474,52 @@ public:
   /// Posdecrement operator
   Array_Iterator<T> operator-- (int);
 
+  /// Advance by <n> positions
+  Array_Iterator<T> &operator+= (difference_type n);
+
+  /// Retreat by <n> positions
+  Array_Iterator<T> &operator-= (difference_type n);
+
+  /// Returns an iterator <n> positions ahead
+  Array_Iterator<T> operator+ (difference_type n) const;
+
+  /// Returns an iterator <n> positions behind
+  Array_Iterator<T> operator- (difference_type n) const;
+
+  /// Returns the distance between <rhs> and this iterator
+  difference_type operator- (const Array_Iterator<T> &rhs) const;
+
   /// Equality operator
   bool operator== (const Array_Iterator<T> &rhs) const;
 
   /// Nonequality operator
-  bool operator!= (const Array_Iterator<T> &lhs) const;
+  bool operator!= (const Array_Iterator<T> &rhs) const;
 
-  // = Necessary traits
-  typedef std::bidirectional_iterator_tag iterator_category;
-  typedef T value_type;
-  typedef T *pointer;
-  typedef T &reference;
-  typedef int difference_type;
+  /// Ordering operators
+  bool operator< (const Array_Iterator<T> &rhs) const;
+  bool operator> (const Array_Iterator<T> &rhs) const;
+  bool operator<= (const Array_Iterator<T> &rhs) const;
+  bool operator>= (const Array_Iterator<T> &rhs) const;
 
-private:
-  /// the array we are dealing with
-  Array<T> &array_;
+  /// Returns the underlying pointer
+  T *base (void) const;
 
+private:
   /// Our current position
-  mutable size_t pos_;
+  T *ptr_;
 };
 
+/// Returns an iterator <n> positions ahead of <i>
+template <typename T>
+Array_Iterator<T> operator+ (typename Array_Iterator<T>::difference_type n,
+                             const Array_Iterator<T> &i);
+
 /**
  * @class Const_Array_Iterator
- * @brief Implements a bidirectional iterator for array type classes.
+ * @brief Implements a contiguous random access iterator for const
+ *        array type classes.
  *
- * Note:  Having a const Iterator does not gaurantee that the current
+ * Note:  Having a const Iterator does not guarantee that the current
  * *position* that it points to will not change, it only guarantees that
  * you cannot change the underlying array!
  */
@@ -206,48 +527,87 @@ template <typename T>
 class Const_Array_Iterator
 {
 public:
-  friend class Array<T>;
+  // = Necessary traits
+  typedef std::random_access_iterator_tag iterator_category;
+#if defined (__cpp_lib_concepts)
+  typedef std::contiguous_iterator_tag iterator_concept;
+#endif /* __cpp_lib_concepts */
+  typedef T value_type;
+  typedef const T element_type;
+  typedef const T *pointer;
+  typedef const T &reference;
+  typedef std::ptrdiff_t difference_type;
 
-public:
-  /// Construct an iterator at position pos.
-  Const_Array_Iterator (const Array<T> &array, size_t pos = 0);
+  /// Construct a singular iterator.
+  Const_Array_Iterator (void);
+
+  /// Construct an iterator that points to <ptr>.
+  explicit Const_Array_Iterator (const T *ptr);
+
+  /// Convert from a non-const iterator.
+  Const_Array_Iterator (const Array_Iterator<T> &i);
 
   /// Returns a const reference to the item contained at the current position.
-  const T& operator* (void) const;
+  const T &operator* (void) const;
+
+  /// Returns a const pointer to the item contained at the current position.
+  const T *operator-> (void) const;
+
+  /// Returns a const reference to the item <n> positions away
+  const T &operator[] (difference_type n) const;
 
   /// Preincrement operator
-  const Const_Array_Iterator<T> &operator++ (void) const;
+  Const_Array_Iterator<T> &operator++ (void);
 
   /// Postincrement operator
-  Const_Array_Iterator<T> operator++ (int) const;
+  Const_Array_Iterator<T> operator++ (int);
 
   /// Predecrement operator
-  const Const_Array_Iterator &operator-- (void) const; 
+  Const_Array_Iterator<T> &operator-- (void); 
 
   /// Postdecrement operator
-  Const_Array_Iterator<T> operator-- (int) const;
+  Const_Array_Iterator<T> operator-- (int);
+
+  /// Advance by <n> positions
+  Const_Array_Iterator<T> &operator+= (difference_type n);
+
+  /// Retreat by <n> positions
+  Const_Array_Iterator<T> &operator-= (difference_type n);
+
+  /// Returns an iterator <n> positions ahead
+  Const_Array_Iterator<T> operator+ (difference_type n) const;
+
+  /// Returns an iterator <n> positions behind
+  Const_Array_Iterator<T> operator- (difference_type n) const;
+
+  /// Returns the distance between <rhs> and this iterator
+  difference_type operator- (const Const_Array_Iterator<T> &rhs) const;
 
   /// Equality operator
   bool operator== (const Const_Array_Iterator<T> &rhs) const;
 
   /// Nonequality operator
-  bool operator!= (const Const_Array_Iterator<T> &lhs) const;
+  bool operator!= (const Const_Array_Iterator<T> &rhs) const;
 
-  // = Necessary traits
-  typedef std::bidirectional_iterator_tag iterator_category;
-  typedef T value_type;
-  typedef T *pointer;
-  typedef T &reference;
-  typedef int difference_type;
+  /// Ordering operators
+  bool operator< (const Const_Array_Iterator<T> &rhs) const;
+  bool operator> (const Const_Array_Iterator<T> &rhs) const;
+  bool operator<= (const Const_Array_Iterator<T> &rhs) const;
+  bool operator>= (const Const_Array_Iterator<T> &rhs) const;
 
-private:
-  /// the array we are dealing with
-  const Array<T> &array_;
+  /// Returns the underlying pointer
+  const T *base (void) const;
 
+private:
   /// Our current position
-  mutable size_t pos_;
+  const T *ptr_;
 };
 
+/// Returns an iterator <n> positions ahead of <i>
+template <typename T>
+Const_Array_Iterator<T> operator+ (typename Const_Array_Iterator<T>::difference_type n,
+                                   const Const_Array_Iterator<T> &i);
+
 #if defined (__INLINE__)
 #define INLINE inline
 #include "Array.inl"
@@ -1,76 +1,164 @@
 
 // Returns the current size of the array.
 
-template <typename T> INLINE size_t 
-Array<T>::size (void) const
+template <typename T, typename ALLOC> INLINE size_t 
+Array<T, ALLOC>::size (void) const
 {
 	return cur_size_;
 }
 
-template <typename T> INLINE bool
-Array<T>::in_range (size_t index) const
+// Returns the number of elements the array can hold without
+// reallocating.
+
+template <typename T, typename ALLOC> INLINE size_t 
+Array<T, ALLOC>::capacity (void) const
+{
+	return max_size_;
+}
+
+template <typename T, typename ALLOC> INLINE ALLOC
+Array<T, ALLOC>::get_allocator (void) const
+{
+	return array_.get_allocator();
+}
+
+template <typename T, typename ALLOC> INLINE const Array_Growth_Policy &
+Array<T, ALLOC>::growth_policy (void) const
+{
+	return growth_;
+}
+
+template <typename T, typename ALLOC> INLINE const std::optional<T> &
+Array<T, ALLOC>::default_value (void) const
+{
+	return default_value_;
+}
+
+template <typename T, typename ALLOC> INLINE bool
+Array<T, ALLOC>::in_range (size_t index) const
 {
 	return index < cur_size_;
 }
 
-template <typename T> INLINE T &
-Array<T>::operator[] (size_t index)
+template <typename T, typename ALLOC> INLINE T &
+Array<T, ALLOC>::operator[] (size_t index)
+{
+	if (ARRAY_BOUNDS_CHECK && !in_range(index)) throw std::out_of_range("Value out of range");
+	return array_[index];
+}
+
+template <typename T, typename ALLOC> INLINE const T &
+Array<T, ALLOC>::operator[] (size_t index) const
+{
+	if (ARRAY_BOUNDS_CHECK && !in_range(index)) throw std::out_of_range("Value out of range");
+	return array_[index];
+}
+
+template <typename T, typename ALLOC> INLINE void
+Array<T, ALLOC>::assign (const T *src, size_t n)
+{
+	assign (src, src+n);
+}
+
+template <typename T, typename ALLOC> INLINE void
+Array<T, ALLOC>::append (const T *src, size_t n)
+{
+	append (src, src+n);
+}
+
+template <typename T, typename ALLOC> INLINE void
+Array<T, ALLOC>::set_range (size_t offset, const T *src, size_t n)
+{
+	set_range (offset, src, src+n);
+}
+
+template <typename T, typename ALLOC> INLINE T &
+Array<T, ALLOC>::at (size_t index)
 {
 	if (!in_range(index)) throw std::out_of_range("Value out of range");
 	return array_[index];
 }
 
-template <typename T> INLINE const T &
-Array<T>::operator[] (size_t index) const
+template <typename T, typename ALLOC> INLINE const T &
+Array<T, ALLOC>::at (size_t index) const
 {
 	if (!in_range(index)) throw std::out_of_range("Value out of range");
 	return array_[index];
 }
 
 // Get an iterator to the begniing of the array
-template <typename T> INLINE typename Array<T>::iterator
-Array<T>::begin (void)
+template <typename T, typename ALLOC> INLINE typename Array<T, ALLOC>::iterator
+Array<T, ALLOC>::begin (void)
 {
-	return iterator(*this,0);
+	return iterator(array_.get());
 }
 
 // Get an iterator pointing past the end of the array
-template <typename T> INLINE typename Array<T>::iterator
-Array<T>::end (void)
+template <typename T, typename ALLOC> INLINE typename Array<T, ALLOC>::iterator
+Array<T, ALLOC>::end (void)
 {
-	return iterator(*this,cur_size_);
+	return iterator(array_.get()+cur_size_);
 }
 
 // Get an iterator to the begniing of the array
-template <typename T> INLINE typename Array<T>::const_iterator
-Array<T>::begin (void) const
+template <typename T, typename ALLOC> INLINE typename Array<T, ALLOC>::const_iterator
+Array<T, ALLOC>::begin (void) const
 {
-	return const_iterator(*this,0);
+	return const_iterator(array_.get());
 }
 
 // Get an iterator pointing past the end of the array
-template <typename T> INLINE typename Array<T>::const_iterator
-Array<T>::end (void) const
+template <typename T, typename ALLOC> INLINE typename Array<T, ALLOC>::const_iterator
+Array<T, ALLOC>::end (void) const
 {
-	return const_iterator(*this,cur_size_);
+	return const_iterator(array_.get()+cur_size_);
 }
 
-template <typename T> INLINE T &
-Array_Iterator<T>::operator* (void)
+// Get a pointer to the array's storage
+template <typename T, typename ALLOC> INLINE T *
+Array<T, ALLOC>::data (void)
 {
-	return array_[pos_];
+	return array_.get();
 }
 
-template <typename T> INLINE const T &
+template <typename T, typename ALLOC> INLINE const T *
+Array<T, ALLOC>::data (void) const
+{
+	return array_.get();
+}
+
+template <typename T> INLINE
+Array_Iterator<T>::Array_Iterator (void) : ptr_ (0)
+{
+}
+
+template <typename T> INLINE
+Array_Iterator<T>::Array_Iterator (T *ptr) : ptr_ (ptr)
+{
+}
+
+template <typename T> INLINE T &
 Array_Iterator<T>::operator* (void) const
 {
-	return array_[pos_];
+	return *ptr_;
+}
+
+template <typename T> INLINE T *
+Array_Iterator<T>::operator-> (void) const
+{
+	return ptr_;
+}
+
+template <typename T> INLINE T &
+Array_Iterator<T>::operator[] (difference_type n) const
+{
+	return ptr_[n];
 }
 
 template <typename T> INLINE Array_Iterator<T> &
 Array_Iterator<T>::operator++ (void) 
 {
-	++pos_;
+	++ptr_;
 	return *this;
 }
 
@@ -78,14 +166,14 @@ template <typename T> INLINE Array_Iterator<T>
 Array_Iterator<T>::operator++ (int) 
 {
 	Array_Iterator<T> temp(*this);
-	++pos_;
+	++ptr_;
 	return temp;
 }
 
 template <typename T> INLINE Array_Iterator<T> &
 Array_Iterator<T>::operator-- (void)
 {
-	--pos_;
+	--ptr_;
 	return *this;
 }
 
@@ -93,69 +181,229 @@ template <typename T> INLINE Array_Iterator<T>
 Array_Iterator<T>::operator-- (int) 
 {
 	Array_Iterator<T> temp(*this);
-	--pos_;
+	--ptr_;
+	return temp;
+}
+
+template <typename T> INLINE Array_Iterator<T> &
+Array_Iterator<T>::operator+= (difference_type n)
+{
+	ptr_ += n;
+	return *this;
+}
+
+template <typename T> INLINE Array_Iterator<T> &
+Array_Iterator<T>::operator-= (difference_type n)
+{
+	ptr_ -= n;
 	return *this;
+}
 
+template <typename T> INLINE Array_Iterator<T>
+Array_Iterator<T>::operator+ (difference_type n) const
+{
+	return Array_Iterator<T> (ptr_ + n);
+}
+
+template <typename T> INLINE Array_Iterator<T>
+Array_Iterator<T>::operator- (difference_type n) const
+{
+	return Array_Iterator<T> (ptr_ - n);
+}
+
+template <typename T> INLINE typename Array_Iterator<T>::difference_type
+Array_Iterator<T>::operator- (const Array_Iterator<T> &rhs) const
+{
+	return ptr_ - rhs.ptr_;
+}
+
+template <typename T> INLINE Array_Iterator<T>
+operator+ (typename Array_Iterator<T>::difference_type n, const Array_Iterator<T> &i)
+{
+	return i + n;
 }
 
 template <typename T> INLINE bool
 Array_Iterator<T>::operator== (const Array_Iterator<T> &rhs) const
 {
-	return pos_ == rhs.pos_;
+	return ptr_ == rhs.ptr_;
 }
 
 template <typename T> INLINE bool
 Array_Iterator<T>::operator!= (const Array_Iterator<T> &rhs) const
 {
-	return pos_ != rhs.pos_ ;
+	return ptr_ != rhs.ptr_;
+}
+
+template <typename T> INLINE bool
+Array_Iterator<T>::operator< (const Array_Iterator<T> &rhs) const
+{
+	return ptr_ < rhs.ptr_;
+}
+
+template <typename T> INLINE bool
+Array_Iterator<T>::operator> (const Array_Iterator<T> &rhs) const
+{
+	return ptr_ > rhs.ptr_;
+}
+
+template <typename T> INLINE bool
+Array_Iterator<T>::operator<= (const Array_Iterator<T> &rhs) const
+{
+	return ptr_ <= rhs.ptr_;
+}
+
+template <typename T> INLINE bool
+Array_Iterator<T>::operator>= (const Array_Iterator<T> &rhs) const
+{
+	return ptr_ >= rhs.ptr_;
+}
+
+template <typename T> INLINE T *
+Array_Iterator<T>::base (void) const
+{
+	return ptr_;
+}
+
+template <typename T> INLINE
+Const_Array_Iterator<T>::Const_Array_Iterator (void) : ptr_ (0)
+{
+}
+
+template <typename T> INLINE
+Const_Array_Iterator<T>::Const_Array_Iterator (const T *ptr) : ptr_ (ptr)
+{
+}
+
+template <typename T> INLINE
+Const_Array_Iterator<T>::Const_Array_Iterator (const Array_Iterator<T> &i) : ptr_ (i.base ())
+{
 }
 
 template <typename T> INLINE const T &
 Const_Array_Iterator<T>::operator* (void) const
 {
-	return array_[pos_];
+	return *ptr_;
 }
 
-template <typename T> INLINE const Const_Array_Iterator<T> &
-Const_Array_Iterator<T>::operator++ (void) const
+template <typename T> INLINE const T *
+Const_Array_Iterator<T>::operator-> (void) const
 {
-	++pos_;
+	return ptr_;
+}
+
+template <typename T> INLINE const T &
+Const_Array_Iterator<T>::operator[] (difference_type n) const
+{
+	return ptr_[n];
+}
+
+template <typename T> INLINE Const_Array_Iterator<T> &
+Const_Array_Iterator<T>::operator++ (void) 
+{
+	++ptr_;
 	return *this;
 }
 
 template <typename T> INLINE Const_Array_Iterator<T> 
-Const_Array_Iterator<T>::operator++ (int) const
+Const_Array_Iterator<T>::operator++ (int) 
 {
 	Const_Array_Iterator<T> temp(*this);
-	++pos_;
+	++ptr_;
 	return temp;
 }
 
-template <typename T> INLINE const Const_Array_Iterator<T> &
-Const_Array_Iterator<T>::operator-- (void) const
+template <typename T> INLINE Const_Array_Iterator<T> &
+Const_Array_Iterator<T>::operator-- (void)
 {
-	--pos_;
+	--ptr_;
 	return *this;
-
 }
 
 template <typename T> INLINE Const_Array_Iterator<T>
-Const_Array_Iterator<T>::operator-- (int) const
+Const_Array_Iterator<T>::operator-- (int) 
 {
 	Const_Array_Iterator<T> temp(*this);
-	--pos_;
+	--ptr_;
 	return temp;
 }
 
+template <typename T> INLINE Const_Array_Iterator<T> &
+Const_Array_Iterator<T>::operator+= (difference_type n)
+{
+	ptr_ += n;
+	return *this;
+}
+
+template <typename T> INLINE Const_Array_Iterator<T> &
+Const_Array_Iterator<T>::operator-= (difference_type n)
+{
+	ptr_ -= n;
+	return *this;
+}
+
+template <typename T> INLINE Const_Array_Iterator<T>
+Const_Array_Iterator<T>::operator+ (difference_type n) const
+{
+	return Const_Array_Iterator<T> (ptr_ + n);
+}
+
+template <typename T> INLINE Const_Array_Iterator<T>
+Const_Array_Iterator<T>::operator- (difference_type n) const
+{
+	return Const_Array_Iterator<T> (ptr_ - n);
+}
+
+template <typename T> INLINE typename Const_Array_Iterator<T>::difference_type
+Const_Array_Iterator<T>::operator- (const Const_Array_Iterator<T> &rhs) const
+{
+	return ptr_ - rhs.ptr_;
+}
+
+template <typename T> INLINE Const_Array_Iterator<T>
+operator+ (typename Const_Array_Iterator<T>::difference_type n, const Const_Array_Iterator<T> &i)
+{
+	return i + n;
+}
+
 template <typename T> INLINE bool
 Const_Array_Iterator<T>::operator== (const Const_Array_Iterator<T> &rhs) const
 {
-	return pos_ == rhs.pos_;
+	return ptr_ == rhs.ptr_;
 }
 
 template <typename T> INLINE bool
 Const_Array_Iterator<T>::operator!= (const Const_Array_Iterator<T> &rhs) const
 {
-	return pos_ != rhs.pos_ && &array_ == &rhs.array_ ;
+	return ptr_ != rhs.ptr_;
+}
+
+template <typename T> INLINE bool
+Const_Array_Iterator<T>::operator< (const Const_Array_Iterator<T> &rhs) const
+{
+	return ptr_ < rhs.ptr_;
 }
 
+template <typename T> INLINE bool
+Const_Array_Iterator<T>::operator> (const Const_Array_Iterator<T> &rhs) const
+{
+	return ptr_ > rhs.ptr_;
+}
+
+template <typename T> INLINE bool
+Const_Array_Iterator<T>::operator<= (const Const_Array_Iterator<T> &rhs) const
+{
+	return ptr_ <= rhs.ptr_;
+}
+
+template <typename T> INLINE bool
+Const_Array_Iterator<T>::operator>= (const Const_Array_Iterator<T> &rhs) const
+{
+	return ptr_ >= rhs.ptr_;
+}
+
+template <typename T> INLINE const T *
+Const_Array_Iterator<T>::base (void) const
+{
+	return ptr_;
+}
@@ -0,0 +1,488 @@
+/* -*- C++ -*- */
+
+#ifndef ARRAY_SOA_H
+#define ARRAY_SOA_H
+
+#include <stdlib.h>
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include "Array.h"
+
+/**
+ * @class ArraySoA
+ * @brief Implements a vector of records with fields of types
+ *        <FIELDS...>, stored as a structure of arrays: one <Array>
+ *        column per field.
+ *
+ * A loop over one field only reads that field's column, so it uses
+ * every byte of each cache line it touches and can be vectorized (see
+ * <column> and <column_data>).  All the columns always have the same
+ * size; they are resized together.  Whole records are accessed
+ * through proxy references, e.g.
+ *
+ *   ArraySoA<int, double> a (10);
+ *   a.set (std::make_tuple (1, 2.5), 0);
+ *   a[0].get<1> () += 1.0;
+ *   double sum = Array_SIMD::sum (a.column<1> ());
+ *
+ * so iterators are random access, but their reference type is a proxy
+ * rather than a real reference.
+ */
+template <typename... FIELDS>
+class ArraySoA
+{
+  static_assert (sizeof... (FIELDS) > 0, "ArraySoA needs at least one field");
+
+public:
+  // Define a "trait"
+  typedef std::tuple<FIELDS...> value_type;
+
+  // The type of field <I>.
+  template <size_t I>
+  using field_type = typename std::tuple_element<I, value_type>::type;
+
+  // The type of the column holding field <I>.
+  template <size_t I>
+  using column_type = Array<field_type<I> >;
+
+  /**
+   * @class Reference
+   * @brief Proxy for one record of a non-const ArraySoA.
+   */
+  class Reference
+  {
+  public:
+    explicit Reference (std::tuple<FIELDS &...> fields) : fields_ (fields) {}
+
+    // Field <I> of the record.
+    template <size_t I>
+    field_type<I> &get (void) const { return std::get<I> (fields_); }
+
+    // Copy the fields of <value> into the record.
+    const Reference &operator= (const value_type &value) const
+    {
+      assign (value, std::index_sequence_for<FIELDS...> ());
+      return *this;
+    }
+
+    // Copy the fields of another record (not the proxy itself).
+    const Reference &operator= (const Reference &rhs) const
+    {
+      assign (value_type (rhs), std::index_sequence_for<FIELDS...> ());
+      return *this;
+    }
+
+    // Returns a copy of the record.
+    operator value_type (void) const { return value_type (fields_); }
+
+  private:
+    template <size_t... I>
+    void assign (const value_type &value, std::index_sequence<I...>) const
+    {
+      ((std::get<I> (fields_) = std::get<I> (value)), ...);
+    }
+
+    std::tuple<FIELDS &...> fields_;
+  };
+
+  /**
+   * @class Const_Reference
+   * @brief Proxy for one record of a const ArraySoA.
+   */
+  class Const_Reference
+  {
+  public:
+    explicit Const_Reference (std::tuple<const FIELDS &...> fields) : fields_ (fields) {}
+
+    Const_Reference (const Reference &r)
+      : fields_ (apply_refs (r, std::index_sequence_for<FIELDS...> ())) {}
+
+    template <size_t I>
+    const field_type<I> &get (void) const { return std::get<I> (fields_); }
+
+    operator value_type (void) const { return value_type (fields_); }
+
+  private:
+    template <size_t... I>
+    static std::tuple<const FIELDS &...> apply_refs (const Reference &r, std::index_sequence<I...>)
+    {
+      return std::tuple<const FIELDS &...> (r.template get<I> ()...);
+    }
+
+    std::tuple<const FIELDS &...> fields_;
+  };
+
+  /**
+   * @class Basic_Iterator
+   * @brief Random access iterator over the records of an ArraySoA, by
+   *        position.  <SOA> is ArraySoA or const ArraySoA.
+   */
+  template <typename SOA, typename REFERENCE>
+  class Basic_Iterator
+  {
+  public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef typename ArraySoA::value_type value_type;
+    typedef ptrdiff_t difference_type;
+    typedef void pointer;
+    typedef REFERENCE reference;
+
+    Basic_Iterator (void) : soa_ (0), pos_ (0) {}
+
+    Basic_Iterator (SOA &soa, size_t pos) : soa_ (&soa), pos_ (pos) {}
+
+    // A non-const iterator converts to a const one.
+    template <typename S, typename R>
+    Basic_Iterator (const Basic_Iterator<S, R> &i) : soa_ (i.soa_), pos_ (i.pos_) {}
+
+    reference operator* (void) const { return (*soa_)[pos_]; }
+    reference operator[] (difference_type n) const { return (*soa_)[pos_ + n]; }
+
+    Basic_Iterator &operator++ (void) { ++pos_; return *this; }
+    Basic_Iterator operator++ (int) { Basic_Iterator old (*this); ++pos_; return old; }
+    Basic_Iterator &operator-- (void) { --pos_; return *this; }
+    Basic_Iterator operator-- (int) { Basic_Iterator old (*this); --pos_; return old; }
+
+    Basic_Iterator &operator+= (difference_type n) { pos_ += n; return *this; }
+    Basic_Iterator &operator-= (difference_type n) { pos_ -= n; return *this; }
+    Basic_Iterator operator+ (difference_type n) const { return Basic_Iterator (*soa_, pos_ + n); }
+    Basic_Iterator operator- (difference_type n) const { return Basic_Iterator (*soa_, pos_ - n); }
+    friend Basic_Iterator operator+ (difference_type n, const Basic_Iterator &i) { return i + n; }
+
+    difference_type operator- (const Basic_Iterator &rhs) const
+    {
+      return difference_type (pos_) - difference_type (rhs.pos_);
+    }
+
+    bool operator== (const Basic_Iterator &rhs) const { return pos_ == rhs.pos_ && soa_ == rhs.soa_; }
+    bool operator!= (const Basic_Iterator &rhs) const { return !(*this == rhs); }
+    bool operator< (const Basic_Iterator &rhs) const { return pos_ < rhs.pos_; }
+    bool operator> (const Basic_Iterator &rhs) const { return pos_ > rhs.pos_; }
+    bool operator<= (const Basic_Iterator &rhs) const { return pos_ <= rhs.pos_; }
+    bool operator>= (const Basic_Iterator &rhs) const { return pos_ >= rhs.pos_; }
+
+    // Returns the index of the record the iterator points to.
+    size_t index (void) const { return pos_; }
+
+  private:
+    template <typename S, typename R> friend class Basic_Iterator;
+
+    SOA *soa_;
+    size_t pos_;
+  };
+
+  typedef Basic_Iterator<ArraySoA, Reference> iterator;
+  typedef Basic_Iterator<const ArraySoA, Const_Reference> const_iterator;
+
+  // = Initialization and termination methods.
+
+  // Create <size> records whose fields are default-initialized.  Each
+  // column grows according to <growth>.  Throws <std::bad_alloc> if
+  // allocation fails.
+  explicit ArraySoA (size_t size,
+                     const Array_Growth_Policy &growth = Array_Growth_Policy ());
+
+  // Create <size> copies of <default_value>, which also initializes
+  // the records added by <resize>.
+  ArraySoA (size_t size,
+            const value_type &default_value,
+            const Array_Growth_Policy &growth = Array_Growth_Policy ());
+
+  // = Iterators.
+  iterator begin (void);
+  const_iterator begin (void) const;
+  iterator end (void);
+  const_iterator end (void) const;
+
+  // = Per-column access.
+
+  // Returns the column of field <I>, e.g., to pass to Array_SIMD.  The
+  // columns can't be resized on their own.
+  template <size_t I>
+  const column_type<I> &column (void) const;
+
+  // Returns a pointer to the contiguous values of field <I>, one per
+  // record.
+  template <size_t I>
+  field_type<I> *column_data (void);
+
+  template <size_t I>
+  const field_type<I> *column_data (void) const;
+
+  // = Set/get methods.
+
+  // Set the record at location index to <new_item>, resizing all the
+  // columns if <index> >= size().  Throws <std::bad_alloc> if resizing
+  // fails.
+  void set (const value_type &new_item, size_t index);
+
+  // Copy the record at location index into <item>.  Throws
+  // <std::out_of_range> if index is not <in_range>.
+  void get (value_type &item, size_t index) const;
+
+  // Append <new_item> as a new last record.
+  void append (const value_type &new_item);
+
+  // Returns the number of records.
+  size_t size (void) const;
+
+  // Returns how many records fit before a column has to reallocate.
+  size_t capacity (void) const;
+
+  // Proxy for the record at <index>, checked only if
+  // ARRAY_BOUNDS_CHECK is enabled.
+  Reference operator[] (size_t index);
+  Const_Reference operator[] (size_t index) const;
+
+  // Proxy for the record at <index>.  Always throws
+  // <std::out_of_range> if <index> is not <in_range>.
+  Reference at (size_t index);
+  Const_Reference at (size_t index) const;
+
+  // Compare this array with <s> for (in)equality, column by column.
+  bool operator== (const ArraySoA<FIELDS...> &s) const;
+  bool operator!= (const ArraySoA<FIELDS...> &s) const;
+
+  // Resize all the columns to <new_size> records.  If one of them
+  // can't grow, the ones that did are shrunk back and
+  // <std::bad_alloc> is thrown.
+  void resize (size_t new_size);
+
+  // Make sure every column can hold <new_capacity> records without
+  // reallocating.
+  void reserve (size_t new_capacity);
+
+  // Release any capacity beyond size() in every column.
+  void shrink_to_fit (void);
+
+  // Swap the contents of this array with <new_array>.  Does not throw.
+  void swap (ArraySoA<FIELDS...> &new_array);
+
+private:
+  typedef std::index_sequence_for<FIELDS...> INDICES;
+
+  // Returns true if <index> is within range.
+  bool in_range (size_t index) const;
+
+  template <size_t... I>
+  Reference reference (size_t index, std::index_sequence<I...>);
+
+  template <size_t... I>
+  Const_Reference reference (size_t index, std::index_sequence<I...>) const;
+
+  template <size_t... I>
+  void set_fields (const value_type &new_item, size_t index, std::index_sequence<I...>);
+
+  template <size_t... I>
+  void swap_columns (ArraySoA<FIELDS...> &s, std::index_sequence<I...>);
+
+  // One Array per field.
+  std::tuple<Array<FIELDS>...> columns_;
+};
+
+template <typename... FIELDS>
+ArraySoA<FIELDS...>::ArraySoA (size_t size,
+			       const Array_Growth_Policy &growth) : columns_ (Array<FIELDS> (size, growth)...)
+{
+}
+
+template <typename... FIELDS>
+ArraySoA<FIELDS...>::ArraySoA (size_t size,
+			       const value_type &default_value,
+			       const Array_Growth_Policy &growth)
+  : columns_ (std::apply ([size, &growth] (const FIELDS &... d) {
+			return std::tuple<Array<FIELDS>...> (Array<FIELDS> (size, d, growth)...);
+		}, default_value))
+{
+}
+
+template <typename... FIELDS> typename ArraySoA<FIELDS...>::iterator
+ArraySoA<FIELDS...>::begin (void)
+{
+	return iterator (*this, 0);
+}
+
+template <typename... FIELDS> typename ArraySoA<FIELDS...>::const_iterator
+ArraySoA<FIELDS...>::begin (void) const
+{
+	return const_iterator (*this, 0);
+}
+
+template <typename... FIELDS> typename ArraySoA<FIELDS...>::iterator
+ArraySoA<FIELDS...>::end (void)
+{
+	return iterator (*this, size ());
+}
+
+template <typename... FIELDS> typename ArraySoA<FIELDS...>::const_iterator
+ArraySoA<FIELDS...>::end (void) const
+{
+	return const_iterator (*this, size ());
+}
+
+template <typename... FIELDS> template <size_t I> const typename ArraySoA<FIELDS...>::template column_type<I> &
+ArraySoA<FIELDS...>::column (void) const
+{
+	return std::get<I> (columns_);
+}
+
+template <typename... FIELDS> template <size_t I> typename ArraySoA<FIELDS...>::template field_type<I> *
+ArraySoA<FIELDS...>::column_data (void)
+{
+	return std::get<I> (columns_).data ();
+}
+
+template <typename... FIELDS> template <size_t I> const typename ArraySoA<FIELDS...>::template field_type<I> *
+ArraySoA<FIELDS...>::column_data (void) const
+{
+	return std::get<I> (columns_).data ();
+}
+
+template <typename... FIELDS> bool
+ArraySoA<FIELDS...>::in_range (size_t index) const
+{
+	return index < size ();
+}
+
+template <typename... FIELDS> template <size_t... I> typename ArraySoA<FIELDS...>::Reference
+ArraySoA<FIELDS...>::reference (size_t index, std::index_sequence<I...>)
+{
+	return Reference (std::tuple<FIELDS &...> (std::get<I> (columns_).data ()[index]...));
+}
+
+template <typename... FIELDS> template <size_t... I> typename ArraySoA<FIELDS...>::Const_Reference
+ArraySoA<FIELDS...>::reference (size_t index, std::index_sequence<I...>) const
+{
+	return Const_Reference (std::tuple<const FIELDS &...> (std::get<I> (columns_).data ()[index]...));
+}
+
+template <typename... FIELDS> typename ArraySoA<FIELDS...>::Reference
+ArraySoA<FIELDS...>::operator[] (size_t index)
+{
+	if (ARRAY_BOUNDS_CHECK && !in_range(index)) throw std::out_of_range("Value out of range");
+	return reference (index, INDICES ());
+}
+
+template <typename... FIELDS> typename ArraySoA<FIELDS...>::Const_Reference
+ArraySoA<FIELDS...>::operator[] (size_t index) const
+{
+	if (ARRAY_BOUNDS_CHECK && !in_range(index)) throw std::out_of_range("Value out of range");
+	return reference (index, INDICES ());
+}
+
+template <typename... FIELDS> typename ArraySoA<FIELDS...>::Reference
+ArraySoA<FIELDS...>::at (size_t index)
+{
+	if (!in_range(index)) throw std::out_of_range("Value out of range");
+	return reference (index, INDICES ());
+}
+
+template <typename... FIELDS> typename ArraySoA<FIELDS...>::Const_Reference
+ArraySoA<FIELDS...>::at (size_t index) const
+{
+	if (!in_range(index)) throw std::out_of_range("Value out of range");
+	return reference (index, INDICES ());
+}
+
+template <typename... FIELDS> template <size_t... I> void
+ArraySoA<FIELDS...>::set_fields (const value_type &new_item, size_t index, std::index_sequence<I...>)
+{
+	(std::get<I> (columns_).set (std::get<I> (new_item), index), ...);
+}
+
+template <typename... FIELDS> void
+ArraySoA<FIELDS...>::set (const value_type &new_item, size_t index)
+{
+	// Grow all the columns first, so a failure can't leave them with
+	// different sizes.  <new_item> may be one of our own records.
+	if (index >= size ()) {
+		value_type item (new_item);
+		resize (index+1);
+		set_fields (item, index, INDICES ());
+	}
+	else
+		set_fields (new_item, index, INDICES ());
+}
+
+template <typename... FIELDS> void
+ArraySoA<FIELDS...>::get (value_type &item, size_t index) const
+{
+	if (!in_range (index)) throw std::out_of_range("Index out of range");
+	item = (*this)[index];
+}
+
+template <typename... FIELDS> void
+ArraySoA<FIELDS...>::append (const value_type &new_item)
+{
+	set (new_item, size ());
+}
+
+template <typename... FIELDS> size_t
+ArraySoA<FIELDS...>::size (void) const
+{
+	return std::get<0> (columns_).size ();
+}
+
+template <typename... FIELDS> size_t
+ArraySoA<FIELDS...>::capacity (void) const
+{
+	return std::apply ([] (const Array<FIELDS> &... c) { return std::min ({ c.capacity ()... }); }, columns_);
+}
+
+template <typename... FIELDS> bool
+ArraySoA<FIELDS...>::operator== (const ArraySoA<FIELDS...> &s) const
+{
+	return columns_ == s.columns_;
+}
+
+template <typename... FIELDS> bool
+ArraySoA<FIELDS...>::operator!= (const ArraySoA<FIELDS...> &s) const
+{
+	return !(*this == s);
+}
+
+template <typename... FIELDS> void
+ArraySoA<FIELDS...>::resize (size_t new_size)
+{
+	const size_t old_size = size ();
+	try {
+		std::apply ([new_size] (Array<FIELDS> &... c) { (c.resize (new_size), ...); }, columns_);
+	}
+	catch (...) {
+		// Shrinking doesn't allocate, so this can't throw.
+		std::apply ([old_size] (Array<FIELDS> &... c) {
+				((c.size () > old_size ? c.resize (old_size) : void ()), ...);
+			}, columns_);
+		throw;
+	}
+}
+
+template <typename... FIELDS> void
+ArraySoA<FIELDS...>::reserve (size_t new_capacity)
+{
+	std::apply ([new_capacity] (Array<FIELDS> &... c) { (c.reserve (new_capacity), ...); }, columns_);
+}
+
+template <typename... FIELDS> void
+ArraySoA<FIELDS...>::shrink_to_fit (void)
+{
+	std::apply ([] (Array<FIELDS> &... c) { (c.shrink_to_fit (), ...); }, columns_);
+}
+
+template <typename... FIELDS> template <size_t... I> void
+ArraySoA<FIELDS...>::swap_columns (ArraySoA<FIELDS...> &s, std::index_sequence<I...>)
+{
+	(std::get<I> (columns_).swap (std::get<I> (s.columns_)), ...);
+}
+
+template <typename... FIELDS> void
+ArraySoA<FIELDS...>::swap (ArraySoA<FIELDS...> &new_array)
+{
+	swap_columns (new_array, INDICES ());
+}
+
+#endif /* ARRAY_SOA_H */
@@ -0,0 +1,90 @@
+/* -*- C++ -*- */
+
+#ifndef ARRAY_ALIGNED_ALLOCATOR_H
+#define ARRAY_ALIGNED_ALLOCATOR_H
+
+#include <stdlib.h>
+#include <new>
+#include "Array.h"
+
+// Alignments worth asking an <Array_Aligned_Allocator> for.
+struct Array_Alignment
+{
+  enum : size_t
+  {
+    CACHE_LINE = 64,        // no false sharing with neighboring data
+    PAGE = 4096,            // a buffer starts on its own page
+    HUGE_PAGE = 2u << 20    // a buffer can be backed by 2 MB pages
+  };
+};
+
+/**
+ * @class Array_Aligned_Allocator
+ * @brief A standard conforming allocator whose blocks start on an
+ *        <ALIGN>-byte boundary.
+ *
+ * Used as the <ALLOC> of an <Array> (see <Aligned_Array>), every
+ * buffer the array allocates, however it grows, is aligned, so SIMD
+ * loops may use aligned loads from data ().  With <PAD> each block is
+ * also rounded up to a whole number of cache lines, so a loop may read
+ * (but not rely on the contents of) the rest of the cache line holding
+ * the last element, and no other object shares that line.
+ */
+template <typename T, size_t ALIGN = Array_Alignment::CACHE_LINE, bool PAD = false>
+class Array_Aligned_Allocator
+{
+  static_assert (ALIGN != 0 && (ALIGN & (ALIGN - 1)) == 0,
+                 "Array_Aligned_Allocator alignment must be a power of two");
+  static_assert (ALIGN >= alignof (T),
+                 "Array_Aligned_Allocator alignment is weaker than the type's own");
+
+public:
+  typedef T value_type;
+
+  template <typename U>
+  struct rebind
+  {
+    typedef Array_Aligned_Allocator<U, ALIGN, PAD> other;
+  };
+
+  // Returns the alignment of the blocks.
+  static constexpr size_t alignment (void) { return ALIGN; }
+
+  Array_Aligned_Allocator (void) noexcept {}
+
+  template <typename U>
+  Array_Aligned_Allocator (const Array_Aligned_Allocator<U, ALIGN, PAD> &) noexcept {}
+
+  // Allocate room for <n> elements.  Throws <std::bad_alloc> if
+  // allocation fails.
+  T *allocate (size_t n)
+  {
+    return static_cast<T *> (::operator new (block_size (n), std::align_val_t (ALIGN)));
+  }
+
+  void deallocate (T *p, size_t n) noexcept
+  {
+    ::operator delete (p, block_size (n), std::align_val_t (ALIGN));
+  }
+
+  bool operator== (const Array_Aligned_Allocator &) const { return true; }
+  bool operator!= (const Array_Aligned_Allocator &) const { return false; }
+
+private:
+  // Returns the number of bytes to allocate for <n> elements.
+  static size_t block_size (size_t n)
+  {
+    const size_t line = Array_Alignment::CACHE_LINE;
+    if (n > (size_t (-1) - line) / sizeof (T))
+      throw std::bad_array_new_length ();
+    const size_t bytes = n * sizeof (T);
+    return PAD ? (bytes + line - 1) & ~(line - 1) : bytes;
+  }
+};
+
+// An <Array> whose buffer is aligned as above, e.g., an
+// Aligned_Array<float, Array_Alignment::PAGE, true>.
+template <typename T, size_t ALIGN = Array_Alignment::CACHE_LINE, bool PAD = false>
+using Aligned_Array = Array<T, Array_Aligned_Allocator<T, ALIGN, PAD> >;
+
+#endif /* ARRAY_ALIGNED_ALLOCATOR_H */
@@ -0,0 +1,239 @@
+/* -*- C++ -*- */
+
+#ifndef ARRAY_HUGE_PAGE_ALLOCATOR_H
+#define ARRAY_HUGE_PAGE_ALLOCATOR_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include "Array.h"
+
+/**
+ * @class Array_Huge_Pages
+ * @brief Allocates large blocks on 2 MB pages and counts how many it
+ *        got.
+ *
+ * Blocks of at least <HUGE_PAGE_SIZE> bytes are mapped with mmap(),
+ * rounded up to and aligned on 2 MB.  In TRANSPARENT mode the block is
+ * marked with madvise(MADV_HUGEPAGE), so the kernel backs it with
+ * transparent huge pages when it can.  In HUGETLB mode it is first
+ * mapped with MAP_HUGETLB from the reserved huge page pool
+ * (/proc/sys/vm/nr_hugepages), and only if that fails handled as in
+ * TRANSPARENT mode.  Smaller blocks come from the ordinary heap.
+ * Where huge pages aren't supported, large blocks are still mapped but
+ * nothing else happens.
+ */
+class Array_Huge_Pages
+{
+public:
+  enum Mode
+  {
+    TRANSPARENT,   // madvise(MADV_HUGEPAGE)
+    HUGETLB        // MAP_HUGETLB, falling back to TRANSPARENT
+  };
+
+  enum : size_t
+  {
+    HUGE_PAGE_SIZE = 2u << 20
+  };
+
+  // Counts of huge pages requested since the program started.
+  struct Stats
+  {
+    // 2 MB pages mapped with MAP_HUGETLB, which are always huge.
+    size_t hugetlb_pages;
+
+    // 2 MB pages marked for transparent huge pages, which the kernel
+    // may or may not have backed with one (see <backed_bytes>).
+    size_t transparent_pages;
+
+    // Blocks for which MAP_HUGETLB or madvise() failed.
+    size_t failures;
+  };
+
+  // Returns a snapshot of the counters.
+  static Stats stats (void)
+  {
+    Stats s;
+    s.hugetlb_pages = counters ().hugetlb_pages_.load (std::memory_order_relaxed);
+    s.transparent_pages = counters ().transparent_pages_.load (std::memory_order_relaxed);
+    s.failures = counters ().failures_.load (std::memory_order_relaxed);
+    return s;
+  }
+
+  // Returns how many bytes of the mapping that contains <p> are
+  // currently backed by huge pages, according to /proc/self/smaps.
+  // Returns 0 if that can't be told, e.g., on systems other than
+  // Linux.
+  static size_t backed_bytes (const void *p)
+  {
+    std::ifstream smaps ("/proc/self/smaps");
+    const uintptr_t addr = reinterpret_cast<uintptr_t> (p);
+    bool inside = false;
+    size_t bytes = 0;
+    std::string line;
+    while (std::getline (smaps, line))
+      {
+        uintptr_t start, end;
+        char dash;
+        std::istringstream in (line);
+        if (line.find (':') == std::string::npos || line.find ('-') < line.find (':'))
+          {
+            // A "start-end perms ..." line begins the next mapping.
+            if (inside)
+              break;
+            in >> std::hex >> start >> dash >> end;
+            inside = in && dash == '-' && start <= addr && addr < end;
+            continue;
+          }
+        std::string field;
+        size_t kb = 0;
+        in >> field >> kb;
+        if (inside && (field == "AnonHugePages:" || field == "Shared_Hugetlb:" || field == "Private_Hugetlb:"))
+          bytes += kb << 10;
+      }
+    return bytes;
+  }
+
+  // Allocate a block of <bytes> bytes in <mode>.  Throws
+  // <std::bad_alloc> if allocation fails.
+  static void *allocate (size_t bytes, Mode mode)
+  {
+    if (bytes < HUGE_PAGE_SIZE)
+      return ::operator new (bytes);
+    if (bytes > size_t (-1) - HUGE_PAGE_SIZE)
+      throw std::bad_alloc ();
+    const size_t length = round_up (bytes);
+
+#if defined (MAP_HUGETLB)
+    if (mode == HUGETLB)
+      {
+        void *p = ::mmap (0, length, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED)
+          {
+            counters ().hugetlb_pages_.fetch_add (length / HUGE_PAGE_SIZE, std::memory_order_relaxed);
+            return p;
+          }
+        counters ().failures_.fetch_add (1, std::memory_order_relaxed);
+      }
+#else
+    (void) mode;
+#endif /* MAP_HUGETLB */
+
+    // Over-allocate so a 2 MB aligned block fits, then unmap the
+    // ends, so each huge page can be backed by one.
+    void *p = ::mmap (0, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+      throw std::bad_alloc ();
+    char *raw = static_cast<char *> (p);
+    char *block = reinterpret_cast<char *> (round_up (reinterpret_cast<uintptr_t> (raw)));
+    if (block != raw)
+      ::munmap (raw, block - raw);
+    ::munmap (block + length, raw + HUGE_PAGE_SIZE - block);
+
+#if defined (MADV_HUGEPAGE)
+    if (::madvise (block, length, MADV_HUGEPAGE) == 0)
+      counters ().transparent_pages_.fetch_add (length / HUGE_PAGE_SIZE, std::memory_order_relaxed);
+    else
+#endif /* MADV_HUGEPAGE */
+      counters ().failures_.fetch_add (1, std::memory_order_relaxed);
+    return block;
+  }
+
+  // Release a block of <bytes> bytes returned by <allocate>.
+  static void deallocate (void *p, size_t bytes) noexcept
+  {
+    if (bytes < HUGE_PAGE_SIZE)
+      ::operator delete (p);
+    else
+      ::munmap (p, round_up (bytes));
+  }
+
+private:
+  struct Counters
+  {
+    std::atomic<size_t> hugetlb_pages_;
+    std::atomic<size_t> transparent_pages_;
+    std::atomic<size_t> failures_;
+  };
+
+  static Counters &counters (void)
+  {
+    static Counters c;
+    return c;
+  }
+
+  // Returns <n> rounded up to a whole number of huge pages.
+  static size_t round_up (size_t n)
+  {
+    return (n + HUGE_PAGE_SIZE - 1) & ~size_t (HUGE_PAGE_SIZE - 1);
+  }
+};
+
+/**
+ * @class Array_Huge_Page_Allocator
+ * @brief A standard conforming allocator that puts large blocks on
+ *        2 MB pages through <Array_Huge_Pages>.
+ *
+ * Opt in by using it as the <ALLOC> of an <Array>, e.g.,
+ * Array<uint64_t, Array_Huge_Page_Allocator<uint64_t> >.  Arrays under
+ * 2 MB allocate as usual.
+ */
+template <typename T, Array_Huge_Pages::Mode MODE = Array_Huge_Pages::TRANSPARENT>
+class Array_Huge_Page_Allocator
+{
+  static_assert (alignof (T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+                 "Array_Huge_Page_Allocator doesn't support over-aligned types");
+
+public:
+  typedef T value_type;
+
+  template <typename U>
+  struct rebind
+  {
+    typedef Array_Huge_Page_Allocator<U, MODE> other;
+  };
+
+  Array_Huge_Page_Allocator (void) noexcept {}
+
+  template <typename U>
+  Array_Huge_Page_Allocator (const Array_Huge_Page_Allocator<U, MODE> &) noexcept {}
+
+  // Allocate room for <n> elements.  Throws <std::bad_alloc> if
+  // allocation fails.
+  T *allocate (size_t n)
+  {
+    if (n > size_t (-1) / sizeof (T))
+      throw std::bad_array_new_length ();
+    return static_cast<T *> (Array_Huge_Pages::allocate (n * sizeof (T), MODE));
+  }
+
+  // Same as above, but the storage is all zero bytes.  Huge blocks
+  // are fresh mappings, so their pages aren't touched.
+  T *allocate_zeroed (size_t n)
+  {
+    T *p = allocate (n);
+    if (n * sizeof (T) < Array_Huge_Pages::HUGE_PAGE_SIZE)
+      std::memset (static_cast<void *> (p), 0, n * sizeof (T));
+    return p;
+  }
+
+  void deallocate (T *p, size_t n) noexcept
+  {
+    Array_Huge_Pages::deallocate (p, n * sizeof (T));
+  }
+
+  bool operator== (const Array_Huge_Page_Allocator &) const { return true; }
+  bool operator!= (const Array_Huge_Page_Allocator &) const { return false; }
+};
+
+#endif /* ARRAY_HUGE_PAGE_ALLOCATOR_H */
@@ -0,0 +1,239 @@
+/* -*- C++ -*- */
+
+#ifndef ARRAY_OPS_H
+#define ARRAY_OPS_H
+
+#include <stdlib.h>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "Array_Parallel.h"
+
+/**
+ * @class Array_Bitwise_Iterator
+ * @brief True if iterators of type <ITER> refer to trivially copyable <T>s
+ * in contiguous memory, so that a range of them can be copied with
+ * memcpy/memmove.
+ */
+template <typename T, typename ITER, typename = void>
+struct Array_Bitwise_Iterator : std::false_type {};
+
+#if defined (__cpp_lib_concepts)
+template <typename T, typename ITER>
+struct Array_Bitwise_Iterator<T, ITER, typename std::enable_if<std::is_trivially_copyable<T>::value
+                                                               && std::contiguous_iterator<ITER> >::type>
+  : std::is_same<std::iter_value_t<ITER>, T> {};
+#else
+template <typename T, typename ITER>
+struct Array_Bitwise_Iterator<T, ITER, typename std::enable_if<std::is_trivially_copyable<T>::value
+                                                               && std::is_pointer<ITER>::value>::type>
+  : std::is_same<typename std::remove_cv<typename std::remove_pointer<ITER>::type>::type, T> {};
+#endif /* __cpp_lib_concepts */
+
+/**
+ * @class Array_Ops
+ * @brief Bulk operations on ranges of <T> shared by the array classes.
+ *
+ * The destination ranges are raw, uninitialized storage obtained from
+ * an allocator of type <ALLOC>.  Trivially copyable element types are
+ * handled with memcpy/memset, and types whose value is fully determined
+ * by their bytes are compared with memcmp.  All other types are
+ * constructed and destroyed one by one through the allocator (so, e.g.,
+ * std::pmr allocators propagate to the elements), and a range whose
+ * construction throws is destroyed again before the exception
+ * propagates.  The memcpy/memset paths split ranges larger than
+ * Array_Parallel_Policy::bulk_threshold () across the threads of
+ * <Array_Thread_Pool>.
+ */
+template <typename T, typename ALLOC = std::allocator<T> >
+class Array_Ops
+{
+public:
+  typedef std::allocator_traits<ALLOC> traits;
+
+  // Default-initialize the uninitialized range [<first>, <last>).
+  // Trivial types are left uninitialized.
+  static void default_construct (ALLOC &alloc, T *first, T *last);
+
+  // Copy-construct the elements [<first>, <last>) in the uninitialized
+  // storage at <dest>.
+  static void copy_construct (ALLOC &alloc, const T *first, const T *last, T *dest);
+
+  // Copy-construct <n> elements read from <first> in the uninitialized
+  // storage at <dest>.
+  template <typename ITER>
+  static void copy_construct_n (ALLOC &alloc, ITER first, size_t n, T *dest);
+
+  // Copy-assign <n> elements read from <first> to the live elements at
+  // <dest>.  Returns <first> advanced past the elements read.  The
+  // ranges may only overlap if T is trivially copyable.
+  template <typename ITER>
+  static ITER copy_assign_n (ITER first, size_t n, T *dest);
+
+  // Construct copies of <value> in the uninitialized range [<first>,
+  // <last>).
+  static void fill_construct (ALLOC &alloc, T *first, T *last, const T &value);
+
+  // Construct the elements [<first>, <last>) in the uninitialized
+  // storage at <dest>, moving them if that can't throw and copying
+  // them otherwise.  The source elements are left for the caller to
+  // destroy.
+  static void relocate (ALLOC &alloc, T *first, T *last, T *dest);
+
+  // Destroy the elements [<first>, <last>).
+  static void destroy (ALLOC &alloc, T *first, T *last);
+
+  // Returns true if the <n> elements at <lhs> and <rhs> are equal.
+  static bool elements_equal (const T *lhs, const T *rhs, size_t n);
+
+private:
+  // memcpy <n> elements from <src> to <dest>, which don't overlap.
+  static void copy_bytes (T *dest, const T *src, size_t n);
+
+  // Fill the <n> elements at <first> with the bytes of <value>.
+  static void fill_bytes (T *first, size_t n, const T &value);
+
+  // Construct an element at each position of [<dest>, <dest> + <n>)
+  // by calling <make> (alloc, position, index), destroying what was
+  // built so far if one of them throws.
+  template <typename MAKE>
+  static void construct_each (ALLOC &alloc, T *dest, size_t n, MAKE make);
+};
+
+template <typename T, typename ALLOC> template <typename MAKE> void
+Array_Ops<T, ALLOC>::construct_each (ALLOC &alloc, T *dest, size_t n, MAKE make)
+{
+	size_t i = 0;
+	try {
+		for (; i < n; ++i)
+			make (alloc, dest+i, i);
+	}
+	catch (...) {
+		destroy (alloc, dest, dest+i);
+		throw;
+	}
+}
+
+template <typename T, typename ALLOC> void
+Array_Ops<T, ALLOC>::default_construct (ALLOC &alloc, T *first, T *last)
+{
+	if constexpr (!std::is_trivially_default_constructible<T>::value)
+		construct_each (alloc, first, last-first,
+				[] (ALLOC &a, T *p, size_t) { traits::construct (a, p); });
+}
+
+template <typename T, typename ALLOC> void
+Array_Ops<T, ALLOC>::copy_construct (ALLOC &alloc, const T *first, const T *last, T *dest)
+{
+	if constexpr (std::is_trivially_copyable<T>::value) {
+		copy_bytes (dest, first, last-first);
+	}
+	else
+		construct_each (alloc, dest, last-first,
+				[first] (ALLOC &a, T *p, size_t i) { traits::construct (a, p, first[i]); });
+}
+
+template <typename T, typename ALLOC> template <typename ITER> void
+Array_Ops<T, ALLOC>::copy_construct_n (ALLOC &alloc, ITER first, size_t n, T *dest)
+{
+	if constexpr (Array_Bitwise_Iterator<T, ITER>::value) {
+		if (n != 0)
+			copy_bytes (dest, &*first, n);
+	}
+	else
+		construct_each (alloc, dest, n,
+				[&first] (ALLOC &a, T *p, size_t) { traits::construct (a, p, *first); ++first; });
+}
+
+template <typename T, typename ALLOC> template <typename ITER> ITER
+Array_Ops<T, ALLOC>::copy_assign_n (ITER first, size_t n, T *dest)
+{
+	if constexpr (Array_Bitwise_Iterator<T, ITER>::value) {
+		if (n != 0)
+			std::memmove (static_cast<void *> (dest), &*first, n*sizeof (T));
+		return first + n;
+	}
+	else {
+		for (size_t i = 0; i < n; ++i, ++first)
+			dest[i] = *first;
+		return first;
+	}
+}
+
+template <typename T, typename ALLOC> void
+Array_Ops<T, ALLOC>::fill_construct (ALLOC &alloc, T *first, T *last, const T &value)
+{
+	if constexpr (std::is_trivially_copyable<T>::value) {
+		// <value> may live in the range, so the threads use a copy.
+		const T item (value);
+		Array_Thread_Pool::for_each_bulk_range (last-first, sizeof (T),
+							[first, &item] (size_t begin, size_t end) {
+								fill_bytes (first+begin, end-begin, item);
+							});
+	}
+	else
+		construct_each (alloc, first, last-first,
+				[&value] (ALLOC &a, T *p, size_t) { traits::construct (a, p, value); });
+}
+
+template <typename T, typename ALLOC> void
+Array_Ops<T, ALLOC>::relocate (ALLOC &alloc, T *first, T *last, T *dest)
+{
+	if constexpr (std::is_trivially_copyable<T>::value)
+		copy_construct (alloc, first, last, dest);
+	else
+		construct_each (alloc, dest, last-first,
+				[first] (ALLOC &a, T *p, size_t i) { traits::construct (a, p, std::move_if_noexcept (first[i])); });
+}
+
+template <typename T, typename ALLOC> void
+Array_Ops<T, ALLOC>::destroy (ALLOC &alloc, T *first, T *last)
+{
+	if constexpr (!std::is_trivially_destructible<T>::value)
+		for (; first != last; ++first)
+			traits::destroy (alloc, first);
+}
+
+template <typename T, typename ALLOC> bool
+Array_Ops<T, ALLOC>::elements_equal (const T *lhs, const T *rhs, size_t n)
+{
+	if constexpr (std::has_unique_object_representations<T>::value)
+		return n == 0 || std::memcmp (lhs, rhs, n*sizeof (T)) == 0;
+	else
+		return std::equal (lhs, lhs+n, rhs);
+}
+
+template <typename T, typename ALLOC> void
+Array_Ops<T, ALLOC>::copy_bytes (T *dest, const T *src, size_t n)
+{
+	Array_Thread_Pool::for_each_bulk_range (n, sizeof (T),
+						[dest, src] (size_t begin, size_t end) {
+							std::memcpy (static_cast<void *> (dest+begin), src+begin, (end-begin)*sizeof (T));
+						});
+}
+
+template <typename T, typename ALLOC> void
+Array_Ops<T, ALLOC>::fill_bytes (T *first, size_t n, const T &value)
+{
+	// A value made of one repeated byte (e.g., any char, or 0) can be
+	// written with a single memset.
+	const unsigned char *bytes = reinterpret_cast<const unsigned char *> (&value);
+	if (std::all_of (bytes, bytes+sizeof (T),
+			 [bytes] (unsigned char b) { return b == bytes[0]; })) {
+		std::memset (static_cast<void *> (first), bytes[0], n*sizeof (T));
+		return;
+	}
+
+	// Otherwise write one cache-friendly block element by element and
+	// replicate it with memcpy.
+	const size_t block = std::min (n, std::max<size_t> (4096/sizeof (T), 1));
+	for (size_t i = 0; i < block; ++i)
+		std::memcpy (static_cast<void *> (first+i), &value, sizeof (T));
+	for (size_t done = block; done < n; done += block)
+		std::memcpy (static_cast<void *> (first+done), first, std::min (block, n-done)*sizeof (T));
+}
+
+#endif /* ARRAY_OPS_H */
@@ -0,0 +1,299 @@
+/* -*- C++ -*- */
+
+#ifndef ARRAY_PARALLEL_H
+#define ARRAY_PARALLEL_H
+
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class Array_Parallel_Policy
+ * @brief Decides how many threads an operation on a large array may
+ *        use and how finely its range is split.
+ *
+ * The parallel methods of <Array> take a policy; when they are not
+ * given one they use <defaults>.  The bulk fill and copy paths that
+ * array construction, <resize> and copying use for trivially copyable
+ * elements also go parallel, with the default policy, for ranges of at
+ * least <bulk_threshold> bytes.  Change the defaults at startup,
+ * before other threads use arrays.
+ */
+class Array_Parallel_Policy
+{
+public:
+  // Use at most <threads> threads, counting the calling one (0 means
+  // one per hardware thread), and give each of them tasks of at least
+  // <grain> elements.
+  explicit Array_Parallel_Policy (size_t threads = 0, size_t grain = 32768)
+    : threads_ (threads), grain_ (grain == 0 ? 1 : grain)
+  {
+  }
+
+  // Returns the number of threads to use.
+  size_t threads (void) const
+  {
+    if (threads_ != 0)
+      return threads_;
+    static const size_t hardware = std::max (1u, std::thread::hardware_concurrency ());
+    return hardware;
+  }
+
+  // Returns the smallest number of elements worth a task of its own.
+  size_t grain (void) const { return grain_; }
+
+  // Returns the policy used when none is given.
+  static const Array_Parallel_Policy &defaults (void)
+  {
+    return default_policy ();
+  }
+
+  static void set_defaults (const Array_Parallel_Policy &policy)
+  {
+    default_policy () = policy;
+  }
+
+  // Returns the size in bytes from which the bulk fill and copy paths
+  // go parallel.  0 means never.  Defaults to 16 MB.
+  static size_t bulk_threshold (void)
+  {
+    return threshold ();
+  }
+
+  static void set_bulk_threshold (size_t bytes)
+  {
+    threshold () = bytes;
+  }
+
+private:
+  static Array_Parallel_Policy &default_policy (void)
+  {
+    static Array_Parallel_Policy policy;
+    return policy;
+  }
+
+  static size_t &threshold (void)
+  {
+    static size_t bytes = 16u << 20;
+    return bytes;
+  }
+
+  size_t threads_;
+  size_t grain_;
+};
+
+/**
+ * @class Array_Thread_Pool
+ * @brief A pool of worker threads shared by all the arrays of a
+ *        process, which runs one batch of tasks at a time.
+ *
+ * The calling thread takes part in its own batch.  Workers are started
+ * on first use, as many as the largest batch asked for, and are
+ * joined when the process exits.  A batch started from inside a task
+ * runs serially on that task's thread, so parallel operations may be
+ * nested without deadlocking.
+ */
+class Array_Thread_Pool
+{
+public:
+  // Returns the process-wide pool.
+  static Array_Thread_Pool &instance (void)
+  {
+    static Array_Thread_Pool pool;
+    return pool;
+  }
+
+  ~Array_Thread_Pool (void)
+  {
+    {
+      std::lock_guard<std::mutex> guard (lock_);
+      stop_ = true;
+    }
+    wake_.notify_all ();
+    for (size_t i = 0; i < workers_.size (); ++i)
+      workers_[i].join ();
+  }
+
+  // Call <task> (i) for each i in [0, <tasks>) on the calling thread
+  // and up to <threads> - 1 workers, and return once all the calls
+  // have finished.  If any of them throws, the tasks that haven't
+  // started yet are skipped and the first exception is rethrown.
+  void run (size_t tasks, size_t threads, const std::function<void (size_t)> &task)
+  {
+    if (inside_ || tasks <= 1 || threads <= 1)
+      {
+        for (size_t i = 0; i < tasks; ++i)
+          task (i);
+        return;
+      }
+
+    std::lock_guard<std::mutex> batch (run_lock_);
+    {
+      std::lock_guard<std::mutex> guard (lock_);
+      const size_t helpers = std::min (threads, tasks) - 1;
+      while (workers_.size () < helpers)
+        workers_.push_back (std::thread (&Array_Thread_Pool::worker, this, generation_));
+      task_ = &task;
+      tasks_ = tasks;
+      next_.store (0);
+      failed_.store (false);
+      error_ = 0;
+      wanted_ = helpers;
+      running_ = 1;
+      ++generation_;
+    }
+    wake_.notify_all ();
+
+    work ();
+
+    std::exception_ptr error;
+    {
+      std::unique_lock<std::mutex> guard (lock_);
+      --running_;
+      done_.wait (guard, [this] { return running_ == 0; });
+      // Workers that wake up late must not join a finished batch.
+      wanted_ = 0;
+      task_ = 0;
+      error = error_;
+    }
+    if (error)
+      std::rethrow_exception (error);
+  }
+
+  // Split [0, <n>) into ranges of at least <policy>.grain () elements
+  // and call <f> (begin, end) for each of them, using up to
+  // <policy>.threads () threads.
+  template <typename F>
+  static void for_each_range (size_t n, const Array_Parallel_Policy &policy, F f)
+  {
+    const size_t threads = policy.threads ();
+    if (threads <= 1 || n <= policy.grain ())
+      {
+        if (n != 0)
+          f (size_t (0), n);
+        return;
+      }
+
+    // A few tasks per thread even out differences in their speed.
+    const size_t chunk = std::max (policy.grain (), (n + 4*threads - 1) / (4*threads));
+    const size_t tasks = (n + chunk - 1) / chunk;
+    instance ().run (tasks, threads, [n, chunk, &f] (size_t t) {
+        const size_t begin = t * chunk;
+        f (begin, std::min (n, begin + chunk));
+      });
+  }
+
+  // Same as above for the bulk fill and copy paths: <n> elements of
+  // <size> bytes are only split if they take at least
+  // Array_Parallel_Policy::bulk_threshold () bytes, and then into
+  // ranges of at least 1 MB.
+  template <typename F>
+  static void for_each_bulk_range (size_t n, size_t size, F f)
+  {
+    const size_t threshold = Array_Parallel_Policy::bulk_threshold ();
+    if (threshold == 0 || n * size < threshold)
+      {
+        if (n != 0)
+          f (size_t (0), n);
+        return;
+      }
+    const Array_Parallel_Policy &defaults = Array_Parallel_Policy::defaults ();
+    for_each_range (n, Array_Parallel_Policy (defaults.threads (),
+                                              std::max (defaults.grain (), (size_t (1) << 20) / size)),
+                    f);
+  }
+
+private:
+  Array_Thread_Pool (void)
+    : stop_ (false), generation_ (0), task_ (0), tasks_ (0), next_ (0),
+      wanted_ (0), running_ (0), failed_ (false)
+  {
+  }
+
+  // Disallow copying
+  Array_Thread_Pool (const Array_Thread_Pool &);
+  Array_Thread_Pool &operator= (const Array_Thread_Pool &);
+
+  // Body of each worker thread: join every batch after the <seen> one
+  // that still wants helpers.
+  void worker (size_t seen)
+  {
+    std::unique_lock<std::mutex> guard (lock_);
+    for (;;)
+      {
+        wake_.wait (guard, [this, seen] { return stop_ || generation_ != seen; });
+        if (stop_)
+          return;
+        seen = generation_;
+        if (wanted_ == 0)
+          continue;
+        --wanted_;
+        ++running_;
+        guard.unlock ();
+        work ();
+        guard.lock ();
+        if (--running_ == 0)
+          done_.notify_all ();
+      }
+  }
+
+  // Take tasks of the current batch until there are none left.
+  void work (void)
+  {
+    inside_ = true;
+    for (;;)
+      {
+        const size_t i = next_.fetch_add (1);
+        if (i >= tasks_ || failed_.load ())
+          break;
+        try
+          {
+            (*task_) (i);
+          }
+        catch (...)
+          {
+            std::lock_guard<std::mutex> guard (lock_);
+            if (!error_)
+              error_ = std::current_exception ();
+            failed_.store (true);
+          }
+      }
+    inside_ = false;
+  }
+
+  // Serializes batches.
+  std::mutex run_lock_;
+
+  // Protects everything below except <next_> and <failed_>.
+  std::mutex lock_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  std::vector<std::thread> workers_;
+  bool stop_;
+
+  // Incremented for each batch.
+  size_t generation_;
+
+  // = The current batch.
+  const std::function<void (size_t)> *task_;
+  size_t tasks_;
+  std::atomic<size_t> next_;
+
+  // Number of workers still wanted, and of threads working on it.
+  size_t wanted_;
+  size_t running_;
+
+  std::atomic<bool> failed_;
+  std::exception_ptr error_;
+
+  // True while the current thread runs a task.
+  static inline thread_local bool inside_ = false;
+};
+
+#endif /* ARRAY_PARALLEL_H */
@@ -0,0 +1,506 @@
+/* -*- C++ -*- */
+
+#ifndef ARRAY_SIMD_H
+#define ARRAY_SIMD_H
+
+#include <stdlib.h>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+// Kernels for the wide instruction sets are only built for x86 with
+// GCC-compatible compilers; everything else uses the scalar versions.
+#if (defined (__x86_64__) || defined (__i386__)) && defined (__GNUC__)
+#define ARRAY_SIMD_X86 1
+#else
+#define ARRAY_SIMD_X86 0
+#endif
+
+/**
+ * @class Array_SIMD_Scalar
+ * @brief Plain loops over ranges of <T>.  These are the fallback
+ * kernels and the reference the vector kernels are tested against.
+ */
+template <typename T>
+struct Array_SIMD_Scalar
+{
+  static void fill (T *dest, size_t n, T value)
+  {
+    for (size_t i = 0; i < n; ++i)
+      dest[i] = value;
+  }
+
+  static bool equal (const T *lhs, const T *rhs, size_t n)
+  {
+    for (size_t i = 0; i < n; ++i)
+      if (!(lhs[i] == rhs[i]))
+        return false;
+    return true;
+  }
+
+  static size_t find (const T *src, size_t n, T value)
+  {
+    size_t i = 0;
+    while (i < n && !(src[i] == value))
+      ++i;
+    return i;
+  }
+
+  static size_t count (const T *src, size_t n, T value)
+  {
+    size_t c = 0;
+    for (size_t i = 0; i < n; ++i)
+      c += src[i] == value;
+    return c;
+  }
+
+  static T min (const T *src, size_t n)
+  {
+    T m = src[0];
+    for (size_t i = 1; i < n; ++i)
+      if (src[i] < m)
+        m = src[i];
+    return m;
+  }
+
+  static T max (const T *src, size_t n)
+  {
+    T m = src[0];
+    for (size_t i = 1; i < n; ++i)
+      if (m < src[i])
+        m = src[i];
+    return m;
+  }
+
+  static T sum (const T *src, size_t n)
+  {
+    T s = T ();
+    for (size_t i = 0; i < n; ++i)
+      s += src[i];
+    return s;
+  }
+
+  static T dot (const T *lhs, const T *rhs, size_t n)
+  {
+    T s = T ();
+    for (size_t i = 0; i < n; ++i)
+      s += lhs[i] * rhs[i];
+    return s;
+  }
+};
+
+#if ARRAY_SIMD_X86
+
+#define ARRAY_SIMD_INLINE inline __attribute__ ((always_inline))
+
+/**
+ * @class Array_SIMD_Vector
+ * @brief The kernels written once with GCC vector extensions for
+ * vectors of <BYTES> bytes.
+ *
+ * They are always inlined into the per-instruction-set wrappers
+ * below, whose target attributes decide which instructions the
+ * compiler may use.  Vectors are only passed by reference, so no
+ * function here depends on the vector calling convention.  Loads and
+ * stores go through memcpy, so no alignment is assumed.
+ */
+template <typename T, size_t BYTES>
+struct Array_SIMD_Vector
+{
+  typedef T V __attribute__ ((vector_size (BYTES)));
+
+  // Integer vector type produced by comparing two V's: each lane is
+  // 0 or -1.
+  typedef decltype (V () == V ()) M;
+
+  static const size_t LANES = BYTES / sizeof (T);
+
+  static ARRAY_SIMD_INLINE void load (V &v, const T *p)
+  {
+    std::memcpy (&v, p, sizeof v);
+  }
+
+  // Returns true if any lane of <m> is set.
+  static ARRAY_SIMD_INLINE bool any (const M &m)
+  {
+    unsigned long long words[BYTES / 8];
+    std::memcpy (words, &m, sizeof words);
+    unsigned long long bits = 0;
+    for (size_t w = 0; w < BYTES / 8; ++w)
+      bits |= words[w];
+    return bits != 0;
+  }
+
+  static ARRAY_SIMD_INLINE void fill (T *dest, size_t n, T value)
+  {
+    const V v = V () + value;
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES)
+      std::memcpy (dest+i, &v, sizeof v);
+    for (; i < n; ++i)
+      dest[i] = value;
+  }
+
+  static ARRAY_SIMD_INLINE bool equal (const T *lhs, const T *rhs, size_t n)
+  {
+    V x, y;
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES)
+      {
+        load (x, lhs+i);
+        load (y, rhs+i);
+        if (any (x != y))
+          return false;
+      }
+    return Array_SIMD_Scalar<T>::equal (lhs+i, rhs+i, n-i);
+  }
+
+  static ARRAY_SIMD_INLINE size_t find (const T *src, size_t n, T value)
+  {
+    const V v = V () + value;
+    V x;
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES)
+      {
+        load (x, src+i);
+        if (any (x == v))
+          break;
+      }
+    return i + Array_SIMD_Scalar<T>::find (src+i, n-i, value);
+  }
+
+  static ARRAY_SIMD_INLINE size_t count (const T *src, size_t n, T value)
+  {
+    const V v = V () + value;
+    V x;
+    size_t c = 0;
+    size_t i = 0;
+    while (i + LANES <= n)
+      {
+        // Matching lanes are -1, so subtracting the mask counts up.
+        // Flush before the narrowest (8-bit) lane can overflow.
+        M acc = M ();
+        for (size_t k = 0; k < 127 && i + LANES <= n; ++k, i += LANES)
+          {
+            load (x, src+i);
+            acc -= x == v;
+          }
+        for (size_t l = 0; l < LANES; ++l)
+          c += acc[l];
+      }
+    return c + Array_SIMD_Scalar<T>::count (src+i, n-i, value);
+  }
+
+  static ARRAY_SIMD_INLINE T min (const T *src, size_t n)
+  {
+    if (n < LANES)
+      return Array_SIMD_Scalar<T>::min (src, n);
+    V m, x;
+    load (m, src);
+    size_t i = LANES;
+    for (; i + LANES <= n; i += LANES)
+      {
+        load (x, src+i);
+        m = x < m ? x : m;
+      }
+    // The remainder is scanned together with the last full vector.
+    T r = Array_SIMD_Scalar<T>::min (src+i-LANES, n-i+LANES);
+    for (size_t l = 0; l < LANES; ++l)
+      if (m[l] < r)
+        r = m[l];
+    return r;
+  }
+
+  static ARRAY_SIMD_INLINE T max (const T *src, size_t n)
+  {
+    if (n < LANES)
+      return Array_SIMD_Scalar<T>::max (src, n);
+    V m, x;
+    load (m, src);
+    size_t i = LANES;
+    for (; i + LANES <= n; i += LANES)
+      {
+        load (x, src+i);
+        m = m < x ? x : m;
+      }
+    T r = Array_SIMD_Scalar<T>::max (src+i-LANES, n-i+LANES);
+    for (size_t l = 0; l < LANES; ++l)
+      if (r < m[l])
+        r = m[l];
+    return r;
+  }
+
+  // Four independent accumulators hide the latency of the adds.
+  static ARRAY_SIMD_INLINE T sum (const T *src, size_t n)
+  {
+    V a0 = V (), a1 = V (), a2 = V (), a3 = V ();
+    V x0, x1, x2, x3;
+    size_t i = 0;
+    for (; i + 4*LANES <= n; i += 4*LANES)
+      {
+        load (x0, src+i);
+        load (x1, src+i+LANES);
+        load (x2, src+i+2*LANES);
+        load (x3, src+i+3*LANES);
+        a0 += x0;
+        a1 += x1;
+        a2 += x2;
+        a3 += x3;
+      }
+    for (; i + LANES <= n; i += LANES)
+      {
+        load (x0, src+i);
+        a0 += x0;
+      }
+    a0 += a1 + a2 + a3;
+    T s = T ();
+    for (size_t l = 0; l < LANES; ++l)
+      s += a0[l];
+    return s + Array_SIMD_Scalar<T>::sum (src+i, n-i);
+  }
+
+  static ARRAY_SIMD_INLINE T dot (const T *lhs, const T *rhs, size_t n)
+  {
+    V a0 = V (), a1 = V (), a2 = V (), a3 = V ();
+    V x0, x1, x2, x3, y0, y1, y2, y3;
+    size_t i = 0;
+    for (; i + 4*LANES <= n; i += 4*LANES)
+      {
+        load (x0, lhs+i);
+        load (x1, lhs+i+LANES);
+        load (x2, lhs+i+2*LANES);
+        load (x3, lhs+i+3*LANES);
+        load (y0, rhs+i);
+        load (y1, rhs+i+LANES);
+        load (y2, rhs+i+2*LANES);
+        load (y3, rhs+i+3*LANES);
+        a0 += x0 * y0;
+        a1 += x1 * y1;
+        a2 += x2 * y2;
+        a3 += x3 * y3;
+      }
+    for (; i + LANES <= n; i += LANES)
+      {
+        load (x0, lhs+i);
+        load (y0, rhs+i);
+        a0 += x0 * y0;
+      }
+    a0 += a1 + a2 + a3;
+    T s = T ();
+    for (size_t l = 0; l < LANES; ++l)
+      s += a0[l];
+    return s + Array_SIMD_Scalar<T>::dot (lhs+i, rhs+i, n-i);
+  }
+};
+
+// Define Array_SIMD_<NAME><T>, the kernels of Array_SIMD_Vector<T,
+// BYTES> compiled for the instruction set <TARGET>.
+#define ARRAY_SIMD_DEFINE_ISA(NAME, TARGET, BYTES)                      \
+template <typename T>                                                   \
+struct Array_SIMD_##NAME                                                \
+{                                                                       \
+  typedef Array_SIMD_Vector<T, BYTES> K;                                \
+  __attribute__ ((target (TARGET))) static void                         \
+  fill (T *d, size_t n, T v) { K::fill (d, n, v); }                     \
+  __attribute__ ((target (TARGET))) static bool                         \
+  equal (const T *a, const T *b, size_t n) { return K::equal (a, b, n); } \
+  __attribute__ ((target (TARGET))) static size_t                       \
+  find (const T *s, size_t n, T v) { return K::find (s, n, v); }        \
+  __attribute__ ((target (TARGET))) static size_t                       \
+  count (const T *s, size_t n, T v) { return K::count (s, n, v); }      \
+  __attribute__ ((target (TARGET))) static T                            \
+  min (const T *s, size_t n) { return K::min (s, n); }                  \
+  __attribute__ ((target (TARGET))) static T                            \
+  max (const T *s, size_t n) { return K::max (s, n); }                  \
+  __attribute__ ((target (TARGET))) static T                            \
+  sum (const T *s, size_t n) { return K::sum (s, n); }                  \
+  __attribute__ ((target (TARGET))) static T                            \
+  dot (const T *a, const T *b, size_t n) { return K::dot (a, b, n); }   \
+};
+
+ARRAY_SIMD_DEFINE_ISA (SSE2, "sse2", 16)
+ARRAY_SIMD_DEFINE_ISA (AVX2, "avx2", 32)
+ARRAY_SIMD_DEFINE_ISA (AVX512, "avx512f,avx512bw", 64)
+
+#undef ARRAY_SIMD_DEFINE_ISA
+#undef ARRAY_SIMD_INLINE
+
+#endif /* ARRAY_SIMD_X86 */
+
+/**
+ * @class Array_SIMD_Kernels
+ * @brief One complete set of kernels for element type <T>.
+ */
+template <typename T>
+struct Array_SIMD_Kernels
+{
+  void (*fill) (T *, size_t, T);
+  bool (*equal) (const T *, const T *, size_t);
+  size_t (*find) (const T *, size_t, T);
+  size_t (*count) (const T *, size_t, T);
+  T (*min) (const T *, size_t);
+  T (*max) (const T *, size_t);
+  T (*sum) (const T *, size_t);
+  T (*dot) (const T *, const T *, size_t);
+
+  template <typename K>
+  static constexpr Array_SIMD_Kernels make (void)
+  {
+    return Array_SIMD_Kernels { &K::fill, &K::equal, &K::find, &K::count,
+                                &K::min, &K::max, &K::sum, &K::dot };
+  }
+};
+
+/**
+ * @class Array_SIMD
+ * @brief Vectorized fill, equal, find, count, min, max, sum and dot
+ * for arrays of integer or floating point elements.
+ *
+ * The widest instruction set the CPU supports is detected once, on
+ * first use, and its kernels are used from then on.  The container
+ * overloads work with anything that has data() and size(), such as
+ * Array<T> and Small_Array<T, N>, and scan the raw storage directly
+ * instead of going through operator[].
+ *
+ * sum() and dot() accumulate in <T> and, for floating point, add in a
+ * different order than a sequential loop, so the rounding may differ
+ * slightly.  min() and max() of a range containing NaNs are
+ * unspecified.
+ */
+class Array_SIMD
+{
+public:
+  // Instruction sets in increasing order of width.
+  enum ISA { SCALAR, SSE2, AVX2, AVX512 };
+
+  // Returns the widest instruction set that can be used on this CPU.
+  static ISA best_isa (void)
+  {
+    static const ISA isa = detect ();
+    return isa;
+  }
+
+  // Returns the name of <isa>.
+  static const char *isa_name (ISA isa)
+  {
+    static const char *const names[] = { "scalar", "sse2", "avx2", "avx512" };
+    return names[isa];
+  }
+
+  // Returns the kernels for <T> compiled for <isa>, which must not be
+  // wider than best_isa().  Non-arithmetic types always get the
+  // scalar kernels.
+  template <typename T>
+  static const Array_SIMD_Kernels<T> &kernels (ISA isa)
+  {
+    static const Array_SIMD_Kernels<T> scalar =
+      Array_SIMD_Kernels<T>::template make<Array_SIMD_Scalar<T> > ();
+#if ARRAY_SIMD_X86
+    if constexpr (std::is_arithmetic<T>::value && !std::is_same<T, bool>::value
+                  && !std::is_same<T, long double>::value)
+      {
+        static const Array_SIMD_Kernels<T> table[] = {
+          scalar,
+          Array_SIMD_Kernels<T>::template make<Array_SIMD_SSE2<T> > (),
+          Array_SIMD_Kernels<T>::template make<Array_SIMD_AVX2<T> > (),
+          Array_SIMD_Kernels<T>::template make<Array_SIMD_AVX512<T> > ()
+        };
+        return table[isa];
+      }
+#endif
+    (void) isa;
+    return scalar;
+  }
+
+  // Returns the kernels for <T> for this CPU.
+  template <typename T>
+  static const Array_SIMD_Kernels<T> &kernels (void)
+  {
+    static const Array_SIMD_Kernels<T> &k = kernels<T> (best_isa ());
+    return k;
+  }
+
+  // Set every element of <a> to <value>.
+  template <typename ARRAY>
+  static void fill (ARRAY &a, const typename ARRAY::value_type &value)
+  {
+    kernels<typename ARRAY::value_type> ().fill (a.data (), a.size (), value);
+  }
+
+  // Returns true if <lhs> and <rhs> have the same size and elements.
+  template <typename ARRAY>
+  static bool equal (const ARRAY &lhs, const ARRAY &rhs)
+  {
+    return lhs.size () == rhs.size ()
+      && kernels<typename ARRAY::value_type> ().equal (lhs.data (), rhs.data (), lhs.size ());
+  }
+
+  // Returns the index of the first element of <a> equal to <value>,
+  // or a.size () if there is none.
+  template <typename ARRAY>
+  static size_t find (const ARRAY &a, const typename ARRAY::value_type &value)
+  {
+    return kernels<typename ARRAY::value_type> ().find (a.data (), a.size (), value);
+  }
+
+  // Returns the number of elements of <a> equal to <value>.
+  template <typename ARRAY>
+  static size_t count (const ARRAY &a, const typename ARRAY::value_type &value)
+  {
+    return kernels<typename ARRAY::value_type> ().count (a.data (), a.size (), value);
+  }
+
+  // Returns the smallest element of <a>.  Throws std::out_of_range if
+  // <a> is empty.
+  template <typename ARRAY>
+  static typename ARRAY::value_type min (const ARRAY &a)
+  {
+    if (a.size () == 0)
+      throw std::out_of_range ("Array_SIMD::min of an empty array");
+    return kernels<typename ARRAY::value_type> ().min (a.data (), a.size ());
+  }
+
+  // Returns the largest element of <a>.  Throws std::out_of_range if
+  // <a> is empty.
+  template <typename ARRAY>
+  static typename ARRAY::value_type max (const ARRAY &a)
+  {
+    if (a.size () == 0)
+      throw std::out_of_range ("Array_SIMD::max of an empty array");
+    return kernels<typename ARRAY::value_type> ().max (a.data (), a.size ());
+  }
+
+  // Returns the sum of the elements of <a>.
+  template <typename ARRAY>
+  static typename ARRAY::value_type sum (const ARRAY &a)
+  {
+    return kernels<typename ARRAY::value_type> ().sum (a.data (), a.size ());
+  }
+
+  // Returns the sum of the products of the elements of <lhs> and
+  // <rhs>.  Throws std::length_error if their sizes differ.
+  template <typename ARRAY>
+  static typename ARRAY::value_type dot (const ARRAY &lhs, const ARRAY &rhs)
+  {
+    if (lhs.size () != rhs.size ())
+      throw std::length_error ("Array_SIMD::dot of arrays of different sizes");
+    return kernels<typename ARRAY::value_type> ().dot (lhs.data (), rhs.data (), lhs.size ());
+  }
+
+private:
+  static ISA detect (void)
+  {
+#if ARRAY_SIMD_X86
+    __builtin_cpu_init ();
+    if (__builtin_cpu_supports ("avx512f") && __builtin_cpu_supports ("avx512bw"))
+      return AVX512;
+    if (__builtin_cpu_supports ("avx2"))
+      return AVX2;
+    if (__builtin_cpu_supports ("sse2"))
+      return SSE2;
+#endif
+    return SCALAR;
+  }
+};
+
+#endif /* ARRAY_SIMD_H */
@@ -0,0 +1,334 @@
+/* -*- C++ -*- */
+
+#ifndef ARRAY_TELEMETRY_H
+#define ARRAY_TELEMETRY_H
+
+#include <stdlib.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+#include "scoped_array.h"
+#if defined (__GNUG__)
+# include <cxxabi.h>
+#endif /* __GNUG__ */
+
+// Controls whether <Array> counts its allocations in <Array_Telemetry>.
+// Counting is enabled by setting it explicitly (e.g.,
+// -DARRAY_TELEMETRY=1).  When it is 0, the default, the counting code
+// is compiled out completely and the counters stay zero.  Every
+// translation unit of a program should agree on it.
+#if !defined (ARRAY_TELEMETRY)
+# define ARRAY_TELEMETRY 0
+#endif /* ARRAY_TELEMETRY */
+
+/**
+ * @class Array_Telemetry
+ * @brief Counts the allocations and reallocations of <Array>s, so that
+ *        growth storms show up without a heap profiler.
+ *
+ * The counters are kept per tag: by default an Array<T, ALLOC>'s tag
+ * is <T>, so all the arrays of one element type are added up together,
+ * and arrays that use an <Array_Tagged_Allocator> (or any allocator
+ * with a <telemetry_tag> typedef) are counted under that tag instead.
+ * Counting is a few relaxed atomic adds per allocation, never per
+ * element.  <stats> reads one tag's counters and <snapshot> those of
+ * every tag that has counted anything.
+ */
+class Array_Telemetry
+{
+public:
+  // Counts since the program started or the counters were last reset.
+  struct Stats
+  {
+    // Buffers allocated, including those allocated to grow.
+    size_t allocations;
+
+    // Bytes in those buffers.
+    size_t bytes_allocated;
+
+    // Times an array moved its elements to a new buffer, e.g., to grow
+    // in resize (), set () or reserve ().
+    size_t reallocations;
+
+    // Bytes of elements moved to the new buffers.
+    size_t bytes_copied;
+
+    // The largest capacity (in elements) any of the arrays has had.
+    size_t peak_capacity;
+  };
+
+  // One tag's counters, as returned by <snapshot>.
+  struct Entry
+  {
+    // The tag's type name, demangled where the compiler allows.
+    std::string tag;
+    Stats stats;
+  };
+
+  // Returns a snapshot of the counters of <TAG>.
+  template <typename TAG>
+  static Stats stats (void)
+  {
+    return read (counters<TAG> ());
+  }
+
+  // Returns a snapshot of the counters of every tag that has counted
+  // an allocation, most recently used tag first.
+  static std::vector<Entry> snapshot (void)
+  {
+    std::vector<Entry> entries;
+    for (Counters *c = head ().load (std::memory_order_acquire); c != 0; c = c->next_)
+      {
+        Entry e;
+        e.tag = demangle (c->tag_->name ());
+        e.stats = read (*c);
+        entries.push_back (e);
+      }
+    return entries;
+  }
+
+  // Zero the counters of <TAG>.
+  template <typename TAG>
+  static void reset (void)
+  {
+    clear (counters<TAG> ());
+  }
+
+  // Zero the counters of every tag.
+  static void reset_all (void)
+  {
+    for (Counters *c = head ().load (std::memory_order_acquire); c != 0; c = c->next_)
+      clear (*c);
+  }
+
+  // = Hooks called by <Array>, which do nothing unless ARRAY_TELEMETRY
+  // is enabled.
+
+  // Count a buffer of <capacity> elements of <element_size> bytes.
+  template <typename TAG>
+  static void allocated (size_t capacity, size_t element_size)
+  {
+    if constexpr (ARRAY_TELEMETRY)
+      {
+        if (capacity == 0)
+          return;
+        Counters &c = counters<TAG> ();
+        c.allocations_.fetch_add (1, std::memory_order_relaxed);
+        c.bytes_allocated_.fetch_add (capacity * element_size, std::memory_order_relaxed);
+        size_t peak = c.peak_capacity_.load (std::memory_order_relaxed);
+        while (peak < capacity
+               && !c.peak_capacity_.compare_exchange_weak (peak, capacity, std::memory_order_relaxed))
+          ;
+      }
+  }
+
+  // Count moving <bytes> bytes of elements to a new buffer.
+  template <typename TAG>
+  static void reallocated (size_t bytes)
+  {
+    if constexpr (ARRAY_TELEMETRY)
+      {
+        Counters &c = counters<TAG> ();
+        c.reallocations_.fetch_add (1, std::memory_order_relaxed);
+        c.bytes_copied_.fetch_add (bytes, std::memory_order_relaxed);
+      }
+  }
+
+private:
+  // The counters of one tag, which link themselves into the list of
+  // all tags when first used.
+  struct Counters
+  {
+    explicit Counters (const std::type_info &tag)
+      : tag_ (&tag), next_ (head ().load (std::memory_order_relaxed))
+    {
+      while (!head ().compare_exchange_weak (next_, this,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed))
+        ;
+    }
+
+    std::atomic<size_t> allocations_ {0};
+    std::atomic<size_t> bytes_allocated_ {0};
+    std::atomic<size_t> reallocations_ {0};
+    std::atomic<size_t> bytes_copied_ {0};
+    std::atomic<size_t> peak_capacity_ {0};
+    const std::type_info *tag_;
+    Counters *next_;
+  };
+
+  template <typename TAG>
+  static Counters &counters (void)
+  {
+    static Counters c (typeid (TAG));
+    return c;
+  }
+
+  static std::atomic<Counters *> &head (void)
+  {
+    static std::atomic<Counters *> h (0);
+    return h;
+  }
+
+  static Stats read (const Counters &c)
+  {
+    Stats s;
+    s.allocations = c.allocations_.load (std::memory_order_relaxed);
+    s.bytes_allocated = c.bytes_allocated_.load (std::memory_order_relaxed);
+    s.reallocations = c.reallocations_.load (std::memory_order_relaxed);
+    s.bytes_copied = c.bytes_copied_.load (std::memory_order_relaxed);
+    s.peak_capacity = c.peak_capacity_.load (std::memory_order_relaxed);
+    return s;
+  }
+
+  static void clear (Counters &c)
+  {
+    c.allocations_.store (0, std::memory_order_relaxed);
+    c.bytes_allocated_.store (0, std::memory_order_relaxed);
+    c.reallocations_.store (0, std::memory_order_relaxed);
+    c.bytes_copied_.store (0, std::memory_order_relaxed);
+    c.peak_capacity_.store (0, std::memory_order_relaxed);
+  }
+
+  static std::string demangle (const char *name)
+  {
+#if defined (__GNUG__)
+    int status = 0;
+    char *readable = abi::__cxa_demangle (name, 0, 0, &status);
+    if (status == 0 && readable != 0)
+      {
+        std::string s (readable);
+        ::free (readable);
+        return s;
+      }
+#endif /* __GNUG__ */
+    return name;
+  }
+};
+
+// The tag an Array<T, ALLOC> is counted under: <ALLOC>::telemetry_tag
+// if there is one, and <T> otherwise.
+template <typename T, typename ALLOC, typename = void>
+struct Array_Telemetry_Tag
+{
+  typedef T type;
+};
+
+template <typename T, typename ALLOC>
+struct Array_Telemetry_Tag<T, ALLOC, std::void_t<typename ALLOC::telemetry_tag> >
+{
+  typedef typename ALLOC::telemetry_tag type;
+};
+
+/**
+ * @class Array_Tagged_Allocator
+ * @brief A standard conforming allocator that allocates from <ALLOC>
+ *        and makes an <Array> count its allocations under <TAG>.
+ *
+ * <TAG> is any type, usually an empty struct named after the arrays'
+ * owner, e.g., Array<int, Array_Tagged_Allocator<int, Order_Book> >,
+ * so that arrays of the same element type in different subsystems get
+ * separate counters.
+ */
+template <typename T, typename TAG, typename ALLOC = std::allocator<T> >
+class Array_Tagged_Allocator
+{
+  typedef std::allocator_traits<ALLOC> traits;
+
+  // True if the storage comes from std::allocator, which <scoped_array>
+  // would have taken from calloc() for a zeroed buffer.  Such storage
+  // comes from the C heap instead, so zeroed buffers can too and large
+  // ones keep their pages untouched until used.
+  static constexpr bool C_HEAP = std::is_same<ALLOC, std::allocator<T> >::value
+    && alignof (T) <= alignof (std::max_align_t);
+
+public:
+  typedef T value_type;
+  typedef TAG telemetry_tag;
+  typedef typename traits::propagate_on_container_copy_assignment propagate_on_container_copy_assignment;
+  typedef typename traits::propagate_on_container_move_assignment propagate_on_container_move_assignment;
+  typedef typename traits::propagate_on_container_swap propagate_on_container_swap;
+  typedef typename traits::is_always_equal is_always_equal;
+
+  template <typename U>
+  struct rebind
+  {
+    typedef Array_Tagged_Allocator<U, TAG, typename traits::template rebind_alloc<U> > other;
+  };
+
+  Array_Tagged_Allocator (const ALLOC &alloc = ALLOC ()) noexcept
+    : alloc_ (alloc)
+  {
+  }
+
+  template <typename U, typename A>
+  Array_Tagged_Allocator (const Array_Tagged_Allocator<U, TAG, A> &a) noexcept
+    : alloc_ (a.base ())
+  {
+  }
+
+  // Allocate room for <n> elements.  Throws <std::bad_alloc> if
+  // allocation fails.
+  T *allocate (size_t n)
+  {
+    if constexpr (C_HEAP)
+      {
+        if (n > size_t (-1) / sizeof (T))
+          throw std::bad_array_new_length ();
+        void *p = std::malloc (n * sizeof (T));
+        if (p == 0 && n != 0)
+          throw std::bad_alloc ();
+        return static_cast<T *> (p);
+      }
+    else
+      return traits::allocate (this->alloc_, n);
+  }
+
+  // Same as above, but the storage is all zero bytes.  Only there if
+  // <ALLOC> has one or is std::allocator.
+  T *allocate_zeroed (size_t n) requires (C_HEAP || has_allocate_zeroed<ALLOC>::value)
+  {
+    if constexpr (C_HEAP)
+      {
+        void *p = std::calloc (n, sizeof (T));
+        if (p == 0 && n != 0)
+          throw std::bad_alloc ();
+        return static_cast<T *> (p);
+      }
+    else
+      return this->alloc_.allocate_zeroed (n);
+  }
+
+  void deallocate (T *p, size_t n) noexcept
+  {
+    if constexpr (C_HEAP)
+      std::free (p);
+    else
+      traits::deallocate (this->alloc_, p, n);
+  }
+
+  Array_Tagged_Allocator select_on_container_copy_construction (void) const
+  {
+    return Array_Tagged_Allocator (traits::select_on_container_copy_construction (this->alloc_));
+  }
+
+  // Returns the allocator the storage comes from.
+  const ALLOC &base (void) const noexcept
+  {
+    return this->alloc_;
+  }
+
+  bool operator== (const Array_Tagged_Allocator &a) const { return this->alloc_ == a.alloc_; }
+  bool operator!= (const Array_Tagged_Allocator &a) const { return !(*this == a); }
+
+private:
+  [[no_unique_address]] ALLOC alloc_;
+};
+
+#endif /* ARRAY_TELEMETRY_H */
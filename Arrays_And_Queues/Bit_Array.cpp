@@ -0,0 +1,305 @@
+#ifndef BIT_ARRAY_CPP
+#define BIT_ARRAY_CPP
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <utility>
+
+#include "Bit_Array.h"
+
+template <typename ALLOC>
+Bit_Array<ALLOC>::Bit_Array (size_t size,
+			     const ALLOC &alloc) : words_ (words_for (size), 0, Array_Growth_Policy (), alloc), size_ (size)
+{
+}
+
+template <typename ALLOC>
+Bit_Array<ALLOC>::Bit_Array (size_t size,
+			     bool value,
+			     const ALLOC &alloc) : words_ (words_for (size), 0, Array_Growth_Policy (), alloc), size_ (size)
+{
+	if (value)
+		set_range (0, size);
+}
+
+template <typename ALLOC>
+Bit_Array<ALLOC>::Bit_Array (Bit_Array<ALLOC> &&s) noexcept : words_ (std::move (s.words_)), size_ (s.size_)
+{
+	s.size_ = 0;
+}
+
+template <typename ALLOC> Bit_Array<ALLOC> &
+Bit_Array<ALLOC>::operator= (Bit_Array<ALLOC> &&s)
+{
+	if (this == &s) return *this;
+	words_ = std::move (s.words_);
+	size_ = s.size_;
+	s.size_ = 0;
+	return *this;
+}
+
+// = Helpers.
+
+template <typename ALLOC> size_t
+Bit_Array<ALLOC>::words_for (size_t bits)
+{
+	return bits / 64 + (bits % 64 != 0);
+}
+
+template <typename ALLOC> uint64_t
+Bit_Array<ALLOC>::first_mask (size_t first)
+{
+	return ~uint64_t (0) << (first % 64);
+}
+
+template <typename ALLOC> uint64_t
+Bit_Array<ALLOC>::last_mask (size_t last)
+{
+	return ~uint64_t (0) >> ((64 - last % 64) % 64);
+}
+
+template <typename ALLOC> size_t
+Bit_Array<ALLOC>::popcount (const uint64_t *words, size_t n)
+{
+	return Bit_Array_Popcount::best () (words, n);
+}
+
+template <typename ALLOC> bool
+Bit_Array<ALLOC>::in_range (size_t index) const
+{
+	return index < size_;
+}
+
+template <typename ALLOC> void
+Bit_Array<ALLOC>::check_range (size_t first, size_t last) const
+{
+	if (first > last || last > size_) throw std::out_of_range("Index out of range");
+}
+
+template <typename ALLOC> void
+Bit_Array<ALLOC>::check_size (const Bit_Array<ALLOC> &s) const
+{
+	if (size_ != s.size_) throw std::length_error("Bit_Array size mismatch");
+}
+
+template <typename ALLOC> void
+Bit_Array<ALLOC>::clear_tail (void)
+{
+	if (size_ % 64 != 0)
+		words_[size_ / 64] &= last_mask (size_);
+}
+
+// = Single bit methods.
+
+template <typename ALLOC> void
+Bit_Array<ALLOC>::set (size_t index)
+{
+	if (!in_range (index)) throw std::out_of_range("Index out of range");
+	words_[index / 64] |= uint64_t (1) << (index % 64);
+}
+
+template <typename ALLOC> void
+Bit_Array<ALLOC>::reset (size_t index)
+{
+	if (!in_range (index)) throw std::out_of_range("Index out of range");
+	words_[index / 64] &= ~(uint64_t (1) << (index % 64));
+}
+
+template <typename ALLOC> void
+Bit_Array<ALLOC>::flip (size_t index)
+{
+	if (!in_range (index)) throw std::out_of_range("Index out of range");
+	words_[index / 64] ^= uint64_t (1) << (index % 64);
+}
+
+template <typename ALLOC> bool
+Bit_Array<ALLOC>::get (size_t index) const
+{
+	if (!in_range (index)) throw std::out_of_range("Index out of range");
+	return (words_[index / 64] >> (index % 64)) & 1;
+}
+
+template <typename ALLOC> bool
+Bit_Array<ALLOC>::operator[] (size_t index) const
+{
+	if (ARRAY_BOUNDS_CHECK && !in_range(index)) throw std::out_of_range("Value out of range");
+	return (words_.data ()[index / 64] >> (index % 64)) & 1;
+}
+
+// = Range methods.
+
+template <typename ALLOC> void
+Bit_Array<ALLOC>::set_range (size_t first, size_t last)
+{
+	check_range (first, last);
+	if (first == last) return;
+
+	uint64_t *w = words_.data ();
+	const size_t fw = first / 64, lw = (last-1) / 64;
+	if (fw == lw) {
+		w[fw] |= first_mask (first) & last_mask (last);
+		return;
+	}
+	w[fw] |= first_mask (first);
+	std::fill (w+fw+1, w+lw, ~uint64_t (0));
+	w[lw] |= last_mask (last);
+}
+
+template <typename ALLOC> void
+Bit_Array<ALLOC>::reset_range (size_t first, size_t last)
+{
+	check_range (first, last);
+	if (first == last) return;
+
+	uint64_t *w = words_.data ();
+	const size_t fw = first / 64, lw = (last-1) / 64;
+	if (fw == lw) {
+		w[fw] &= ~(first_mask (first) & last_mask (last));
+		return;
+	}
+	w[fw] &= ~first_mask (first);
+	std::fill (w+fw+1, w+lw, uint64_t (0));
+	w[lw] &= ~last_mask (last);
+}
+
+// = Counting and scanning.
+
+template <typename ALLOC> size_t
+Bit_Array<ALLOC>::count (void) const
+{
+	return popcount (words_.data (), words_.size ());
+}
+
+template <typename ALLOC> size_t
+Bit_Array<ALLOC>::count (size_t first, size_t last) const
+{
+	check_range (first, last);
+	if (first == last) return 0;
+
+	const uint64_t *w = words_.data ();
+	const size_t fw = first / 64, lw = (last-1) / 64;
+	if (fw == lw)
+		return std::popcount (w[fw] & first_mask (first) & last_mask (last));
+	return std::popcount (w[fw] & first_mask (first))
+		+ popcount (w+fw+1, lw-fw-1)
+		+ std::popcount (w[lw] & last_mask (last));
+}
+
+template <typename ALLOC> size_t
+Bit_Array<ALLOC>::find_first (void) const
+{
+	const uint64_t *w = words_.data ();
+	const size_t n = words_.size ();
+	for (size_t i = 0; i < n; ++i)
+		if (w[i] != 0)
+			return i * 64 + std::countr_zero (w[i]);
+	return npos;
+}
+
+template <typename ALLOC> size_t
+Bit_Array<ALLOC>::find_next (size_t index) const
+{
+	if (index >= size_ || ++index == size_) return npos;
+
+	const uint64_t *w = words_.data ();
+	const size_t n = words_.size ();
+	size_t i = index / 64;
+	uint64_t word = w[i] & first_mask (index);
+	while (word == 0) {
+		if (++i == n) return npos;
+		word = w[i];
+	}
+	return i * 64 + std::countr_zero (word);
+}
+
+// = Word-parallel operations.
+
+template <typename ALLOC> Bit_Array<ALLOC> &
+Bit_Array<ALLOC>::operator&= (const Bit_Array<ALLOC> &s)
+{
+	check_size (s);
+	uint64_t *w = words_.data ();
+	const uint64_t *sw = s.words_.data ();
+	for (size_t i = 0, n = words_.size (); i < n; ++i)
+		w[i] &= sw[i];
+	return *this;
+}
+
+template <typename ALLOC> Bit_Array<ALLOC> &
+Bit_Array<ALLOC>::operator|= (const Bit_Array<ALLOC> &s)
+{
+	check_size (s);
+	uint64_t *w = words_.data ();
+	const uint64_t *sw = s.words_.data ();
+	for (size_t i = 0, n = words_.size (); i < n; ++i)
+		w[i] |= sw[i];
+	return *this;
+}
+
+template <typename ALLOC> Bit_Array<ALLOC> &
+Bit_Array<ALLOC>::operator^= (const Bit_Array<ALLOC> &s)
+{
+	check_size (s);
+	uint64_t *w = words_.data ();
+	const uint64_t *sw = s.words_.data ();
+	for (size_t i = 0, n = words_.size (); i < n; ++i)
+		w[i] ^= sw[i];
+	return *this;
+}
+
+template <typename ALLOC> bool
+Bit_Array<ALLOC>::operator== (const Bit_Array<ALLOC> &s) const
+{
+	// The bits past <size_> are zero in both, so whole words compare.
+	return size_ == s.size_ && words_ == s.words_;
+}
+
+template <typename ALLOC> bool
+Bit_Array<ALLOC>::operator!= (const Bit_Array<ALLOC> &s) const
+{
+	return !(*this == s);
+}
+
+// = Size methods.
+
+template <typename ALLOC> size_t
+Bit_Array<ALLOC>::size (void) const
+{
+	return size_;
+}
+
+template <typename ALLOC> void
+Bit_Array<ALLOC>::resize (size_t new_size)
+{
+	// New words get the zero default, and the bits past the old size
+	// are already clear, so only shrinking has bits to clear.  Moving
+	// the words out took their default along, so a moved-from array
+	// gets it back first.
+	if (!words_.default_value ())
+		words_ = Array<uint64_t, ALLOC> (0, 0, Array_Growth_Policy (), words_.get_allocator ());
+	words_.resize (words_for (new_size));
+	size_ = new_size;
+	clear_tail ();
+}
+
+template <typename ALLOC> size_t
+Bit_Array<ALLOC>::words (void) const
+{
+	return words_.size ();
+}
+
+template <typename ALLOC> const uint64_t *
+Bit_Array<ALLOC>::data (void) const
+{
+	return words_.data ();
+}
+
+template <typename ALLOC> void
+Bit_Array<ALLOC>::swap (Bit_Array<ALLOC> &s)
+{
+	words_.swap (s.words_);
+	std::swap (size_, s.size_);
+}
+
+#endif /* BIT_ARRAY_CPP */
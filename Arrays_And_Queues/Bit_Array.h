@@ -0,0 +1,211 @@
+/* -*- C++ -*- */
+
+#ifndef BIT_ARRAY_H
+#define BIT_ARRAY_H
+
+#include <stdint.h>
+#include <bit>
+#include "Array.h"
+#include "Array_SIMD.h"
+
+/**
+ * @class Bit_Array_Popcount
+ * @brief Kernels that count the set bits in a run of words: a portable
+ *        one, and on x86 one built for the popcnt instruction.
+ */
+struct Bit_Array_Popcount
+{
+  typedef size_t (*KERNEL) (const uint64_t *, size_t);
+
+  static size_t portable (const uint64_t *words, size_t n)
+  {
+    size_t c = 0;
+    for (size_t i = 0; i < n; ++i)
+      c += std::popcount (words[i]);
+    return c;
+  }
+
+#if ARRAY_SIMD_X86
+  __attribute__ ((target ("popcnt"))) static size_t hardware (const uint64_t *words, size_t n)
+  {
+    size_t c = 0;
+    for (size_t i = 0; i < n; ++i)
+      c += __builtin_popcountll (words[i]);
+    return c;
+  }
+#endif /* ARRAY_SIMD_X86 */
+
+  // Returns the fastest kernel this CPU can run.
+  static KERNEL best (void)
+  {
+    static const KERNEL k = detect ();
+    return k;
+  }
+
+private:
+  static KERNEL detect (void)
+  {
+#if ARRAY_SIMD_X86
+    __builtin_cpu_init ();
+    if (__builtin_cpu_supports ("popcnt"))
+      return &hardware;
+#endif /* ARRAY_SIMD_X86 */
+    return &portable;
+  }
+};
+
+/**
+ * @class Bit_Array
+ * @brief Implements a resizable array of bits, packed 64 to a word in
+ *        an <Array> of uint64_t.
+ *
+ * A Bit_Array takes an eighth of the memory of an Array<bool>, and
+ * counting, scanning and combining bitmaps work a word at a time.
+ * <count> uses the CPU's popcnt instruction when it has one, detected
+ * once at first use.  Bits past <size> in the last word are always
+ * zero, so whole words can be counted, compared and combined without
+ * masking.  New bits, whether from construction or <resize>, are
+ * clear; a zeroed array's pages are only touched when first written
+ * (see <Array>).  The words come from an allocator of type <ALLOC>,
+ * e.g., <Array_Huge_Page_Allocator> for bitmaps of billions of bits.
+ */
+template <typename ALLOC = std::allocator<uint64_t> >
+class Bit_Array
+{
+public:
+  // Returned by <find_first> and <find_next> when there is no set bit.
+  static constexpr size_t npos = size_t (-1);
+
+  // = Initialization methods.
+
+  // Create an array of <size> clear bits.  Throws <std::bad_alloc> if
+  // allocation fails.
+  explicit Bit_Array (size_t size, const ALLOC &alloc = ALLOC ());
+
+  // Create an array of <size> bits, all set to <value>.  Throws
+  // <std::bad_alloc> if allocation fails.
+  Bit_Array (size_t size, bool value, const ALLOC &alloc = ALLOC ());
+
+  // Copying copies the words.  Throws <std::bad_alloc> if allocation
+  // fails.
+  Bit_Array (const Bit_Array<ALLOC> &s) = default;
+  Bit_Array<ALLOC> &operator= (const Bit_Array<ALLOC> &s) = default;
+
+  // The move constructor takes over the words of <s> and leaves <s>
+  // with no bits.
+  Bit_Array (Bit_Array<ALLOC> &&s) noexcept;
+
+  // Move assignment takes over the words of <s> (or their values, if
+  // the allocators differ and don't propagate) and leaves <s> with no
+  // bits.
+  Bit_Array<ALLOC> &operator= (Bit_Array<ALLOC> &&s);
+
+  // = Single bit methods.  All throw <std::out_of_range> if <index> is
+  // not <in_range>.
+
+  // Set the bit at <index>.
+  void set (size_t index);
+
+  // Clear the bit at <index>.
+  void reset (size_t index);
+
+  // Invert the bit at <index>.
+  void flip (size_t index);
+
+  // Returns the bit at <index>.
+  bool get (size_t index) const;
+
+  // Bit access, checked only if ARRAY_BOUNDS_CHECK is enabled.
+  bool operator[] (size_t index) const;
+
+  // = Range methods.  Both throw <std::out_of_range> unless
+  // [<first>, <last>) lies within the array.
+
+  // Set the bits in [<first>, <last>).
+  void set_range (size_t first, size_t last);
+
+  // Clear the bits in [<first>, <last>).
+  void reset_range (size_t first, size_t last);
+
+  // = Counting and scanning.
+
+  // Returns the number of set bits.
+  size_t count (void) const;
+
+  // Returns the number of set bits in [<first>, <last>).  Throws
+  // <std::out_of_range> unless that lies within the array.
+  size_t count (size_t first, size_t last) const;
+
+  // Returns the index of the first set bit, or <npos> if there is
+  // none.
+  size_t find_first (void) const;
+
+  // Returns the index of the first set bit after <index>, or <npos>
+  // if there is none.
+  size_t find_next (size_t index) const;
+
+  // = Word-parallel operations.  All throw <std::length_error> if the
+  // arrays differ in size.
+
+  Bit_Array<ALLOC> &operator&= (const Bit_Array<ALLOC> &s);
+  Bit_Array<ALLOC> &operator|= (const Bit_Array<ALLOC> &s);
+  Bit_Array<ALLOC> &operator^= (const Bit_Array<ALLOC> &s);
+
+  // Compare this array with <s> for (in)equality.
+  bool operator== (const Bit_Array<ALLOC> &s) const;
+  bool operator!= (const Bit_Array<ALLOC> &s) const;
+
+  // = Size methods.
+
+  // Returns the number of bits.
+  size_t size (void) const;
+
+  // Change the number of bits to <new_size>.  New bits are clear.
+  // Throws <std::bad_alloc> if allocation fails.
+  void resize (size_t new_size);
+
+  // Returns the number of words holding the bits.
+  size_t words (void) const;
+
+  // Returns a pointer to the first word.  Bit <i> is bit i % 64 of
+  // word i / 64.
+  const uint64_t *data (void) const;
+
+  // Swap the contents of this array with <s>.  Does not throw.
+  void swap (Bit_Array<ALLOC> &s);
+
+private:
+  // Returns true if <index> is within range.
+  bool in_range (size_t index) const;
+
+  // Throws <std::out_of_range> unless [<first>, <last>) lies within
+  // the array.
+  void check_range (size_t first, size_t last) const;
+
+  // Throws <std::length_error> unless <s> has as many bits as we do.
+  void check_size (const Bit_Array<ALLOC> &s) const;
+
+  // Returns the number of words needed for <bits> bits.
+  static size_t words_for (size_t bits);
+
+  // Returns the mask of the bits of word <first> / 64 at or after
+  // <first> (of word (<last> - 1) / 64 before <last>).
+  static uint64_t first_mask (size_t first);
+  static uint64_t last_mask (size_t last);
+
+  // Returns the number of set bits in the <n> words at <words>.
+  static size_t popcount (const uint64_t *words, size_t n);
+
+  // Clear the bits of the last word past <size_>.
+  void clear_tail (void);
+
+  // The bits, 64 to a word, low bit first.
+  Array<uint64_t, ALLOC> words_;
+
+  // Number of bits.
+  size_t size_;
+};
+
+#include "Bit_Array.cpp"
+
+#endif /* BIT_ARRAY_H */
@@ -0,0 +1,375 @@
+#ifndef COW_ARRAY_CPP
+#define COW_ARRAY_CPP
+
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include "COW_Array.h"
+
+template <typename T, typename ALLOC> template <typename... ARGS> typename COW_Array<T, ALLOC>::Rep *
+COW_Array<T, ALLOC>::make (const ALLOC &alloc, ARGS &&... args)
+{
+	REP_ALLOC rep_alloc (alloc);
+	Rep *rep = rep_traits::allocate (rep_alloc, 1);
+	try {
+		::new (static_cast<void *> (rep)) Rep (std::forward<ARGS> (args)...);
+	}
+	catch (...) {
+		rep_traits::deallocate (rep_alloc, rep, 1);
+		throw;
+	}
+	return rep;
+}
+
+template <typename T, typename ALLOC> void
+COW_Array<T, ALLOC>::release (Rep *rep) noexcept
+{
+	// The last owner must see all the writes of the others before it
+	// destroys the array.
+	if (rep != 0 && rep->refs_.fetch_sub (1, std::memory_order_acq_rel) == 1) {
+		REP_ALLOC rep_alloc (rep->array_.get_allocator());
+		rep->~Rep ();
+		rep_traits::deallocate (rep_alloc, rep, 1);
+	}
+}
+
+template <typename T, typename ALLOC> const typename COW_Array<T, ALLOC>::ARRAY &
+COW_Array<T, ALLOC>::read (void) const
+{
+	return rep_->array_;
+}
+
+template <typename T, typename ALLOC> typename COW_Array<T, ALLOC>::ARRAY &
+COW_Array<T, ALLOC>::write (void)
+{
+	if (rep_ == 0)
+		rep_ = make (alloc_, size_t (0), alloc_);
+	else if (rep_->refs_.load (std::memory_order_acquire) != 1) {
+		// Detach: copy the shared array into storage from its own
+		// allocator, which <release> frees the Rep with, and drop our
+		// reference to it.
+		const ALLOC alloc (rep_->array_.get_allocator());
+		Rep *copy = make (alloc, rep_->array_, alloc);
+		release (rep_);
+		rep_ = copy;
+	}
+	return rep_->array_;
+}
+
+template <typename T, typename ALLOC> typename COW_Array<T, ALLOC>::ARRAY &
+COW_Array<T, ALLOC>::write_unshareable (void)
+{
+	ARRAY &array = write ();
+	rep_->shareable_ = false;
+	return array;
+}
+
+template <typename T, typename ALLOC>
+COW_Array<T, ALLOC>::COW_Array (size_t size,
+				const Array_Growth_Policy &growth,
+				const ALLOC &alloc) : rep_ (make (alloc, size, growth, alloc)), alloc_ (alloc)
+{
+}
+
+template <typename T, typename ALLOC>
+COW_Array<T, ALLOC>::COW_Array (size_t size,
+				const ALLOC &alloc) : rep_ (make (alloc, size, alloc)), alloc_ (alloc)
+{
+}
+
+template <typename T, typename ALLOC>
+COW_Array<T, ALLOC>::COW_Array (size_t size,
+				const T &default_value,
+				const Array_Growth_Policy &growth,
+				const ALLOC &alloc) : rep_ (make (alloc, size, default_value, growth, alloc)), alloc_ (alloc)
+{
+}
+
+template <typename T, typename ALLOC>
+COW_Array<T, ALLOC>::COW_Array (Array<T, ALLOC> &&s) : rep_ (make (s.get_allocator(), std::move (s))), alloc_ (rep_->array_.get_allocator())
+{
+}
+
+// The copy constructor shares the buffer of <s>.
+
+template <typename T, typename ALLOC>
+COW_Array<T, ALLOC>::COW_Array (const COW_Array<T, ALLOC> &s) : rep_ (s.rep_), alloc_ (s.alloc_)
+{
+	if (rep_ == 0) return;
+	if (rep_->shareable_)
+		rep_->refs_.fetch_add (1, std::memory_order_relaxed);
+	else {
+		const ALLOC alloc (rep_->array_.get_allocator());
+		rep_ = make (alloc, rep_->array_, alloc);
+	}
+}
+
+template <typename T, typename ALLOC> COW_Array<T, ALLOC> &
+COW_Array<T, ALLOC>::operator= (const COW_Array<T, ALLOC> &s)
+{
+	if (this == &s) return *this;
+	COW_Array<T, ALLOC> temp (s);
+	swap (temp);
+	return *this;
+}
+
+template <typename T, typename ALLOC>
+COW_Array<T, ALLOC>::COW_Array (COW_Array<T, ALLOC> &&s) noexcept : rep_ (s.rep_), alloc_ (s.alloc_)
+{
+	s.rep_ = 0;
+}
+
+template <typename T, typename ALLOC> COW_Array<T, ALLOC> &
+COW_Array<T, ALLOC>::operator= (COW_Array<T, ALLOC> &&s) noexcept
+{
+	if (this == &s) return *this;
+	release (rep_);
+	rep_ = s.rep_;
+	alloc_ = s.alloc_;
+	s.rep_ = 0;
+	return *this;
+}
+
+template <typename T, typename ALLOC>
+COW_Array<T, ALLOC>::~COW_Array (void)
+{
+	release (rep_);
+}
+
+template <typename T, typename ALLOC> typename COW_Array<T, ALLOC>::iterator
+COW_Array<T, ALLOC>::begin (void)
+{
+	return write_unshareable ().begin ();
+}
+
+template <typename T, typename ALLOC> typename COW_Array<T, ALLOC>::const_iterator
+COW_Array<T, ALLOC>::begin (void) const
+{
+	return rep_ ? read ().begin () : const_iterator ();
+}
+
+template <typename T, typename ALLOC> typename COW_Array<T, ALLOC>::iterator
+COW_Array<T, ALLOC>::end (void)
+{
+	return write_unshareable ().end ();
+}
+
+template <typename T, typename ALLOC> typename COW_Array<T, ALLOC>::const_iterator
+COW_Array<T, ALLOC>::end (void) const
+{
+	return rep_ ? read ().end () : const_iterator ();
+}
+
+template <typename T, typename ALLOC> T *
+COW_Array<T, ALLOC>::data (void)
+{
+	return write_unshareable ().data ();
+}
+
+template <typename T, typename ALLOC> const T *
+COW_Array<T, ALLOC>::data (void) const
+{
+	return rep_ ? read ().data () : 0;
+}
+
+// = Set/get methods.
+
+template <typename T, typename ALLOC> void
+COW_Array<T, ALLOC>::set (const T &new_item, size_t index)
+{
+	// <new_item> may be one of our own elements, and detaching may
+	// release the buffer it lives in, so copy it first if we share.
+	if (is_shared ()) {
+		T item (new_item);
+		write ().set (std::move (item), index);
+	}
+	else
+		write ().set (new_item, index);
+}
+
+template <typename T, typename ALLOC> void
+COW_Array<T, ALLOC>::set (T &&new_item, size_t index)
+{
+	write ().set (std::move (new_item), index);
+}
+
+template <typename T, typename ALLOC> template <typename... ARGS> T &
+COW_Array<T, ALLOC>::emplace (size_t index, ARGS &&... args)
+{
+	return write_unshareable ().emplace (index, std::forward<ARGS> (args)...);
+}
+
+template <typename T, typename ALLOC> void
+COW_Array<T, ALLOC>::get (T &item, size_t index) const
+{
+	if (index >= size ()) throw std::out_of_range("Index out of range");
+	item = read ()[index];
+}
+
+template <typename T, typename ALLOC> size_t
+COW_Array<T, ALLOC>::size (void) const
+{
+	return rep_ ? read ().size () : 0;
+}
+
+template <typename T, typename ALLOC> size_t
+COW_Array<T, ALLOC>::capacity (void) const
+{
+	return rep_ ? read ().capacity () : 0;
+}
+
+template <typename T, typename ALLOC> const T &
+COW_Array<T, ALLOC>::operator[] (size_t index) const
+{
+	if (rep_ == 0) throw std::out_of_range("Value out of range");
+	return read ()[index];
+}
+
+template <typename T, typename ALLOC> T &
+COW_Array<T, ALLOC>::operator[] (size_t index)
+{
+	return write_unshareable ()[index];
+}
+
+template <typename T, typename ALLOC> const T &
+COW_Array<T, ALLOC>::at (size_t index) const
+{
+	if (rep_ == 0) throw std::out_of_range("Value out of range");
+	return read ().at (index);
+}
+
+template <typename T, typename ALLOC> T &
+COW_Array<T, ALLOC>::at (size_t index)
+{
+	// Check before detaching, so a bad index doesn't copy the array.
+	if (index >= size ()) throw std::out_of_range("Value out of range");
+	return write_unshareable ()[index];
+}
+
+template <typename T, typename ALLOC> bool
+COW_Array<T, ALLOC>::operator== (const COW_Array<T, ALLOC> &s) const
+{
+	if (rep_ == s.rep_) return true;
+	if (rep_ == 0 || s.rep_ == 0) return size () == s.size ();
+	return read () == s.read ();
+}
+
+template <typename T, typename ALLOC> bool
+COW_Array<T, ALLOC>::operator!= (const COW_Array<T, ALLOC> &s) const
+{
+	return !(*this == s);
+}
+
+template <typename T, typename ALLOC> void
+COW_Array<T, ALLOC>::resize (size_t new_size)
+{
+	if (new_size != size ())
+		write ().resize (new_size);
+}
+
+template <typename T, typename ALLOC> void
+COW_Array<T, ALLOC>::reserve (size_t new_capacity)
+{
+	if (new_capacity > capacity ())
+		write ().reserve (new_capacity);
+}
+
+template <typename T, typename ALLOC> void
+COW_Array<T, ALLOC>::shrink_to_fit (void)
+{
+	if (size () < capacity ())
+		write ().shrink_to_fit ();
+}
+
+// The source of the bulk writes may be our own buffer, which detaching
+// releases, so it is copied aside first while we share.
+
+template <typename T, typename ALLOC> template <typename ITER> void
+COW_Array<T, ALLOC>::assign (ITER first, ITER last)
+{
+	if (is_shared ()) {
+		// Keep our growth policy and default value, as assigning in
+		// place would.
+		const ARRAY &shared = read ();
+		ARRAY temp = shared.default_value ()
+			? ARRAY (0, *shared.default_value (), shared.growth_policy (), get_allocator())
+			: ARRAY (0, shared.growth_policy (), get_allocator());
+		temp.assign (first, last);
+		*this = COW_Array<T, ALLOC> (std::move (temp));
+	}
+	else
+		write ().assign (first, last);
+}
+
+template <typename T, typename ALLOC> template <typename ITER> void
+COW_Array<T, ALLOC>::append (ITER first, ITER last)
+{
+	set_range (size (), first, last);
+}
+
+template <typename T, typename ALLOC> template <typename ITER> void
+COW_Array<T, ALLOC>::set_range (size_t offset, ITER first, ITER last)
+{
+	if (is_shared ()) {
+		ARRAY temp (0, get_allocator());
+		temp.assign (first, last);
+		write ().set_range (offset, temp.begin (), temp.end ());
+	}
+	else
+		write ().set_range (offset, first, last);
+}
+
+template <typename T, typename ALLOC> template <typename OUT> OUT
+COW_Array<T, ALLOC>::get_range (size_t offset, size_t n, OUT out) const
+{
+	if (rep_ == 0) {
+		if (offset != 0 || n != 0) throw std::out_of_range("Index out of range");
+		return out;
+	}
+	return read ().get_range (offset, n, out);
+}
+
+template <typename T, typename ALLOC> const Array_Growth_Policy &
+COW_Array<T, ALLOC>::growth_policy (void) const
+{
+	static const Array_Growth_Policy default_growth;
+	return rep_ ? read ().growth_policy () : default_growth;
+}
+
+template <typename T, typename ALLOC> void
+COW_Array<T, ALLOC>::swap (COW_Array<T, ALLOC> &new_array)
+{
+	std::swap (rep_, new_array.rep_);
+	std::swap (alloc_, new_array.alloc_);
+}
+
+template <typename T, typename ALLOC> ALLOC
+COW_Array<T, ALLOC>::get_allocator (void) const
+{
+	return rep_ ? read ().get_allocator () : alloc_;
+}
+
+// = Sharing.
+
+template <typename T, typename ALLOC> size_t
+COW_Array<T, ALLOC>::use_count (void) const
+{
+	return rep_ ? rep_->refs_.load (std::memory_order_relaxed) : 0;
+}
+
+template <typename T, typename ALLOC> bool
+COW_Array<T, ALLOC>::is_shared (void) const
+{
+	return rep_ != 0 && rep_->refs_.load (std::memory_order_acquire) != 1;
+}
+
+template <typename T, typename ALLOC> void
+COW_Array<T, ALLOC>::make_shareable (void)
+{
+	if (rep_ != 0)
+		rep_->shareable_ = true;
+}
+
+#endif /* COW_ARRAY_CPP */
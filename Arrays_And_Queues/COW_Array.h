@@ -0,0 +1,234 @@
+/* -*- C++ -*- */
+
+#ifndef COW_ARRAY_H
+#define COW_ARRAY_H
+
+#include <atomic>
+#include "Array.h"
+
+/**
+ * @class COW_Array
+ * @brief Implements a vector that resizes and whose copies share one
+ *        reference-counted <Array> until one of them is written to.
+ *
+ * Copying a COW_Array is O(1): the copies share the same buffer, and
+ * the first write through any of them detaches it by making a private
+ * copy.  That makes read-only snapshots (e.g., of an AQueue<T,
+ * COW_Array<T> >) cheap.  COW_Array has the same interface as <Array>,
+ * so it can be used wherever an <Array> is expected.
+ *
+ * Reads through a const COW_Array never copy.  Every non-const method
+ * detaches, including the ones that merely return a reference,
+ * pointer or iterator (operator[], at, begin, end, data, emplace).
+ * Since the caller may still write through those later, the array is
+ * then marked unshareable, and copies of it are made eagerly until
+ * <make_shareable> is called.  Use set() and the const methods to
+ * keep a buffer shareable.
+ *
+ * The reference count is atomic, so copies may be used, written and
+ * destroyed by different threads, like copies of a std::shared_ptr.
+ * A moved-from COW_Array is empty.
+ */
+template <typename T, typename ALLOC = std::allocator<T> >
+class COW_Array
+{
+public:
+  // Define a "trait"
+  typedef T value_type;
+  typedef ALLOC allocator_type;
+
+  // = Initialization and termination methods.
+
+  // Create an uninitialized array.  Throws <std::bad_alloc> if
+  // allocation fails.
+  COW_Array (size_t size,
+             const Array_Growth_Policy &growth = Array_Growth_Policy (),
+             const ALLOC &alloc = ALLOC ());
+
+  // Create an uninitialized array in storage obtained from <alloc>.
+  COW_Array (size_t size, const ALLOC &alloc);
+
+  // Initialize the entire array to the <default_value>.  Throws
+  // <std::bad_alloc> if allocation fails.
+  COW_Array (size_t size,
+             const T &default_value,
+             const Array_Growth_Policy &growth = Array_Growth_Policy (),
+             const ALLOC &alloc = ALLOC ());
+
+  // Take over the contents of <s> in O(1).  Throws <std::bad_alloc>
+  // if the shared representation can't be allocated.
+  explicit COW_Array (Array<T, ALLOC> &&s);
+
+  // The copy constructor shares the buffer of <s> in O(1), unless <s>
+  // is unshareable, in which case it is copied.  Does not throw in
+  // the first case.
+  COW_Array (const COW_Array<T, ALLOC> &s);
+
+  // Assignment operator shares the buffer of <s> like the copy
+  // constructor and releases our own.
+  COW_Array<T, ALLOC> &operator= (const COW_Array<T, ALLOC> &s);
+
+  // The move constructor takes over the buffer of <s> and leaves <s>
+  // empty.  Does not throw an exception.
+  COW_Array (COW_Array<T, ALLOC> &&s) noexcept;
+
+  // Move assignment releases our buffer and takes over that of <s>.
+  COW_Array<T, ALLOC> &operator= (COW_Array<T, ALLOC> &&s) noexcept;
+
+  // Release our reference to the buffer, destroying it if we were the
+  // last one sharing it.
+  ~COW_Array (void);
+
+  // = Random access iterator definitions
+  typedef Array_Iterator<T> iterator;
+  typedef Const_Array_Iterator<T> const_iterator;
+
+  // The non-const versions detach the buffer and make it unshareable.
+  iterator begin (void);
+  const_iterator begin (void) const;
+  iterator end (void);
+  const_iterator end (void) const;
+
+  // Get a pointer to the first element of the array.  The non-const
+  // version detaches the buffer and makes it unshareable.
+  T *data (void);
+  const T *data (void) const;
+
+  // = Set/get methods.  Writes detach the buffer if it is shared.
+
+  // Set an item in the array at location index, resizing the array if
+  // <index> >= size().  Throws <std::bad_alloc> if detaching or
+  // resizing fails.
+  void set (const T &new_item, size_t index);
+  void set (T &&new_item, size_t index);
+
+  // Build a new item in the array at location index from <args>.
+  // Makes the buffer unshareable.
+  template <typename... ARGS>
+  T &emplace (size_t index, ARGS &&... args);
+
+  // Get an item in the array at location index.  Throws
+  // <std::out_of_range> if index is not <in_range>.
+  void get (T &item, size_t index) const;
+
+  // Returns the current size of the array.
+  size_t size (void) const;
+
+  // Returns how many elements fit before the next reallocation.
+  size_t capacity (void) const;
+
+  // Element access, checked only if ARRAY_BOUNDS_CHECK is enabled.
+  // The non-const version detaches the buffer and makes it
+  // unshareable.
+  const T &operator[] (size_t index) const;
+  T &operator[] (size_t index);
+
+  // Element access that always throws <std::out_of_range> if <index>
+  // is not <in_range>.  The non-const version detaches the buffer and
+  // makes it unshareable.
+  const T &at (size_t index) const;
+  T &at (size_t index);
+
+  // Compare this array with <s> for (in)equality.  Arrays sharing a
+  // buffer compare equal without looking at the elements.
+  bool operator== (const COW_Array<T, ALLOC> &s) const;
+  bool operator!= (const COW_Array<T, ALLOC> &s) const;
+
+  // Change the size of the array to be at least <new_size> elements,
+  // initializing new elements to the default value if one was given.
+  // Throws <std::bad_alloc> if allocation fails.
+  void resize (size_t new_size);
+
+  // Make sure the array can hold <new_capacity> elements without
+  // reallocating.
+  void reserve (size_t new_capacity);
+
+  // Release any capacity beyond size().
+  void shrink_to_fit (void);
+
+  // = Bulk set/get methods, see <Array>.
+  template <typename ITER>
+  void assign (ITER first, ITER last);
+  template <typename ITER>
+  void append (ITER first, ITER last);
+  template <typename ITER>
+  void set_range (size_t offset, ITER first, ITER last);
+  template <typename OUT>
+  OUT get_range (size_t offset, size_t n, OUT out) const;
+
+  // Returns the policy used to grow the array.
+  const Array_Growth_Policy &growth_policy (void) const;
+
+  // Swap the contents of this array with <new_array> in O(1).  Does
+  // not throw an exception.
+  void swap (COW_Array<T, ALLOC> &new_array);
+
+  // Returns a copy of the allocator used for the array's storage.
+  ALLOC get_allocator (void) const;
+
+  // = Sharing.
+
+  // Returns the number of COW_Arrays sharing our buffer (0 if we have
+  // none, e.g., after being moved from).
+  size_t use_count (void) const;
+
+  // Returns true if the buffer is shared with other COW_Arrays, i.e.,
+  // if the next write will copy it.
+  bool is_shared (void) const;
+
+  // Declare that no reference, pointer or iterator obtained from a
+  // non-const method is used any more, so that copies may share the
+  // buffer again.
+  void make_shareable (void);
+
+private:
+  typedef Array<T, ALLOC> ARRAY;
+
+  // The shared representation: the array and its reference count.
+  struct Rep
+  {
+    template <typename... ARGS>
+    explicit Rep (ARGS &&... args)
+      : refs_ (1), shareable_ (true), array_ (std::forward<ARGS> (args)...) {}
+
+    // Number of COW_Arrays sharing <array_>.
+    std::atomic<size_t> refs_;
+
+    // False once a mutable reference to an element has been handed
+    // out; such a Rep is never shared.
+    bool shareable_;
+
+    ARRAY array_;
+  };
+
+  typedef typename std::allocator_traits<ALLOC>::template rebind_alloc<Rep> REP_ALLOC;
+  typedef std::allocator_traits<REP_ALLOC> rep_traits;
+
+  // Allocate a Rep from <alloc> and build its array from <args>.
+  template <typename... ARGS>
+  static Rep *make (const ALLOC &alloc, ARGS &&... args);
+
+  // Drop one reference to <rep>, destroying it if it was the last.
+  static void release (Rep *rep) noexcept;
+
+  // Returns our array for reading.  Must not be called if <rep_> is 0,
+  // i.e., if we are empty after a move.
+  const ARRAY &read (void) const;
+
+  // Returns our array for writing, detaching it first if it is shared.
+  ARRAY &write (void);
+
+  // Same as <write>, but also marks the buffer unshareable because a
+  // mutable reference into it is about to be handed out.
+  ARRAY &write_unshareable (void);
+
+  // Our shared representation, or 0 if we were moved from.
+  Rep *rep_;
+
+  // Allocator used to build a new representation after a move.
+  [[no_unique_address]] ALLOC alloc_;
+};
+
+#include "COW_Array.cpp"
+
+#endif /* COW_ARRAY_H */
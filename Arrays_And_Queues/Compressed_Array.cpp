@@ -0,0 +1,225 @@
+#ifndef COMPRESSED_ARRAY_CPP
+#define COMPRESSED_ARRAY_CPP
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+#include "Compressed_Array.h"
+
+template <typename T, size_t BLOCK, typename ALLOC>
+Compressed_Array<T, BLOCK, ALLOC>::Compressed_Array (const ALLOC &alloc) : directory_ (0, BLOCK_ALLOC (alloc)), words_ (1, 0, Array_Growth_Policy (), WORD_ALLOC (alloc)), tail_ (0, alloc)
+{
+}
+
+template <typename T, size_t BLOCK, typename ALLOC> template <typename ITER>
+Compressed_Array<T, BLOCK, ALLOC>::Compressed_Array (ITER first,
+						     ITER last,
+						     const ALLOC &alloc) : directory_ (0, BLOCK_ALLOC (alloc)), words_ (1, 0, Array_Growth_Policy (), WORD_ALLOC (alloc)), tail_ (0, alloc)
+{
+	append (first, last);
+}
+
+template <typename T, size_t BLOCK, typename ALLOC> bool
+Compressed_Array<T, BLOCK, ALLOC>::in_range (size_t index) const
+{
+	return index < size ();
+}
+
+// = Append methods.
+
+template <typename T, size_t BLOCK, typename ALLOC> void
+Compressed_Array<T, BLOCK, ALLOC>::restore_padding (void)
+{
+	if (words_.size () == 0)
+		words_ = Array<uint64_t, WORD_ALLOC> (1, 0, Array_Growth_Policy (), words_.get_allocator ());
+}
+
+template <typename T, size_t BLOCK, typename ALLOC> void
+Compressed_Array<T, BLOCK, ALLOC>::compress_tail (void)
+{
+	restore_padding ();
+	const T *values = tail_.data ();
+	const std::pair<const T *, const T *> range = std::minmax_element (values, values+BLOCK);
+
+	Block b;
+	b.base = *range.first;
+	b.width = std::bit_width (UNSIGNED (UNSIGNED (*range.second) - UNSIGNED (b.base)));
+	b.offset = words_.size () - 1;
+
+	// The padding word becomes the block's first word; the new words,
+	// and the new padding word, start out zero.
+	words_.resize (b.offset + BLOCK * b.width / 64 + 1);
+	uint64_t *out = words_.data () + b.offset;
+	for (size_t i = 0; i < BLOCK; ++i) {
+		const uint64_t delta = UNSIGNED (UNSIGNED (values[i]) - UNSIGNED (b.base));
+		const size_t bit = i * b.width;
+		const unsigned shift = bit % 64;
+		out[bit/64] |= delta << shift;
+		if (shift + b.width > 64)
+			out[bit/64+1] |= delta >> (64 - shift);
+	}
+
+	directory_.set (b, directory_.size ());
+	tail_.resize (0);
+}
+
+template <typename T, size_t BLOCK, typename ALLOC> void
+Compressed_Array<T, BLOCK, ALLOC>::append (const T &value)
+{
+	tail_.set (value, tail_.size ());
+	if (tail_.size () == BLOCK)
+		compress_tail ();
+}
+
+template <typename T, size_t BLOCK, typename ALLOC> template <typename ITER> void
+Compressed_Array<T, BLOCK, ALLOC>::append (ITER first, ITER last)
+{
+	for (; first != last; ++first)
+		append (*first);
+}
+
+// = Get methods.
+
+template <typename T, size_t BLOCK, typename ALLOC> T
+Compressed_Array<T, BLOCK, ALLOC>::unpack (const Block &b, size_t i) const
+{
+	if (b.width == 0) return b.base;
+
+	// Read the two words the value may straddle, without branching on
+	// whether it does.
+	const uint64_t *p = words_.data () + b.offset;
+	const size_t bit = i * b.width;
+	const unsigned shift = bit % 64;
+	const uint64_t v = (p[bit/64] >> shift | (p[bit/64+1] << 1) << (63 - shift))
+		& (~uint64_t (0) >> (64 - b.width));
+	return T (UNSIGNED (UNSIGNED (b.base) + UNSIGNED (v)));
+}
+
+template <typename T, size_t BLOCK, typename ALLOC> void
+Compressed_Array<T, BLOCK, ALLOC>::unpack (const Block &b, size_t first, size_t n, T *dest) const
+{
+	if (b.width == 0) {
+		std::fill (dest, dest+n, b.base);
+		return;
+	}
+
+	// Every iteration is independent and branch free, so the compiler
+	// can unroll and vectorize it.
+	const uint64_t *p = words_.data () + b.offset;
+	const uint64_t mask = ~uint64_t (0) >> (64 - b.width);
+	const UNSIGNED base = UNSIGNED (b.base);
+	for (size_t i = 0; i < n; ++i) {
+		const size_t bit = (first+i) * b.width;
+		const unsigned shift = bit % 64;
+		const uint64_t v = (p[bit/64] >> shift | (p[bit/64+1] << 1) << (63 - shift)) & mask;
+		dest[i] = T (UNSIGNED (base + UNSIGNED (v)));
+	}
+}
+
+template <typename T, size_t BLOCK, typename ALLOC> void
+Compressed_Array<T, BLOCK, ALLOC>::get (T &item, size_t index) const
+{
+	if (!in_range (index)) throw std::out_of_range("Index out of range");
+	item = (*this)[index];
+}
+
+template <typename T, size_t BLOCK, typename ALLOC> T
+Compressed_Array<T, BLOCK, ALLOC>::operator[] (size_t index) const
+{
+	if (ARRAY_BOUNDS_CHECK && !in_range(index)) throw std::out_of_range("Value out of range");
+	const size_t block = index / BLOCK;
+	if (block < directory_.size ())
+		return unpack (directory_[block], index % BLOCK);
+	return tail_[index % BLOCK];
+}
+
+template <typename T, size_t BLOCK, typename ALLOC> T
+Compressed_Array<T, BLOCK, ALLOC>::at (size_t index) const
+{
+	if (!in_range(index)) throw std::out_of_range("Value out of range");
+	return (*this)[index];
+}
+
+template <typename T, size_t BLOCK, typename ALLOC> void
+Compressed_Array<T, BLOCK, ALLOC>::decode (size_t first, size_t n, T *dest) const
+{
+	if (first > size () || n > size () - first) throw std::out_of_range("Index out of range");
+
+	while (n > 0) {
+		const size_t block = first / BLOCK;
+		const size_t i = first % BLOCK;
+		const size_t run = std::min (n, BLOCK - i);
+		if (block < directory_.size ())
+			unpack (directory_[block], i, run, dest);
+		else
+			std::copy (tail_.data ()+i, tail_.data ()+i+run, dest);
+		first += run;
+		dest += run;
+		n -= run;
+	}
+}
+
+// = Size methods.
+
+template <typename T, size_t BLOCK, typename ALLOC> size_t
+Compressed_Array<T, BLOCK, ALLOC>::size (void) const
+{
+	return directory_.size () * BLOCK + tail_.size ();
+}
+
+template <typename T, size_t BLOCK, typename ALLOC> size_t
+Compressed_Array<T, BLOCK, ALLOC>::blocks (void) const
+{
+	return directory_.size ();
+}
+
+template <typename T, size_t BLOCK, typename ALLOC> unsigned
+Compressed_Array<T, BLOCK, ALLOC>::width (size_t block) const
+{
+	return directory_.at (block).width;
+}
+
+template <typename T, size_t BLOCK, typename ALLOC> size_t
+Compressed_Array<T, BLOCK, ALLOC>::bytes (void) const
+{
+	return directory_.capacity () * sizeof (Block)
+		+ words_.capacity () * sizeof (uint64_t)
+		+ tail_.capacity () * sizeof (T);
+}
+
+template <typename T, size_t BLOCK, typename ALLOC> void
+Compressed_Array<T, BLOCK, ALLOC>::clear (void)
+{
+	directory_.resize (0);
+	restore_padding ();
+	words_.resize (1);
+	words_[0] = 0;
+	tail_.resize (0);
+}
+
+template <typename T, size_t BLOCK, typename ALLOC> bool
+Compressed_Array<T, BLOCK, ALLOC>::operator== (const Compressed_Array<T, BLOCK, ALLOC> &s) const
+{
+	if (size () != s.size ()) return false;
+	for (size_t i = 0; i < size (); ++i)
+		if ((*this)[i] != s[i])
+			return false;
+	return true;
+}
+
+template <typename T, size_t BLOCK, typename ALLOC> bool
+Compressed_Array<T, BLOCK, ALLOC>::operator!= (const Compressed_Array<T, BLOCK, ALLOC> &s) const
+{
+	return !(*this == s);
+}
+
+template <typename T, size_t BLOCK, typename ALLOC> void
+Compressed_Array<T, BLOCK, ALLOC>::swap (Compressed_Array<T, BLOCK, ALLOC> &s)
+{
+	directory_.swap (s.directory_);
+	words_.swap (s.words_);
+	tail_.swap (s.tail_);
+}
+
+#endif /* COMPRESSED_ARRAY_CPP */
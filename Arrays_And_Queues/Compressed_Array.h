@@ -0,0 +1,156 @@
+/* -*- C++ -*- */
+
+#ifndef COMPRESSED_ARRAY_H
+#define COMPRESSED_ARRAY_H
+
+#include <stdint.h>
+#include <type_traits>
+#include "Array.h"
+
+/**
+ * @class Compressed_Array
+ * @brief Implements an append-only array of integers, compressed in
+ *        blocks of <BLOCK> values, with O(1) random access.
+ *
+ * Each full block is stored frame-of-reference: its smallest value is
+ * kept in a block directory as the base, and every value is stored as
+ * its difference from the base in just as many bits as the largest
+ * difference needs.  Columns of IDs or timestamps that are close to
+ * their neighbours thus take a few bits per value instead of 32 or 64.
+ * Since every value in a block has the same width, value i of a block
+ * is found with a shift and a mask, without decoding the ones before
+ * it.  <decode> unpacks runs of values with a branch-free loop.  New
+ * values go to an uncompressed tail block, which is compressed when it
+ * fills up.  The values can't be changed once appended.  All storage
+ * comes from allocators rebound from <ALLOC>.
+ */
+template <typename T, size_t BLOCK = 128, typename ALLOC = std::allocator<T> >
+class Compressed_Array
+{
+  static_assert (std::is_integral<T>::value && !std::is_same<T, bool>::value,
+                 "Compressed_Array holds integers");
+  static_assert (BLOCK != 0 && BLOCK % 64 == 0,
+                 "Compressed_Array block size must be a multiple of 64");
+
+  typedef typename std::make_unsigned<T>::type UNSIGNED;
+
+  // Where a compressed block lives and how to decode it.
+  struct Block
+  {
+    // The smallest value in the block.
+    T base;
+
+    // Index of the block's first word in <words_>.
+    size_t offset;
+
+    // Bits per value.
+    unsigned width;
+  };
+
+  typedef std::allocator_traits<ALLOC> traits;
+  typedef typename traits::template rebind_alloc<Block> BLOCK_ALLOC;
+  typedef typename traits::template rebind_alloc<uint64_t> WORD_ALLOC;
+
+public:
+  // Define a "trait"
+  typedef T value_type;
+  typedef ALLOC allocator_type;
+
+  // = Initialization methods.
+
+  // Create an empty array.
+  explicit Compressed_Array (const ALLOC &alloc = ALLOC ());
+
+  // Create an array holding the values in [<first>, <last>).  Throws
+  // <std::bad_alloc> if allocation fails.
+  template <typename ITER>
+  Compressed_Array (ITER first, ITER last, const ALLOC &alloc = ALLOC ());
+
+  // = Append methods.  Both throw <std::bad_alloc> if allocation fails.
+
+  // Add <value> at the end of the array.
+  void append (const T &value);
+
+  // Add the values in [<first>, <last>) at the end of the array.
+  template <typename ITER>
+  void append (ITER first, ITER last);
+
+  // = Get methods.
+
+  // Get the item at location index.  Throws <std::out_of_range> if
+  // index is not <in_range>.
+  void get (T &item, size_t index) const;
+
+  // Element access, checked only if ARRAY_BOUNDS_CHECK is enabled.
+  T operator[] (size_t index) const;
+
+  // Element access that always throws <std::out_of_range> if <index>
+  // is not <in_range>.
+  T at (size_t index) const;
+
+  // Copy the <n> values starting at <first> to <dest>.  Throws
+  // <std::out_of_range> unless they are all in the array.
+  void decode (size_t first, size_t n, T *dest) const;
+
+  // = Size methods.
+
+  // Returns the number of values.
+  size_t size (void) const;
+
+  // Returns the number of values in a block.
+  static constexpr size_t block_size (void) { return BLOCK; }
+
+  // Returns the number of compressed blocks.  Values past
+  // blocks () * block_size () are in the tail.
+  size_t blocks (void) const;
+
+  // Returns the bits per value of compressed block <block>.
+  unsigned width (size_t block) const;
+
+  // Returns the number of bytes of storage the array has allocated.
+  size_t bytes (void) const;
+
+  // Remove all the values.
+  void clear (void);
+
+  // Compare the values of this array with those of <s> for
+  // (in)equality.
+  bool operator== (const Compressed_Array<T, BLOCK, ALLOC> &s) const;
+  bool operator!= (const Compressed_Array<T, BLOCK, ALLOC> &s) const;
+
+  // Swap the contents of this array with <s>.  Does not throw.
+  void swap (Compressed_Array<T, BLOCK, ALLOC> &s);
+
+private:
+  // Returns true if <index> is within range.
+  bool in_range (size_t index) const;
+
+  // Returns value <i> of compressed block <b>.
+  T unpack (const Block &b, size_t i) const;
+
+  // Copy values [<first>, <first> + <n>) of compressed block <b> to
+  // <dest>.
+  void unpack (const Block &b, size_t first, size_t n, T *dest) const;
+
+  // Compress the full tail block and empty the tail.
+  void compress_tail (void);
+
+  // Moving an array leaves it with no words, not even the padding
+  // word, and without the zero default for new words.  Put both back
+  // if so.  Throws <std::bad_alloc> if allocation fails.
+  void restore_padding (void);
+
+  // One entry per compressed block.
+  Array<Block, BLOCK_ALLOC> directory_;
+
+  // The packed blocks, followed by one zero word so that a value can
+  // always be read from two adjacent words.
+  Array<uint64_t, WORD_ALLOC> words_;
+
+  // The values after the last compressed block, uncompressed.
+  Array<T, ALLOC> tail_;
+};
+
+#include "Compressed_Array.cpp"
+
+#endif /* COMPRESSED_ARRAY_H */
@@ -0,0 +1,455 @@
+/* -*- C++ -*- */
+
+#ifndef FLAT_MAP_H
+#define FLAT_MAP_H
+
+#include <stdlib.h>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include "Array.h"
+
+/**
+ * @class FlatMap
+ * @brief Implements a map from unique <KEY>s to <VALUE>s kept sorted by
+ *        <COMPARE> in contiguous <Array>s.
+ *
+ * The keys and the values live in two parallel arrays, so a lookup's
+ * binary search only touches keys, packed as densely as they can be,
+ * and reads a single value at the end.  As with <SortedArray>, single
+ * inserts and erases shift the entries after them, while the range
+ * constructor, <assign> and the range <insert> sort and deduplicate
+ * their input and merge it in one O(n + k log k) pass.  Entries are
+ * reached by position through <key> and <value>, or by key through
+ * <find>, <at> and operator[].  Lookups accept any key <COMPARE> can
+ * compare with a <KEY>.
+ */
+template <typename KEY, typename VALUE, typename COMPARE = std::less<KEY> >
+class FlatMap
+{
+public:
+  // Define a "trait"
+  typedef KEY key_type;
+  typedef VALUE mapped_type;
+  typedef COMPARE key_compare;
+
+  // Returned by <index> for keys that aren't in the map.
+  static constexpr size_t npos = size_t (-1);
+
+  // = Initialization methods.
+
+  // Create an empty map.
+  explicit FlatMap (const COMPARE &compare = COMPARE ());
+
+  // Build a map from the (key, value) pairs in [<first>, <last>), which
+  // needn't be sorted or unique; of entries with equal keys the first
+  // is kept.  Throws <std::bad_alloc> if allocation fails.
+  template <typename ITER>
+  FlatMap (ITER first, ITER last, const COMPARE &compare = COMPARE ());
+
+  // Replace the contents of the map with the pairs in [<first>,
+  // <last>), as the constructor above does.
+  template <typename ITER>
+  void assign (ITER first, ITER last);
+
+  // = Lookup methods.
+
+  // Returns the position of the entry for <key>, or <npos> if there is
+  // none.
+  template <typename K>
+  size_t index (const K &key) const;
+
+  // Returns the value for <key>, or 0 if there is none.
+  template <typename K>
+  VALUE *find (const K &key);
+  template <typename K>
+  const VALUE *find (const K &key) const;
+
+  // Returns true if the map has an entry for <key>.
+  template <typename K>
+  bool contains (const K &key) const;
+
+  // Returns the value for <key>.  Throws <std::out_of_range> if there
+  // is none.
+  template <typename K>
+  VALUE &at (const K &key);
+  template <typename K>
+  const VALUE &at (const K &key) const;
+
+  // Returns the value for <key>, inserting a default constructed one if
+  // there is none.
+  VALUE &operator[] (const KEY &key);
+
+  // = Positional access, in key order.
+
+  // Returns the key (value) of the entry at position <index>, checked
+  // only if ARRAY_BOUNDS_CHECK is enabled.
+  const KEY &key (size_t index) const;
+  VALUE &value (size_t index);
+  const VALUE &value (size_t index) const;
+
+  // Returns all the keys (values), in key order.
+  const Array<KEY> &keys (void) const;
+  const Array<VALUE> &values (void) const;
+
+  // = Modifiers.
+
+  // Add an entry mapping <key> to <value> unless there is one for
+  // <key> already.  Returns true if it was added.  Costs O(n) moves.
+  bool insert (const KEY &key, const VALUE &value);
+
+  // Same as above, but replaces the value of an existing entry.
+  // Returns true if a new entry was added.
+  bool insert_or_assign (const KEY &key, const VALUE &value);
+
+  // Add the (key, value) pairs in [<first>, <last>) whose keys aren't
+  // present yet, in one merge pass: the batch is sorted and
+  // deduplicated, then merged in from the back so every entry moves at
+  // most once.  Throws <std::bad_alloc> if allocation fails.
+  template <typename ITER>
+  void insert (ITER first, ITER last);
+
+  // Remove the entry for <key>.  Returns the number of entries removed
+  // (0 or 1).
+  template <typename K>
+  size_t erase (const K &key);
+
+  // Remove all the entries, keeping the capacity.
+  void clear (void);
+
+  // = Size methods.
+
+  // Returns the number of entries.
+  size_t size (void) const;
+
+  // Returns true if the map is empty.
+  bool empty (void) const;
+
+  // Returns how many entries fit before the storage grows.
+  size_t capacity (void) const;
+
+  // Make sure the map can hold <new_capacity> entries without
+  // reallocating.
+  void reserve (size_t new_capacity);
+
+  // Compare this map with <s> for (in)equality.
+  bool operator== (const FlatMap<KEY, VALUE, COMPARE> &s) const;
+  bool operator!= (const FlatMap<KEY, VALUE, COMPARE> &s) const;
+
+  // Swap the contents of this map with <s>.  Does not throw.
+  void swap (FlatMap<KEY, VALUE, COMPARE> &s);
+
+  // Returns the comparison object.
+  COMPARE key_comp (void) const;
+
+private:
+  // Returns the position of the first key not less than <key>.
+  template <typename K>
+  size_t lower_bound (const K &key) const;
+
+  // Open a gap at <pos> and put the entry (<key>, <value>) there.
+  void insert_at (size_t pos, const KEY &key, const VALUE &value);
+
+  // Orders the keys.
+  [[no_unique_address]] COMPARE compare_;
+
+  // The keys, sorted and unique.
+  Array<KEY> keys_;
+
+  // <values_>[i] is the value for <keys_>[i].
+  Array<VALUE> values_;
+};
+
+template <typename KEY, typename VALUE, typename COMPARE>
+FlatMap<KEY, VALUE, COMPARE>::FlatMap (const COMPARE &compare) : compare_ (compare), keys_ (0), values_ (0)
+{
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> template <typename ITER>
+FlatMap<KEY, VALUE, COMPARE>::FlatMap (ITER first,
+				       ITER last,
+				       const COMPARE &compare) : compare_ (compare), keys_ (0), values_ (0)
+{
+	insert (first, last);
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> template <typename ITER> void
+FlatMap<KEY, VALUE, COMPARE>::assign (ITER first, ITER last)
+{
+	FlatMap<KEY, VALUE, COMPARE> map (first, last, compare_);
+	swap (map);
+}
+
+// = Lookup methods.
+
+template <typename KEY, typename VALUE, typename COMPARE> template <typename K> size_t
+FlatMap<KEY, VALUE, COMPARE>::lower_bound (const K &key) const
+{
+	return std::lower_bound (keys_.begin (), keys_.end (), key, compare_) - keys_.begin ();
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> template <typename K> size_t
+FlatMap<KEY, VALUE, COMPARE>::index (const K &key) const
+{
+	const size_t pos = lower_bound (key);
+	return pos < keys_.size () && !compare_ (key, keys_[pos]) ? pos : npos;
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> template <typename K> VALUE *
+FlatMap<KEY, VALUE, COMPARE>::find (const K &key)
+{
+	const size_t pos = index (key);
+	return pos == npos ? 0 : &values_[pos];
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> template <typename K> const VALUE *
+FlatMap<KEY, VALUE, COMPARE>::find (const K &key) const
+{
+	const size_t pos = index (key);
+	return pos == npos ? 0 : &values_[pos];
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> template <typename K> bool
+FlatMap<KEY, VALUE, COMPARE>::contains (const K &key) const
+{
+	return index (key) != npos;
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> template <typename K> VALUE &
+FlatMap<KEY, VALUE, COMPARE>::at (const K &key)
+{
+	const size_t pos = index (key);
+	if (pos == npos) throw std::out_of_range("Key not found");
+	return values_[pos];
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> template <typename K> const VALUE &
+FlatMap<KEY, VALUE, COMPARE>::at (const K &key) const
+{
+	const size_t pos = index (key);
+	if (pos == npos) throw std::out_of_range("Key not found");
+	return values_[pos];
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> VALUE &
+FlatMap<KEY, VALUE, COMPARE>::operator[] (const KEY &key)
+{
+	const size_t pos = lower_bound (key);
+	if (pos == keys_.size () || compare_ (key, keys_[pos]))
+		insert_at (pos, key, VALUE ());
+	return values_[pos];
+}
+
+// = Positional access.
+
+template <typename KEY, typename VALUE, typename COMPARE> const KEY &
+FlatMap<KEY, VALUE, COMPARE>::key (size_t index) const
+{
+	return keys_[index];
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> VALUE &
+FlatMap<KEY, VALUE, COMPARE>::value (size_t index)
+{
+	return values_[index];
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> const VALUE &
+FlatMap<KEY, VALUE, COMPARE>::value (size_t index) const
+{
+	return values_[index];
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> const Array<KEY> &
+FlatMap<KEY, VALUE, COMPARE>::keys (void) const
+{
+	return keys_;
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> const Array<VALUE> &
+FlatMap<KEY, VALUE, COMPARE>::values (void) const
+{
+	return values_;
+}
+
+// = Modifiers.
+
+template <typename KEY, typename VALUE, typename COMPARE> void
+FlatMap<KEY, VALUE, COMPARE>::insert_at (size_t pos, const KEY &key, const VALUE &value)
+{
+	// <key> and <value> may not survive the arrays growing, so copy
+	// them first.  Reserve both arrays before touching either, so they
+	// keep the same size if allocation fails, and grow them per their
+	// growth policies, so inserting one key at a time is amortized O(1)
+	// reallocations.
+	KEY new_key (key);
+	VALUE new_value (value);
+	const size_t old_size = keys_.size ();
+	if (old_size+1 > keys_.capacity ())
+		keys_.reserve (keys_.growth_policy ().next_capacity (keys_.capacity (), old_size+1));
+	if (old_size+1 > values_.capacity ())
+		values_.reserve (values_.growth_policy ().next_capacity (values_.capacity (), old_size+1));
+	keys_.resize (old_size+1);
+	values_.resize (old_size+1);
+
+	KEY *k = keys_.data ();
+	VALUE *v = values_.data ();
+	std::move_backward (k+pos, k+old_size, k+old_size+1);
+	std::move_backward (v+pos, v+old_size, v+old_size+1);
+	k[pos] = std::move (new_key);
+	v[pos] = std::move (new_value);
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> bool
+FlatMap<KEY, VALUE, COMPARE>::insert (const KEY &key, const VALUE &value)
+{
+	const size_t pos = lower_bound (key);
+	if (pos < keys_.size () && !compare_ (key, keys_[pos]))
+		return false;
+	insert_at (pos, key, value);
+	return true;
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> bool
+FlatMap<KEY, VALUE, COMPARE>::insert_or_assign (const KEY &key, const VALUE &value)
+{
+	const size_t pos = lower_bound (key);
+	if (pos < keys_.size () && !compare_ (key, keys_[pos])) {
+		values_[pos] = value;
+		return false;
+	}
+	insert_at (pos, key, value);
+	return true;
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> template <typename ITER> void
+FlatMap<KEY, VALUE, COMPARE>::insert (ITER first, ITER last)
+{
+	typedef std::pair<KEY, VALUE> ENTRY;
+	auto less = [this] (const ENTRY &a, const ENTRY &b) { return compare_ (a.first, b.first); };
+
+	// Sort the batch by key; stable, so the first of equal keys
+	// survives <unique>.
+	Array<ENTRY> batch (0);
+	batch.assign (first, last);
+	std::stable_sort (batch.begin (), batch.end (), less);
+	size_t k = std::unique (batch.begin (), batch.end (),
+				[&less] (const ENTRY &a, const ENTRY &b) { return !less (a, b); })
+		- batch.begin ();
+
+	// Drop the keys we already have, in one linear pass over both.
+	const size_t n = keys_.size ();
+	size_t kept = 0;
+	for (size_t i = 0, j = 0; j < k; ++j) {
+		while (i < n && compare_ (keys_[i], batch[j].first))
+			++i;
+		if (i < n && !compare_ (batch[j].first, keys_[i]))
+			continue;
+		if (kept != j)
+			batch[kept] = std::move (batch[j]);
+		++kept;
+	}
+	if (kept == 0) return;
+
+	keys_.reserve (n + kept);
+	values_.reserve (n + kept);
+	keys_.resize (n + kept);
+	values_.resize (n + kept);
+
+	// Merge from the back, so each entry moves once and nothing not
+	// yet merged is overwritten.
+	KEY *keys = keys_.data ();
+	VALUE *values = values_.data ();
+	size_t i = n, j = kept, out = n + kept;
+	while (j > 0) {
+		--out;
+		if (i > 0 && compare_ (batch[j-1].first, keys[i-1])) {
+			--i;
+			keys[out] = std::move (keys[i]);
+			values[out] = std::move (values[i]);
+		} else {
+			--j;
+			keys[out] = std::move (batch[j].first);
+			values[out] = std::move (batch[j].second);
+		}
+	}
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> template <typename K> size_t
+FlatMap<KEY, VALUE, COMPARE>::erase (const K &key)
+{
+	const size_t pos = index (key);
+	if (pos == npos) return 0;
+
+	const size_t size = keys_.size ();
+	KEY *k = keys_.data ();
+	VALUE *v = values_.data ();
+	std::move (k+pos+1, k+size, k+pos);
+	std::move (v+pos+1, v+size, v+pos);
+	keys_.resize (size-1);
+	values_.resize (size-1);
+	return 1;
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> void
+FlatMap<KEY, VALUE, COMPARE>::clear (void)
+{
+	keys_.resize (0);
+	values_.resize (0);
+}
+
+// = Size methods.
+
+template <typename KEY, typename VALUE, typename COMPARE> size_t
+FlatMap<KEY, VALUE, COMPARE>::size (void) const
+{
+	return keys_.size ();
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> bool
+FlatMap<KEY, VALUE, COMPARE>::empty (void) const
+{
+	return keys_.size () == 0;
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> size_t
+FlatMap<KEY, VALUE, COMPARE>::capacity (void) const
+{
+	return std::min (keys_.capacity (), values_.capacity ());
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> void
+FlatMap<KEY, VALUE, COMPARE>::reserve (size_t new_capacity)
+{
+	keys_.reserve (new_capacity);
+	values_.reserve (new_capacity);
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> bool
+FlatMap<KEY, VALUE, COMPARE>::operator== (const FlatMap<KEY, VALUE, COMPARE> &s) const
+{
+	return keys_ == s.keys_ && values_ == s.values_;
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> bool
+FlatMap<KEY, VALUE, COMPARE>::operator!= (const FlatMap<KEY, VALUE, COMPARE> &s) const
+{
+	return !(*this == s);
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> void
+FlatMap<KEY, VALUE, COMPARE>::swap (FlatMap<KEY, VALUE, COMPARE> &s)
+{
+	std::swap (compare_, s.compare_);
+	keys_.swap (s.keys_);
+	values_.swap (s.values_);
+}
+
+template <typename KEY, typename VALUE, typename COMPARE> COMPARE
+FlatMap<KEY, VALUE, COMPARE>::key_comp (void) const
+{
+	return compare_;
+}
+
+#endif /* FLAT_MAP_H */
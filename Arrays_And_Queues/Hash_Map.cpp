@@ -0,0 +1,333 @@
+#ifndef HASH_MAP_CPP
+#define HASH_MAP_CPP
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <utility>
+
+#include "Hash_Map.h"
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC>
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::Hash_Map (const HASH &hash,
+						    const EQUAL &equal,
+						    const ALLOC &alloc) : hash_ (hash), equal_ (equal), distances_ (0, DISTANCE_ALLOC (alloc)), slots_ (0, ENTRY_ALLOC (alloc)), size_ (0), threshold_ (0), shift_ (64), max_load_ (0.875f)
+{
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC>
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::Hash_Map (Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC> &&s) noexcept : hash_ (s.hash_), equal_ (s.equal_), distances_ (std::move (s.distances_)), slots_ (std::move (s.slots_)), size_ (s.size_), threshold_ (s.threshold_), shift_ (s.shift_), max_load_ (s.max_load_)
+{
+	s.reset ();
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC> &
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::operator= (Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC> &&s)
+{
+	if (this == &s) return *this;
+	// Moving an Array leaves it with no elements, so the sizes and
+	// shift of <s> must go with them.
+	hash_ = s.hash_;
+	equal_ = s.equal_;
+	distances_ = std::move (s.distances_);
+	slots_ = std::move (s.slots_);
+	size_ = s.size_;
+	threshold_ = s.threshold_;
+	shift_ = s.shift_;
+	max_load_ = s.max_load_;
+	s.reset ();
+	return *this;
+}
+
+// = Helpers.
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> void
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::reset (void)
+{
+	distances_.resize (0);
+	slots_.resize (0);
+	size_ = 0;
+	threshold_ = 0;
+	shift_ = 64;
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> size_t
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::home (size_t hash) const
+{
+	// Fibonacci hashing: the top bits of the product depend on all the
+	// bits of the hash.
+	return size_t ((uint64_t (hash) * 0x9e3779b97f4a7c15ull) >> shift_);
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> size_t
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::distance (size_t pos) const
+{
+	const size_t d = distances_[pos];
+	if (d < FAR) return d;
+	return 1 + ((pos - home (hash_ (slots_[pos].first))) & (slots_.size () - 1));
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> size_t
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::limit (size_t capacity) const
+{
+	return size_t (capacity * max_load_);
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> template <typename K> size_t
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::lookup (const K &key) const
+{
+	if (size_ == 0) return npos;
+
+	const size_t mask = slots_.size () - 1;
+	const uint8_t *d = distances_.data ();
+	const ENTRY *s = slots_.data ();
+	size_t pos = home (hash_ (key));
+	for (size_t dist = 1; ; ++dist, pos = (pos+1) & mask) {
+		const size_t here = d[pos] < FAR ? d[pos] : distance (pos);
+		// Had <key> been inserted, it would have taken this slot
+		// from an entry closer to home.
+		if (here < dist) return npos;
+		if (here == dist && equal_ (s[pos].first, key)) return pos;
+	}
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> size_t
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::place (ENTRY &&entry)
+{
+	const size_t mask = slots_.size () - 1;
+	uint8_t *d = distances_.data ();
+	ENTRY *s = slots_.data ();
+	size_t pos = home (hash_ (entry.first));
+	size_t result = npos;
+	for (size_t dist = 1; ; ++dist, pos = (pos+1) & mask) {
+		if (d[pos] == 0) {
+			s[pos] = std::move (entry);
+			d[pos] = uint8_t (std::min<size_t> (dist, FAR));
+			return result == npos ? pos : result;
+		}
+		const size_t here = distance (pos);
+		if (here < dist) {
+			// Take the slot from the entry closer to home, and find
+			// a place for that one further on.
+			std::swap (s[pos], entry);
+			d[pos] = uint8_t (std::min<size_t> (dist, FAR));
+			dist = here;
+			if (result == npos)
+				result = pos;
+		}
+	}
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> size_t
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::add (ENTRY &&entry)
+{
+	if (size_ >= threshold_)
+		rehash (slots_.size () == 0 ? MIN_CAPACITY : slots_.size () * 2);
+	const size_t pos = place (std::move (entry));
+	++size_;
+	return pos;
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> void
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::rehash (size_t new_capacity)
+{
+	// Allocate the new table first, so the map is unchanged if that
+	// fails.
+	Array<uint8_t, DISTANCE_ALLOC> distances (new_capacity, 0, Array_Growth_Policy (), distances_.get_allocator ());
+	Array<ENTRY, ENTRY_ALLOC> slots (new_capacity, slots_.get_allocator ());
+	distances_.swap (distances);
+	slots_.swap (slots);
+	shift_ = 64 - std::countr_zero (new_capacity);
+	threshold_ = limit (new_capacity);
+
+	for (size_t i = 0; i < slots.size (); ++i)
+		if (distances[i] != 0)
+			place (std::move (slots[i]));
+}
+
+// = Lookup methods.
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> template <typename K> VALUE *
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::find (const K &key)
+{
+	const size_t pos = lookup (key);
+	return pos == npos ? 0 : &slots_[pos].second;
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> template <typename K> const VALUE *
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::find (const K &key) const
+{
+	const size_t pos = lookup (key);
+	return pos == npos ? 0 : &slots_[pos].second;
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> template <typename K> bool
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::contains (const K &key) const
+{
+	return lookup (key) != npos;
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> template <typename K> VALUE &
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::at (const K &key)
+{
+	const size_t pos = lookup (key);
+	if (pos == npos) throw std::out_of_range("Key not found");
+	return slots_[pos].second;
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> template <typename K> const VALUE &
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::at (const K &key) const
+{
+	const size_t pos = lookup (key);
+	if (pos == npos) throw std::out_of_range("Key not found");
+	return slots_[pos].second;
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> VALUE &
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::operator[] (const KEY &key)
+{
+	size_t pos = lookup (key);
+	if (pos == npos)
+		pos = add (ENTRY (key, VALUE ()));
+	return slots_[pos].second;
+}
+
+// = Modifiers.
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> bool
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::insert (const KEY &key, const VALUE &value)
+{
+	if (lookup (key) != npos) return false;
+	add (ENTRY (key, value));
+	return true;
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> bool
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::insert_or_assign (const KEY &key, const VALUE &value)
+{
+	const size_t pos = lookup (key);
+	if (pos != npos) {
+		slots_[pos].second = value;
+		return false;
+	}
+	add (ENTRY (key, value));
+	return true;
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> template <typename K> size_t
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::erase (const K &key)
+{
+	size_t pos = lookup (key);
+	if (pos == npos) return 0;
+
+	// Shift the entries after it back one slot, up to the first one
+	// that is empty or already at home.
+	const size_t mask = slots_.size () - 1;
+	uint8_t *d = distances_.data ();
+	ENTRY *s = slots_.data ();
+	for (size_t next = (pos+1) & mask; d[next] > 1; pos = next, next = (next+1) & mask) {
+		const size_t dist = distance (next);
+		s[pos] = std::move (s[next]);
+		d[pos] = uint8_t (std::min<size_t> (dist-1, FAR));
+	}
+	d[pos] = 0;
+	s[pos] = ENTRY ();
+	--size_;
+	return 1;
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> void
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::clear (void)
+{
+	for (size_t i = 0; i < slots_.size (); ++i)
+		if (distances_[i] != 0) {
+			distances_[i] = 0;
+			slots_[i] = ENTRY ();
+		}
+	size_ = 0;
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> template <typename F> void
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::for_each (F f)
+{
+	for (size_t i = 0; i < slots_.size (); ++i)
+		if (distances_[i] != 0) {
+			const KEY &key = slots_[i].first;
+			f (key, slots_[i].second);
+		}
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> template <typename F> void
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::for_each (F f) const
+{
+	for (size_t i = 0; i < slots_.size (); ++i)
+		if (distances_[i] != 0)
+			f (slots_[i].first, slots_[i].second);
+}
+
+// = Size methods.
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> size_t
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::size (void) const
+{
+	return size_;
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> bool
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::empty (void) const
+{
+	return size_ == 0;
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> size_t
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::capacity (void) const
+{
+	return slots_.size ();
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> void
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::reserve (size_t count)
+{
+	size_t capacity = std::max (MIN_CAPACITY, slots_.size ());
+	while (limit (capacity) < count)
+		capacity *= 2;
+	if (capacity != slots_.size ())
+		rehash (capacity);
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> float
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::load_factor (void) const
+{
+	return slots_.size () == 0 ? 0.0f : float (size_) / slots_.size ();
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> float
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::max_load_factor (void) const
+{
+	return max_load_;
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> void
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::max_load_factor (float max_load)
+{
+	max_load_ = std::clamp (max_load, 0.25f, 0.95f);
+	if (slots_.size () == 0) return;
+	threshold_ = limit (slots_.size ());
+	if (size_ > threshold_)
+		reserve (size_);
+}
+
+template <typename KEY, typename VALUE, typename HASH, typename EQUAL, typename ALLOC> void
+Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC>::swap (Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC> &s)
+{
+	std::swap (hash_, s.hash_);
+	std::swap (equal_, s.equal_);
+	distances_.swap (s.distances_);
+	slots_.swap (s.slots_);
+	std::swap (size_, s.size_);
+	std::swap (threshold_, s.threshold_);
+	std::swap (shift_, s.shift_);
+	std::swap (max_load_, s.max_load_);
+}
+
+#endif /* HASH_MAP_CPP */
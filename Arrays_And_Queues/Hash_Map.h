@@ -0,0 +1,218 @@
+/* -*- C++ -*- */
+
+#ifndef HASH_MAP_H
+#define HASH_MAP_H
+
+#include <stdint.h>
+#include <functional>
+#include <utility>
+#include "Array.h"
+
+/**
+ * @class Hash_Map
+ * @brief Implements an open-addressing hash map from unique <KEY>s to
+ *        <VALUE>s whose slots live in contiguous <Array>s.
+ *
+ * Collisions are resolved by linear probing with Robin Hood insertion:
+ * an entry that is further from its home slot takes the place of one
+ * that is closer, so probe sequences stay short and a lookup can stop
+ * as soon as it meets an entry closer to home than the key would be.
+ * Each slot's distance from home is kept in a separate byte array
+ * (0 for an empty slot), so probing scans bytes and touches an entry
+ * only to compare keys; the rare entries 254 or more slots from home
+ * have their distance recomputed from their hash.  Erasing shifts the
+ * following entries of the cluster back one slot instead of leaving
+ * tombstones.  The table has a power of two number of slots and
+ * doubles when it would exceed the maximum load factor; hashes are
+ * scrambled with a Fibonacci multiply first, so weak hashes such as
+ * the identity std::hash of integers still spread.  Lookups accept
+ * any key that <HASH> can hash and <EQUAL> can compare with a <KEY>,
+ * e.g., with transparent functors.  Empty slots hold default
+ * constructed entries, so <KEY> and <VALUE> must be default
+ * constructible.  Pointers to values are invalidated by any insertion
+ * or erasure.
+ */
+template <typename KEY,
+          typename VALUE,
+          typename HASH = std::hash<KEY>,
+          typename EQUAL = std::equal_to<KEY>,
+          typename ALLOC = std::allocator<std::pair<KEY, VALUE> > >
+class Hash_Map
+{
+  typedef std::pair<KEY, VALUE> ENTRY;
+  typedef std::allocator_traits<ALLOC> traits;
+  typedef typename traits::template rebind_alloc<ENTRY> ENTRY_ALLOC;
+  typedef typename traits::template rebind_alloc<uint8_t> DISTANCE_ALLOC;
+
+public:
+  // Define a "trait"
+  typedef KEY key_type;
+  typedef VALUE mapped_type;
+  typedef HASH hasher;
+  typedef EQUAL key_equal;
+  typedef ALLOC allocator_type;
+
+  // = Initialization methods.
+
+  // Create an empty map.  No slots are allocated until the first
+  // insertion.
+  explicit Hash_Map (const HASH &hash = HASH (),
+                     const EQUAL &equal = EQUAL (),
+                     const ALLOC &alloc = ALLOC ());
+
+  // Copying copies the slots as they are, so the copy has the same
+  // capacity.  Throws <std::bad_alloc> if allocation fails.
+  Hash_Map (const Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC> &s) = default;
+  Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC> &operator= (const Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC> &s) = default;
+
+  // The move constructor takes over the slots of <s> and leaves <s>
+  // empty, with no slots.
+  Hash_Map (Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC> &&s) noexcept;
+
+  // Move assignment takes over the slots of <s> (or their entries, if
+  // the allocators differ and don't propagate) and leaves <s> empty,
+  // with no slots.
+  Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC> &operator= (Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC> &&s);
+
+  // = Lookup methods.
+
+  // Returns the value for <key>, or 0 if there is none.
+  template <typename K>
+  VALUE *find (const K &key);
+  template <typename K>
+  const VALUE *find (const K &key) const;
+
+  // Returns true if the map has an entry for <key>.
+  template <typename K>
+  bool contains (const K &key) const;
+
+  // Returns the value for <key>.  Throws <std::out_of_range> if there
+  // is none.
+  template <typename K>
+  VALUE &at (const K &key);
+  template <typename K>
+  const VALUE &at (const K &key) const;
+
+  // Returns the value for <key>, inserting a default constructed one if
+  // there is none.  Throws <std::bad_alloc> if allocation fails.
+  VALUE &operator[] (const KEY &key);
+
+  // = Modifiers.  Insertions throw <std::bad_alloc> if allocation
+  // fails.
+
+  // Add an entry mapping <key> to <value> unless there is one for
+  // <key> already.  Returns true if it was added.
+  bool insert (const KEY &key, const VALUE &value);
+
+  // Same as above, but replaces the value of an existing entry.
+  // Returns true if a new entry was added.
+  bool insert_or_assign (const KEY &key, const VALUE &value);
+
+  // Remove the entry for <key>, shifting the rest of its cluster back.
+  // Returns the number of entries removed (0 or 1).
+  template <typename K>
+  size_t erase (const K &key);
+
+  // Remove all the entries, keeping the slots.
+  void clear (void);
+
+  // Call <f> (key, value) for every entry, in no particular order.
+  // <f> must not insert or erase.
+  template <typename F>
+  void for_each (F f);
+  template <typename F>
+  void for_each (F f) const;
+
+  // = Size methods.
+
+  // Returns the number of entries.
+  size_t size (void) const;
+
+  // Returns true if the map is empty.
+  bool empty (void) const;
+
+  // Returns the number of slots.
+  size_t capacity (void) const;
+
+  // Make sure the map can hold <count> entries without rehashing.
+  // Throws <std::bad_alloc> if allocation fails.
+  void reserve (size_t count);
+
+  // Returns the ratio of entries to slots.
+  float load_factor (void) const;
+
+  // Get (set) the load factor beyond which the table doubles.  The
+  // default is 0.875; <max_load> is clamped to [0.25, 0.95].
+  float max_load_factor (void) const;
+  void max_load_factor (float max_load);
+
+  // Swap the contents of this map with <s>.  Does not throw.
+  void swap (Hash_Map<KEY, VALUE, HASH, EQUAL, ALLOC> &s);
+
+private:
+  // Returned by <lookup> for keys that aren't in the map.
+  static constexpr size_t npos = size_t (-1);
+
+  // A slot whose entry is this far from home or further records this
+  // value, and its distance is worked out from the key's hash.
+  static constexpr unsigned FAR = 255;
+
+  // The smallest number of slots allocated.
+  static constexpr size_t MIN_CAPACITY = 8;
+
+  // Returns the home slot of a key with hash <hash>.
+  size_t home (size_t hash) const;
+
+  // Returns the slot holding <key>, or <npos> if there is none.
+  template <typename K>
+  size_t lookup (const K &key) const;
+
+  // Returns 1 + how far the entry in occupied slot <pos> is from its
+  // home slot.
+  size_t distance (size_t pos) const;
+
+  // Add <entry>, whose key isn't in the map, growing the table if it
+  // is full.  Returns its slot.
+  size_t add (ENTRY &&entry);
+
+  // Put <entry>, whose key isn't in the table, in its Robin Hood
+  // position, where the table has room for it.  Returns its slot.
+  size_t place (ENTRY &&entry);
+
+  // Move all the entries to a table of <new_capacity> slots.
+  void rehash (size_t new_capacity);
+
+  // Leave the map empty with no slots, after they have been moved
+  // out.
+  void reset (void);
+
+  // Returns the number of entries <capacity> slots can hold.
+  size_t limit (size_t capacity) const;
+
+  [[no_unique_address]] HASH hash_;
+  [[no_unique_address]] EQUAL equal_;
+
+  // <distances_>[i] is 1 + how far the entry in slot i is from its
+  // home slot (at most <FAR>), or 0 if the slot is empty.
+  Array<uint8_t, DISTANCE_ALLOC> distances_;
+
+  // The entries, in the slots given by <distances_>.
+  Array<ENTRY, ENTRY_ALLOC> slots_;
+
+  // Number of entries.
+  size_t size_;
+
+  // Number of entries before the table grows.
+  size_t threshold_;
+
+  // 64 - log2 (capacity), to take a home slot from the top bits of a
+  // scrambled hash.
+  unsigned shift_;
+
+  // Load factor beyond which the table grows.
+  float max_load_;
+};
+
+#include "Hash_Map.cpp"
+
+#endif /* HASH_MAP_H */
@@ -0,0 +1,329 @@
+#ifndef MAPPED_ARRAY_CPP
+#define MAPPED_ARRAY_CPP
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include "Mapped_Array.h"
+#include "Array_Ops.h"
+
+// Identifies a file written by Mapped_Array.
+static const char MAPPED_ARRAY_MAGIC[8] = { 'M', 'A', 'P', 'A', 'R', 'R', 'A', 'Y' };
+
+template <typename T>
+Mapped_Array<T>::Mapped_Array (const std::string &path,
+			       Mode mode,
+			       const Array_Growth_Policy &growth) : fd_ (-1), base_ (0), length_ (0), mode_ (mode), growth_ (growth)
+{
+	fd_ = ::open (path.c_str(), mode == READ_ONLY ? O_RDONLY : O_RDWR | O_CREAT, 0666);
+	if (fd_ < 0)
+		throw std::system_error (errno, std::generic_category(), "open " + path);
+
+	try {
+		struct stat st;
+		if (::fstat (fd_, &st) != 0)
+			throw std::system_error (errno, std::generic_category(), "fstat " + path);
+		const size_t length = st.st_size;
+
+		if (length == 0) {
+			// A new file: it holds no elements until it is written,
+			// so a read-only one stays unmapped.
+			if (mode_ == READ_ONLY) return;
+			remap (0);
+			std::memcpy (header()->magic_, MAPPED_ARRAY_MAGIC, sizeof MAPPED_ARRAY_MAGIC);
+			header()->element_size_ = sizeof (T);
+			header()->size_ = 0;
+			return;
+		}
+
+		if (length < sizeof (Header))
+			throw std::runtime_error (path + " is not a Mapped_Array");
+		void *p = ::mmap (0, length, mode_ == READ_ONLY ? PROT_READ : PROT_READ | PROT_WRITE,
+				  MAP_SHARED, fd_, 0);
+		if (p == MAP_FAILED)
+			throw std::system_error (errno, std::generic_category(), "mmap " + path);
+		base_ = static_cast<char *> (p);
+		length_ = length;
+
+		if (std::memcmp (header()->magic_, MAPPED_ARRAY_MAGIC, sizeof MAPPED_ARRAY_MAGIC) != 0)
+			throw std::runtime_error (path + " is not a Mapped_Array");
+		if (header()->element_size_ != sizeof (T))
+			throw std::runtime_error (path + " holds elements of a different size");
+		if (header()->size_ > capacity ())
+			throw std::runtime_error (path + " is truncated");
+	}
+	catch (...) {
+		close ();
+		throw;
+	}
+}
+
+template <typename T>
+Mapped_Array<T>::Mapped_Array (Mapped_Array<T> &&s) noexcept : fd_ (-1), base_ (0), length_ (0), mode_ (s.mode_), growth_ (s.growth_)
+{
+	swap (s);
+}
+
+template <typename T> Mapped_Array<T> &
+Mapped_Array<T>::operator= (Mapped_Array<T> &&s) noexcept
+{
+	if (this == &s) return *this;
+	close ();
+	swap (s);
+	return *this;
+}
+
+template <typename T>
+Mapped_Array<T>::~Mapped_Array (void)
+{
+	close ();
+}
+
+template <typename T> void
+Mapped_Array<T>::close (void) noexcept
+{
+	if (base_ != 0)
+		::munmap (base_, length_);
+	if (fd_ >= 0)
+		::close (fd_);
+	fd_ = -1;
+	base_ = 0;
+	length_ = 0;
+}
+
+template <typename T> typename Mapped_Array<T>::Header *
+Mapped_Array<T>::header (void) const
+{
+	return reinterpret_cast<Header *> (base_);
+}
+
+template <typename T> T *
+Mapped_Array<T>::elements (void) const
+{
+	return base_ ? reinterpret_cast<T *> (base_ + sizeof (Header)) : 0;
+}
+
+template <typename T> bool
+Mapped_Array<T>::in_range (size_t index) const
+{
+	return index < size ();
+}
+
+template <typename T> void
+Mapped_Array<T>::check_writable (void) const
+{
+	if (mode_ == READ_ONLY || fd_ < 0)
+		throw std::logic_error ("Mapped_Array is not open for writing");
+}
+
+template <typename T> void
+Mapped_Array<T>::remap (size_t new_capacity)
+{
+	check_writable ();
+	if (new_capacity > (size_t (-1) - sizeof (Header)) / sizeof (T))
+		throw std::length_error ("Mapped_Array too large");
+	const size_t length = sizeof (Header) + new_capacity * sizeof (T);
+
+	// Extend the file before the mapping grows, and shrink it only
+	// after the mapping has, so no mapped page is ever past its end.
+	if (length > length_ && ::ftruncate (fd_, length) != 0)
+		throw std::system_error (errno, std::generic_category(), "ftruncate");
+
+	void *p;
+#if defined (__linux__)
+	if (base_ != 0)
+		p = ::mremap (base_, length_, length, MREMAP_MAYMOVE);
+	else
+#endif /* __linux__ */
+	{
+		// Both mappings show the same file, so nothing is copied.
+		p = ::mmap (0, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+		if (p != MAP_FAILED && base_ != 0)
+			::munmap (base_, length_);
+	}
+	if (p == MAP_FAILED)
+		throw std::system_error (errno, std::generic_category(), "mmap");
+	base_ = static_cast<char *> (p);
+	const size_t old_length = length_;
+	length_ = length;
+
+	if (length < old_length && ::ftruncate (fd_, length) != 0)
+		throw std::system_error (errno, std::generic_category(), "ftruncate");
+}
+
+// = Iterators.
+
+template <typename T> typename Mapped_Array<T>::iterator
+Mapped_Array<T>::begin (void)
+{
+	return iterator (elements ());
+}
+
+template <typename T> typename Mapped_Array<T>::const_iterator
+Mapped_Array<T>::begin (void) const
+{
+	return const_iterator (elements ());
+}
+
+template <typename T> typename Mapped_Array<T>::iterator
+Mapped_Array<T>::end (void)
+{
+	return iterator (elements () + size ());
+}
+
+template <typename T> typename Mapped_Array<T>::const_iterator
+Mapped_Array<T>::end (void) const
+{
+	return const_iterator (elements () + size ());
+}
+
+template <typename T> T *
+Mapped_Array<T>::data (void)
+{
+	return elements ();
+}
+
+template <typename T> const T *
+Mapped_Array<T>::data (void) const
+{
+	return elements ();
+}
+
+// = Set/get methods.
+
+template <typename T> void
+Mapped_Array<T>::set (const T &new_item, size_t index)
+{
+	// <new_item> may live in the mapping, which growing can move.
+	const T item (new_item);
+	if (index >= size ())
+		resize (index+1);
+	elements ()[index] = item;
+}
+
+template <typename T> void
+Mapped_Array<T>::get (T &item, size_t index) const
+{
+	if (!in_range (index)) throw std::out_of_range("Index out of range");
+	item = elements ()[index];
+}
+
+template <typename T> size_t
+Mapped_Array<T>::size (void) const
+{
+	return base_ ? header()->size_ : 0;
+}
+
+template <typename T> size_t
+Mapped_Array<T>::capacity (void) const
+{
+	return base_ ? (length_ - sizeof (Header)) / sizeof (T) : 0;
+}
+
+template <typename T> const T &
+Mapped_Array<T>::operator[] (size_t index) const
+{
+	if (ARRAY_BOUNDS_CHECK && !in_range(index)) throw std::out_of_range("Value out of range");
+	return elements ()[index];
+}
+
+template <typename T> T &
+Mapped_Array<T>::operator[] (size_t index)
+{
+	if (ARRAY_BOUNDS_CHECK && !in_range(index)) throw std::out_of_range("Value out of range");
+	return elements ()[index];
+}
+
+template <typename T> const T &
+Mapped_Array<T>::at (size_t index) const
+{
+	if (!in_range(index)) throw std::out_of_range("Value out of range");
+	return elements ()[index];
+}
+
+template <typename T> T &
+Mapped_Array<T>::at (size_t index)
+{
+	if (!in_range(index)) throw std::out_of_range("Value out of range");
+	return elements ()[index];
+}
+
+template <typename T> bool
+Mapped_Array<T>::operator== (const Mapped_Array<T> &s) const
+{
+	return size () == s.size () && Array_Ops<T>::elements_equal (elements (), s.elements (), size ());
+}
+
+template <typename T> bool
+Mapped_Array<T>::operator!= (const Mapped_Array<T> &s) const
+{
+	return !(*this == s);
+}
+
+// Everything past size() is kept zeroed, so growing within the
+// capacity or into a freshly extended file needn't write anything.
+
+template <typename T> void
+Mapped_Array<T>::resize (size_t new_size)
+{
+	check_writable ();
+	const size_t old_size = size ();
+	if (new_size > capacity ())
+		remap (growth_.next_capacity (capacity (), new_size));
+	else if (new_size < old_size)
+		std::memset (static_cast<void *> (elements ()+new_size), 0, (old_size-new_size)*sizeof (T));
+	header()->size_ = new_size;
+}
+
+template <typename T> void
+Mapped_Array<T>::reserve (size_t new_capacity)
+{
+	if (new_capacity > capacity ())
+		remap (new_capacity);
+}
+
+template <typename T> void
+Mapped_Array<T>::shrink_to_fit (void)
+{
+	if (size () < capacity ())
+		remap (size ());
+}
+
+template <typename T> void
+Mapped_Array<T>::flush (bool async)
+{
+	if (base_ != 0 && ::msync (base_, length_, async ? MS_ASYNC : MS_SYNC) != 0)
+		throw std::system_error (errno, std::generic_category(), "msync");
+}
+
+template <typename T> bool
+Mapped_Array<T>::is_read_only (void) const
+{
+	return mode_ == READ_ONLY;
+}
+
+template <typename T> const Array_Growth_Policy &
+Mapped_Array<T>::growth_policy (void) const
+{
+	return growth_;
+}
+
+template <typename T> void
+Mapped_Array<T>::swap (Mapped_Array<T> &new_array)
+{
+	std::swap (fd_, new_array.fd_);
+	std::swap (base_, new_array.base_);
+	std::swap (length_, new_array.length_);
+	std::swap (mode_, new_array.mode_);
+	std::swap (growth_, new_array.growth_);
+}
+
+#endif /* MAPPED_ARRAY_CPP */
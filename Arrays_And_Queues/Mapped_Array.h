@@ -0,0 +1,187 @@
+/* -*- C++ -*- */
+
+#ifndef MAPPED_ARRAY_H
+#define MAPPED_ARRAY_H
+
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+#include "Array.h"
+
+/**
+ * @class Mapped_Array
+ * @brief Implements a persistent vector of trivially copyable <T>s
+ *        that lives in a memory-mapped file.
+ *
+ * Opening an existing file is O(1): the file is mapped as is and its
+ * pages are read in on demand, and processes mapping the same file
+ * share them through the page cache.  The file starts with a small
+ * header recording the element size and the number of elements,
+ * followed by the elements themselves.  Growing past the capacity
+ * extends the file with ftruncate() and remaps it (according to the
+ * array's growth policy), which invalidates pointers, references and
+ * iterators.  New elements are zero-filled.
+ *
+ * Changes reach the file through the shared mapping; <flush> forces
+ * them to disk with msync().  Writing through a READ_ONLY array is
+ * undefined (it faults), and its resizing methods throw.  System
+ * call failures are reported as <std::system_error>.  Unlike <Array>,
+ * a Mapped_Array can't be copied, only moved.
+ */
+template <typename T>
+class Mapped_Array
+{
+  static_assert (std::is_trivially_copyable<T>::value,
+                 "Mapped_Array can only hold trivially copyable types");
+
+public:
+  // Define a "trait"
+  typedef T value_type;
+
+  enum Mode
+  {
+    READ_ONLY,   // map an existing file for reading
+    READ_WRITE   // map a file for reading and writing, creating it if needed
+  };
+
+  // = Initialization and termination methods.
+
+  // Map the file at <path>.  A new or empty file starts out as an
+  // empty array.  Throws <std::system_error> if the file can't be
+  // opened or mapped, and <std::runtime_error> if it isn't a
+  // Mapped_Array of <T>s.
+  explicit Mapped_Array (const std::string &path,
+                         Mode mode = READ_WRITE,
+                         const Array_Growth_Policy &growth = Array_Growth_Policy ());
+
+  // The move constructor takes over the mapping of <s> and leaves <s>
+  // closed and empty.
+  Mapped_Array (Mapped_Array<T> &&s) noexcept;
+
+  // Move assignment unmaps our file and takes over that of <s>.
+  Mapped_Array<T> &operator= (Mapped_Array<T> &&s) noexcept;
+
+  // Unmap and close the file.  Doesn't wait for the changes to be
+  // written back; call <flush> first for that.
+  ~Mapped_Array (void);
+
+  // = Random access iterator definitions
+  typedef Array_Iterator<T> iterator;
+  typedef Const_Array_Iterator<T> const_iterator;
+
+  iterator begin (void);
+  const_iterator begin (void) const;
+  iterator end (void);
+  const_iterator end (void) const;
+
+  // Get a pointer to the first element of the mapping.
+  T *data (void);
+  const T *data (void) const;
+
+  // = Set/get methods.
+
+  // Set an item in the array at location index, growing the file if
+  // <index> >= size().
+  void set (const T &new_item, size_t index);
+
+  // Get an item in the array at location index.  Throws
+  // <std::out_of_range> if index is not <in_range>.
+  void get (T &item, size_t index) const;
+
+  // Returns the number of elements in the array.
+  size_t size (void) const;
+
+  // Returns how many elements fit in the file before it has to grow.
+  size_t capacity (void) const;
+
+  // Element access, checked only if ARRAY_BOUNDS_CHECK is enabled.
+  const T &operator[] (size_t index) const;
+  T &operator[] (size_t index);
+
+  // Element access that always throws <std::out_of_range> if <index>
+  // is not <in_range>.
+  const T &at (size_t index) const;
+  T &at (size_t index);
+
+  // Compare this array with <s> for (in)equality.
+  bool operator== (const Mapped_Array<T> &s) const;
+  bool operator!= (const Mapped_Array<T> &s) const;
+
+  // Change the size of the array to <new_size> elements.  Growing
+  // zero-fills the new elements without touching their pages when the
+  // file is extended.
+  void resize (size_t new_size);
+
+  // Make sure the file can hold <new_capacity> elements without
+  // growing.
+  void reserve (size_t new_capacity);
+
+  // Truncate the file to the current size.
+  void shrink_to_fit (void);
+
+  // Write the changes back to the file.  With <async> the writes are
+  // only scheduled.  Throws <std::system_error> if msync() fails.
+  void flush (bool async = false);
+
+  // Returns true if the file was opened READ_ONLY.
+  bool is_read_only (void) const;
+
+  // Returns the policy used to grow the file.
+  const Array_Growth_Policy &growth_policy (void) const;
+
+  // Swap the mappings of this array and <new_array>.  Does not throw.
+  void swap (Mapped_Array<T> &new_array);
+
+private:
+  // Disallow copying
+  Mapped_Array (const Mapped_Array<T> &);
+  Mapped_Array<T> &operator= (const Mapped_Array<T> &);
+
+  // The first bytes of the file.  Its size keeps the elements aligned
+  // to a cache line.
+  struct Header
+  {
+    char magic_[8];
+    uint64_t element_size_;
+    uint64_t size_;
+    uint64_t reserved_[5];
+  };
+
+  static_assert (sizeof (Header) == 64, "Mapped_Array header must be 64 bytes");
+  static_assert (alignof (T) <= sizeof (Header), "Mapped_Array elements are only 64-byte aligned");
+
+  // Returns the header at the start of the mapping.
+  Header *header (void) const;
+
+  // Returns the first element in the mapping.
+  T *elements (void) const;
+
+  // Returns true if <index> is within range.
+  bool in_range (size_t index) const;
+
+  // Throw <std::logic_error> if the file was opened READ_ONLY.
+  void check_writable (void) const;
+
+  // Set the file size so it holds <new_capacity> elements and remap
+  // it.
+  void remap (size_t new_capacity);
+
+  // Unmap and close the file, if open.
+  void close (void) noexcept;
+
+  // The open file, or -1.
+  int fd_;
+
+  // Start and length in bytes of the mapping of the whole file.
+  char *base_;
+  size_t length_;
+
+  Mode mode_;
+
+  // Decides the new capacity whenever the file must grow.
+  Array_Growth_Policy growth_;
+};
+
+#include "Mapped_Array.cpp"
+
+#endif /* MAPPED_ARRAY_H */
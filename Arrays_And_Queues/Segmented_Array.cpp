@@ -0,0 +1,368 @@
+#ifndef SEGMENTED_ARRAY_CPP
+#define SEGMENTED_ARRAY_CPP
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "Segmented_Array.h"
+
+template <typename T, size_t CHUNK, typename ALLOC>
+Segmented_Array<T, CHUNK, ALLOC>::Segmented_Array (size_t size,
+						   const ALLOC &alloc) : alloc_ (alloc), chunks_ (0, DIRECTORY_ALLOC (alloc)), cur_size_ (0)
+{
+	try {
+		resize (size);
+	}
+	catch (...) {
+		// The destructor won't run, so give back the chunks.
+		release ();
+		throw;
+	}
+}
+
+template <typename T, size_t CHUNK, typename ALLOC>
+Segmented_Array<T, CHUNK, ALLOC>::Segmented_Array (size_t size,
+						   const T &default_value,
+						   const ALLOC &alloc) : alloc_ (alloc), chunks_ (0, DIRECTORY_ALLOC (alloc)), cur_size_ (0), default_value_ (default_value)
+{
+	try {
+		resize (size);
+	}
+	catch (...) {
+		// The destructor won't run, so give back the chunks.
+		release ();
+		throw;
+	}
+}
+
+template <typename T, size_t CHUNK, typename ALLOC>
+Segmented_Array<T, CHUNK, ALLOC>::Segmented_Array (const Segmented_Array<T, CHUNK, ALLOC> &s) : alloc_ (traits::select_on_container_copy_construction (s.alloc_)), chunks_ (0, DIRECTORY_ALLOC (alloc_)), cur_size_ (0), default_value_ (s.default_value_)
+{
+	try {
+		reserve (s.cur_size_);
+		for (size_t n = 0; cur_size_ < s.cur_size_; ++n) {
+			const size_t run = std::min (CHUNK, s.cur_size_-cur_size_);
+			Array_Ops<T, ALLOC>::copy_construct (alloc_, s.chunks_[n], s.chunks_[n]+run, chunks_[n]);
+			cur_size_ += run;
+		}
+	}
+	catch (...) {
+		// The destructor won't run, so destroy what was copied.
+		release ();
+		throw;
+	}
+}
+
+template <typename T, size_t CHUNK, typename ALLOC>
+Segmented_Array<T, CHUNK, ALLOC>::Segmented_Array (Segmented_Array<T, CHUNK, ALLOC> &&s) noexcept : alloc_ (s.alloc_), chunks_ (std::move (s.chunks_)), cur_size_ (s.cur_size_), default_value_ (std::move (s.default_value_))
+{
+	s.cur_size_ = 0;
+	s.default_value_.reset ();
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> Segmented_Array<T, CHUNK, ALLOC> &
+Segmented_Array<T, CHUNK, ALLOC>::operator= (const Segmented_Array<T, CHUNK, ALLOC> &s)
+{
+	if (this == &s) return *this;
+	Segmented_Array<T, CHUNK, ALLOC> temp (s);
+	swap (temp);
+	return *this;
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> Segmented_Array<T, CHUNK, ALLOC> &
+Segmented_Array<T, CHUNK, ALLOC>::operator= (Segmented_Array<T, CHUNK, ALLOC> &&s)
+{
+	if (this == &s) return *this;
+	release ();
+	default_value_ = std::move (s.default_value_);
+	s.default_value_.reset ();
+	if constexpr (traits::propagate_on_container_move_assignment::value)
+		alloc_ = s.alloc_;
+
+	// The chunks can only be taken over if our allocator can release
+	// them.
+	if (traits::propagate_on_container_move_assignment::value
+	    || traits::is_always_equal::value || alloc_ == s.alloc_) {
+		chunks_ = std::move (s.chunks_);
+		cur_size_ = s.cur_size_;
+		s.cur_size_ = 0;
+	}
+	else {
+		reserve (s.cur_size_);
+		for (size_t n = 0; cur_size_ < s.cur_size_; ++n) {
+			const size_t run = std::min (CHUNK, s.cur_size_-cur_size_);
+			Array_Ops<T, ALLOC>::relocate (alloc_, s.chunks_[n], s.chunks_[n]+run, chunks_[n]);
+			cur_size_ += run;
+		}
+		s.release ();
+	}
+	return *this;
+}
+
+template <typename T, size_t CHUNK, typename ALLOC>
+Segmented_Array<T, CHUNK, ALLOC>::~Segmented_Array (void)
+{
+	release ();
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> void
+Segmented_Array<T, CHUNK, ALLOC>::release (void)
+{
+	for_each_run (0, cur_size_, [this] (T *first, T *last) {
+			Array_Ops<T, ALLOC>::destroy (alloc_, first, last);
+		});
+	for (size_t n = 0; n < chunks_.size (); ++n)
+		traits::deallocate (alloc_, chunks_[n], CHUNK);
+	chunks_.resize (0);
+	cur_size_ = 0;
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> T &
+Segmented_Array<T, CHUNK, ALLOC>::element (size_t index) const
+{
+	return chunks_[index >> SHIFT][index & (CHUNK-1)];
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> bool
+Segmented_Array<T, CHUNK, ALLOC>::in_range (size_t index) const
+{
+	return index < cur_size_;
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> template <typename F> void
+Segmented_Array<T, CHUNK, ALLOC>::for_each_run (size_t begin, size_t end, F f) const
+{
+	while (begin < end) {
+		T *first = &element (begin);
+		const size_t run = std::min (CHUNK - (begin & (CHUNK-1)), end-begin);
+		f (first, first+run);
+		begin += run;
+	}
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> void
+Segmented_Array<T, CHUNK, ALLOC>::construct_to (size_t new_size)
+{
+	size_t done = cur_size_;
+	try {
+		for_each_run (cur_size_, new_size, [this, &done] (T *first, T *last) {
+				if (default_value_)
+					Array_Ops<T, ALLOC>::fill_construct (alloc_, first, last, *default_value_);
+				else
+					Array_Ops<T, ALLOC>::default_construct (alloc_, first, last);
+				done += last-first;
+			});
+	}
+	catch (...) {
+		for_each_run (cur_size_, done, [this] (T *first, T *last) {
+				Array_Ops<T, ALLOC>::destroy (alloc_, first, last);
+			});
+		throw;
+	}
+}
+
+// = Iterators.
+
+template <typename T, size_t CHUNK, typename ALLOC> typename Segmented_Array<T, CHUNK, ALLOC>::iterator
+Segmented_Array<T, CHUNK, ALLOC>::begin (void)
+{
+	return iterator (*this, 0);
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> typename Segmented_Array<T, CHUNK, ALLOC>::const_iterator
+Segmented_Array<T, CHUNK, ALLOC>::begin (void) const
+{
+	return const_iterator (*this, 0);
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> typename Segmented_Array<T, CHUNK, ALLOC>::iterator
+Segmented_Array<T, CHUNK, ALLOC>::end (void)
+{
+	return iterator (*this, cur_size_);
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> typename Segmented_Array<T, CHUNK, ALLOC>::const_iterator
+Segmented_Array<T, CHUNK, ALLOC>::end (void) const
+{
+	return const_iterator (*this, cur_size_);
+}
+
+// = Set/get methods.  Elements never move, so unlike <Array> these
+// needn't guard against <new_item> living in the array.
+
+template <typename T, size_t CHUNK, typename ALLOC> void
+Segmented_Array<T, CHUNK, ALLOC>::set (const T &new_item, size_t index)
+{
+	if (in_range (index))
+		element (index) = new_item;
+	else
+		emplace (index, new_item);
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> void
+Segmented_Array<T, CHUNK, ALLOC>::set (T &&new_item, size_t index)
+{
+	if (in_range (index))
+		element (index) = std::move (new_item);
+	else
+		emplace (index, std::move (new_item));
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> template <typename... ARGS> T &
+Segmented_Array<T, CHUNK, ALLOC>::emplace (size_t index, ARGS &&... args)
+{
+	if (in_range (index)) {
+		element (index) = T (std::forward<ARGS> (args)...);
+		return element (index);
+	}
+	reserve (index+1);
+	resize (index);
+	traits::construct (alloc_, &element (index), std::forward<ARGS> (args)...);
+	cur_size_ = index+1;
+	return element (index);
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> void
+Segmented_Array<T, CHUNK, ALLOC>::get (T &item, size_t index) const
+{
+	if (!in_range (index)) throw std::out_of_range("Index out of range");
+	item = element (index);
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> size_t
+Segmented_Array<T, CHUNK, ALLOC>::size (void) const
+{
+	return cur_size_;
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> size_t
+Segmented_Array<T, CHUNK, ALLOC>::capacity (void) const
+{
+	return chunks_.size () * CHUNK;
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> const T &
+Segmented_Array<T, CHUNK, ALLOC>::operator[] (size_t index) const
+{
+	if (ARRAY_BOUNDS_CHECK && !in_range(index)) throw std::out_of_range("Value out of range");
+	return element (index);
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> T &
+Segmented_Array<T, CHUNK, ALLOC>::operator[] (size_t index)
+{
+	if (ARRAY_BOUNDS_CHECK && !in_range(index)) throw std::out_of_range("Value out of range");
+	return element (index);
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> const T &
+Segmented_Array<T, CHUNK, ALLOC>::at (size_t index) const
+{
+	if (!in_range(index)) throw std::out_of_range("Value out of range");
+	return element (index);
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> T &
+Segmented_Array<T, CHUNK, ALLOC>::at (size_t index)
+{
+	if (!in_range(index)) throw std::out_of_range("Value out of range");
+	return element (index);
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> bool
+Segmented_Array<T, CHUNK, ALLOC>::operator== (const Segmented_Array<T, CHUNK, ALLOC> &s) const
+{
+	if (cur_size_ != s.cur_size_) return false;
+	for (size_t n = 0; n*CHUNK < cur_size_; ++n)
+		if (!Array_Ops<T, ALLOC>::elements_equal (chunks_[n], s.chunks_[n], std::min (CHUNK, cur_size_-n*CHUNK)))
+			return false;
+	return true;
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> bool
+Segmented_Array<T, CHUNK, ALLOC>::operator!= (const Segmented_Array<T, CHUNK, ALLOC> &s) const
+{
+	return !(*this == s);
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> void
+Segmented_Array<T, CHUNK, ALLOC>::resize (size_t new_size)
+{
+	if (new_size < cur_size_) {
+		for_each_run (new_size, cur_size_, [this] (T *first, T *last) {
+				Array_Ops<T, ALLOC>::destroy (alloc_, first, last);
+			});
+		cur_size_ = new_size;
+	}
+	else if (new_size > cur_size_) {
+		reserve (new_size);
+		construct_to (new_size);
+		cur_size_ = new_size;
+	}
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> void
+Segmented_Array<T, CHUNK, ALLOC>::reserve (size_t new_capacity)
+{
+	if (new_capacity <= capacity ()) return;
+	const size_t needed = ((new_capacity-1) >> SHIFT) + 1;
+	// Grow the directory per its growth policy, so adding one chunk at
+	// a time doesn't copy the whole directory every time.
+	if (needed > chunks_.capacity ())
+		chunks_.reserve (chunks_.growth_policy ().next_capacity (chunks_.capacity (), needed));
+	while (chunks_.size () < needed) {
+		T *chunk = traits::allocate (alloc_, CHUNK);
+		// The directory has room, so this doesn't throw.
+		chunks_.set (chunk, chunks_.size ());
+	}
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> void
+Segmented_Array<T, CHUNK, ALLOC>::shrink_to_fit (void)
+{
+	const size_t needed = cur_size_ == 0 ? 0 : ((cur_size_-1) >> SHIFT) + 1;
+	for (size_t n = needed; n < chunks_.size (); ++n)
+		traits::deallocate (alloc_, chunks_[n], CHUNK);
+	chunks_.resize (std::min (needed, chunks_.size ()));
+	chunks_.shrink_to_fit ();
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> void
+Segmented_Array<T, CHUNK, ALLOC>::swap (Segmented_Array<T, CHUNK, ALLOC> &new_array)
+{
+	if constexpr (traits::propagate_on_container_swap::value)
+		std::swap (alloc_, new_array.alloc_);
+	chunks_.swap (new_array.chunks_);
+	std::swap (cur_size_, new_array.cur_size_);
+	std::swap (default_value_, new_array.default_value_);
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> ALLOC
+Segmented_Array<T, CHUNK, ALLOC>::get_allocator (void) const
+{
+	return alloc_;
+}
+
+// = Chunk access.
+
+template <typename T, size_t CHUNK, typename ALLOC> size_t
+Segmented_Array<T, CHUNK, ALLOC>::chunks (void) const
+{
+	return chunks_.size ();
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> T *
+Segmented_Array<T, CHUNK, ALLOC>::chunk (size_t n)
+{
+	return chunks_.at (n);
+}
+
+template <typename T, size_t CHUNK, typename ALLOC> const T *
+Segmented_Array<T, CHUNK, ALLOC>::chunk (size_t n) const
+{
+	return chunks_.at (n);
+}
+
+#endif /* SEGMENTED_ARRAY_CPP */
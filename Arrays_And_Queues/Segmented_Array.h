@@ -0,0 +1,257 @@
+/* -*- C++ -*- */
+
+#ifndef SEGMENTED_ARRAY_H
+#define SEGMENTED_ARRAY_H
+
+#include <bit>
+#include "Array.h"
+#include "Array_Ops.h"
+
+// Default number of elements in each chunk of a <Segmented_Array>:
+// the largest power of two that fits in 64 KB, and at least one.
+template <typename T>
+struct Segmented_Array_Chunk
+{
+  static constexpr size_t value = sizeof (T) >= (64u << 10) ? 1 : std::bit_floor ((64u << 10) / sizeof (T));
+};
+
+/**
+ * @class Segmented_Array
+ * @brief Implements a vector that resizes without ever moving its
+ *        elements.
+ *
+ * The elements live in fixed-size chunks of <CHUNK> elements (a power
+ * of two, so finding an element is a shift and a mask), reached
+ * through a directory of chunk pointers.  Growing allocates new chunks
+ * and leaves the old ones where they are, so it never copies the
+ * elements, never needs room for two copies of them, and never
+ * invalidates pointers or references to them.  Iterators remain valid
+ * as long as the element they point to exists.  Segmented_Array has
+ * the same set/get/iterator interface as <Array> (except <data>, since
+ * the storage isn't contiguous; see <chunk> instead), so it can be used
+ * as the ARRAY parameter of <AQueue>.  Chunks are obtained from an
+ * allocator of type <ALLOC>; shrinking keeps them until
+ * <shrink_to_fit>.
+ */
+template <typename T,
+          size_t CHUNK = Segmented_Array_Chunk<T>::value,
+          typename ALLOC = std::allocator<T> >
+class Segmented_Array
+{
+  static_assert (CHUNK != 0 && (CHUNK & (CHUNK - 1)) == 0,
+                 "Segmented_Array chunk size must be a power of two");
+
+  typedef std::allocator_traits<ALLOC> traits;
+  typedef typename traits::template rebind_alloc<T *> DIRECTORY_ALLOC;
+
+public:
+  // Define a "trait"
+  typedef T value_type;
+  typedef ALLOC allocator_type;
+
+  /**
+   * @class Basic_Iterator
+   * @brief Random access iterator over the elements of a
+   *        Segmented_Array, by position.  <ARRAY> is Segmented_Array or
+   *        const Segmented_Array.
+   */
+  template <typename ARRAY, typename VALUE>
+  class Basic_Iterator
+  {
+  public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef ptrdiff_t difference_type;
+    typedef VALUE *pointer;
+    typedef VALUE &reference;
+
+    Basic_Iterator (void) : array_ (0), pos_ (0) {}
+
+    Basic_Iterator (ARRAY &array, size_t pos) : array_ (&array), pos_ (pos) {}
+
+    // A non-const iterator converts to a const one.
+    template <typename A, typename V>
+    Basic_Iterator (const Basic_Iterator<A, V> &i) : array_ (i.array_), pos_ (i.pos_) {}
+
+    reference operator* (void) const { return array_->element (pos_); }
+    pointer operator-> (void) const { return &array_->element (pos_); }
+    reference operator[] (difference_type n) const { return array_->element (pos_ + n); }
+
+    Basic_Iterator &operator++ (void) { ++pos_; return *this; }
+    Basic_Iterator operator++ (int) { Basic_Iterator old (*this); ++pos_; return old; }
+    Basic_Iterator &operator-- (void) { --pos_; return *this; }
+    Basic_Iterator operator-- (int) { Basic_Iterator old (*this); --pos_; return old; }
+
+    Basic_Iterator &operator+= (difference_type n) { pos_ += n; return *this; }
+    Basic_Iterator &operator-= (difference_type n) { pos_ -= n; return *this; }
+    Basic_Iterator operator+ (difference_type n) const { return Basic_Iterator (*array_, pos_ + n); }
+    Basic_Iterator operator- (difference_type n) const { return Basic_Iterator (*array_, pos_ - n); }
+    friend Basic_Iterator operator+ (difference_type n, const Basic_Iterator &i) { return i + n; }
+
+    difference_type operator- (const Basic_Iterator &rhs) const
+    {
+      return difference_type (pos_) - difference_type (rhs.pos_);
+    }
+
+    bool operator== (const Basic_Iterator &rhs) const { return pos_ == rhs.pos_ && array_ == rhs.array_; }
+    bool operator!= (const Basic_Iterator &rhs) const { return !(*this == rhs); }
+    bool operator< (const Basic_Iterator &rhs) const { return pos_ < rhs.pos_; }
+    bool operator> (const Basic_Iterator &rhs) const { return pos_ > rhs.pos_; }
+    bool operator<= (const Basic_Iterator &rhs) const { return pos_ <= rhs.pos_; }
+    bool operator>= (const Basic_Iterator &rhs) const { return pos_ >= rhs.pos_; }
+
+    // Returns the index of the element the iterator points to.
+    size_t index (void) const { return pos_; }
+
+  private:
+    template <typename A, typename V> friend class Basic_Iterator;
+
+    ARRAY *array_;
+    size_t pos_;
+  };
+
+  typedef Basic_Iterator<Segmented_Array, T> iterator;
+  typedef Basic_Iterator<const Segmented_Array, const T> const_iterator;
+
+  // = Initialization and termination methods.
+
+  // Create an uninitialized array.  Throws <std::bad_alloc> if
+  // allocation fails.
+  explicit Segmented_Array (size_t size, const ALLOC &alloc = ALLOC ());
+
+  // Initialize the entire array to the <default_value>, which new
+  // elements also get when the array grows.  Throws <std::bad_alloc>
+  // if allocation fails.
+  Segmented_Array (size_t size, const T &default_value, const ALLOC &alloc = ALLOC ());
+
+  // The copy constructor makes an exact copy of <s>.  Throws
+  // <std::bad_alloc> if allocation fails.
+  Segmented_Array (const Segmented_Array<T, CHUNK, ALLOC> &s);
+
+  // The move constructor takes over the chunks of <s> in O(1) and
+  // leaves <s> empty.  Pointers to the elements stay valid.
+  Segmented_Array (Segmented_Array<T, CHUNK, ALLOC> &&s) noexcept;
+
+  // Assignment operator with "strong exception guarantee" semantics.
+  Segmented_Array<T, CHUNK, ALLOC> &operator= (const Segmented_Array<T, CHUNK, ALLOC> &s);
+
+  // Move assignment releases our chunks and takes over those of <s>.
+  // If <ALLOC> doesn't propagate on move assignment and the allocators
+  // differ, the elements are moved one by one instead.
+  Segmented_Array<T, CHUNK, ALLOC> &operator= (Segmented_Array<T, CHUNK, ALLOC> &&s);
+
+  // Destroy the elements and release the chunks.
+  ~Segmented_Array (void);
+
+  iterator begin (void);
+  const_iterator begin (void) const;
+  iterator end (void);
+  const_iterator end (void) const;
+
+  // = Set/get methods.
+
+  // Set an item in the array at location index, growing the array if
+  // <index> >= size().  Throws <std::bad_alloc> if growing fails.
+  void set (const T &new_item, size_t index);
+  void set (T &&new_item, size_t index);
+
+  // Build a new item in the array at location index from <args>,
+  // growing the array as <set> does.  Returns a reference to the new
+  // item.
+  template <typename... ARGS>
+  T &emplace (size_t index, ARGS &&... args);
+
+  // Get an item in the array at location index.  Throws
+  // <std::out_of_range> if index is not <in_range>.
+  void get (T &item, size_t index) const;
+
+  // Returns the current size of the array.
+  size_t size (void) const;
+
+  // Returns how many elements fit in the chunks allocated so far.
+  size_t capacity (void) const;
+
+  // Element access, checked only if ARRAY_BOUNDS_CHECK is enabled.
+  const T &operator[] (size_t index) const;
+  T &operator[] (size_t index);
+
+  // Element access that always throws <std::out_of_range> if <index>
+  // is not <in_range>.
+  const T &at (size_t index) const;
+  T &at (size_t index);
+
+  // Compare this array with <s> for (in)equality.
+  bool operator== (const Segmented_Array<T, CHUNK, ALLOC> &s) const;
+  bool operator!= (const Segmented_Array<T, CHUNK, ALLOC> &s) const;
+
+  // Change the size of the array to <new_size> elements, initializing
+  // new elements to the default value if one was given.  Only ever
+  // adds chunks, so no element moves.  Throws <std::bad_alloc> if
+  // allocation fails, in which case the size is unchanged.
+  void resize (size_t new_size);
+
+  // Allocate chunks until the array can hold <new_capacity> elements.
+  void reserve (size_t new_capacity);
+
+  // Release the chunks past the one holding the last element.
+  void shrink_to_fit (void);
+
+  // Swap the contents of this array with <new_array> in O(1).  Does
+  // not throw.  Unless <ALLOC> propagates on swap, the two arrays'
+  // allocators must compare equal.
+  void swap (Segmented_Array<T, CHUNK, ALLOC> &new_array);
+
+  // Returns a copy of the allocator used for the chunks.
+  ALLOC get_allocator (void) const;
+
+  // = Chunk access, e.g., for bulk processing of contiguous runs.
+
+  // Returns the number of elements in a chunk.
+  static constexpr size_t chunk_size (void) { return CHUNK; }
+
+  // Returns the number of chunks allocated.
+  size_t chunks (void) const;
+
+  // Returns the first element of chunk <n>, which holds the elements
+  // [<n> * chunk_size (), (<n> + 1) * chunk_size ()).
+  T *chunk (size_t n);
+  const T *chunk (size_t n) const;
+
+private:
+  static constexpr unsigned SHIFT = std::countr_zero (CHUNK);
+
+  // Returns the element at <index>, without checking it.
+  T &element (size_t index) const;
+
+  // Returns true if <index> is within range.
+  bool in_range (size_t index) const;
+
+  // Call <f> (first, last) for each run [first, last) of elements in
+  // one chunk that make up the positions [<begin>, <end>).
+  template <typename F>
+  void for_each_run (size_t begin, size_t end, F f) const;
+
+  // Initialize the positions [<cur_size_>, <new_size>), which must
+  // already have chunks, with <default_value_> or by default
+  // construction.  Destroys those it built if one throws.
+  void construct_to (size_t new_size);
+
+  // Destroy the elements and release the chunks.
+  void release (void);
+
+  // Allocator for the chunks.
+  [[no_unique_address]] ALLOC alloc_;
+
+  // Pointers to the chunks, in order.
+  Array<T *, DIRECTORY_ALLOC> chunks_;
+
+  // Current size of the array.
+  size_t cur_size_;
+
+  // If a default value is needed, keep track of its value.
+  std::optional<T> default_value_;
+};
+
+#include "Segmented_Array.cpp"
+
+#endif /* SEGMENTED_ARRAY_H */
@@ -0,0 +1,367 @@
+#ifndef SMALL_ARRAY_CPP
+#define SMALL_ARRAY_CPP
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "Small_Array.h"
+
+template <typename T, size_t N, typename ALLOC> 
+Small_Array<T, N, ALLOC>::Small_Array (size_t size,
+				       const Array_Growth_Policy &growth,
+				       const ALLOC &alloc) : alloc_ (alloc), ptr_ (inline_buffer ()), max_size_ (N), cur_size_ (0), growth_ (growth)
+{
+	reserve (size);
+	try {
+		Array_Ops<T, ALLOC>::default_construct (alloc_, ptr_, ptr_+size);
+	}
+	catch (...) {
+		// The destructor won't run, so give back any heap buffer.
+		release ();
+		throw;
+	}
+	cur_size_ = size;
+}
+
+template <typename T, size_t N, typename ALLOC> 
+Small_Array<T, N, ALLOC>::Small_Array (size_t size,
+				       const ALLOC &alloc) : Small_Array (size, Array_Growth_Policy (), alloc)
+{
+}
+
+template <typename T, size_t N, typename ALLOC> 
+Small_Array<T, N, ALLOC>::Small_Array (size_t size,
+				       const T &default_value,
+				       const Array_Growth_Policy &growth,
+				       const ALLOC &alloc) : alloc_ (alloc), ptr_ (inline_buffer ()), max_size_ (N), cur_size_ (0), default_value_ (default_value), growth_ (growth)
+{
+	reserve (size);
+	try {
+		Array_Ops<T, ALLOC>::fill_construct (alloc_, ptr_, ptr_+size, default_value);
+	}
+	catch (...) {
+		// The destructor won't run, so give back any heap buffer.
+		release ();
+		throw;
+	}
+	cur_size_ = size;
+}
+
+template <typename T, size_t N, typename ALLOC> 
+Small_Array<T, N, ALLOC>::Small_Array (const Small_Array<T, N, ALLOC> &s) : alloc_ (traits::select_on_container_copy_construction (s.alloc_)), ptr_ (inline_buffer ()), max_size_ (N), cur_size_ (0), default_value_ (s.default_value_), growth_ (s.growth_)
+{
+	reserve (s.cur_size_);
+	try {
+		Array_Ops<T, ALLOC>::copy_construct (alloc_, s.ptr_, s.ptr_+s.cur_size_, ptr_);
+	}
+	catch (...) {
+		// The destructor won't run, so give back any heap buffer.
+		release ();
+		throw;
+	}
+	cur_size_ = s.cur_size_;
+}
+
+template <typename T, size_t N, typename ALLOC> 
+Small_Array<T, N, ALLOC>::Small_Array (Small_Array<T, N, ALLOC> &&s)
+  noexcept (std::is_nothrow_move_constructible<T>::value) : alloc_ (s.alloc_), ptr_ (inline_buffer ()), max_size_ (N), cur_size_ (0), growth_ (s.growth_)
+{
+	steal (s);
+}
+
+template <typename T, size_t N, typename ALLOC> Small_Array<T, N, ALLOC> &
+Small_Array<T, N, ALLOC>::operator= (const Small_Array<T, N, ALLOC> &s)
+{
+	if (this == &s) return *this;
+	Small_Array<T, N, ALLOC> temp (s);
+	swap (temp);
+	return *this;
+}
+
+template <typename T, size_t N, typename ALLOC> Small_Array<T, N, ALLOC> &
+Small_Array<T, N, ALLOC>::operator= (Small_Array<T, N, ALLOC> &&s)
+  noexcept (std::is_nothrow_move_constructible<T>::value
+	    && (std::allocator_traits<ALLOC>::is_always_equal::value
+		|| std::allocator_traits<ALLOC>::propagate_on_container_move_assignment::value))
+{
+	if (this == &s) return *this;
+	release ();
+	if constexpr (traits::propagate_on_container_move_assignment::value)
+		alloc_ = s.alloc_;
+	growth_ = s.growth_;
+	steal (s);
+	return *this;
+}
+
+template <typename T, size_t N, typename ALLOC> 
+Small_Array<T, N, ALLOC>::~Small_Array (void)
+{
+	release ();
+}
+
+template <typename T, size_t N, typename ALLOC> void
+Small_Array<T, N, ALLOC>::steal (Small_Array<T, N, ALLOC> &s)
+{
+	default_value_ = std::move (s.default_value_);
+	s.default_value_.reset ();
+
+	// A heap buffer can only be taken over if our allocator can
+	// release it.
+	if (s.is_inline ()
+	    || !(traits::is_always_equal::value || alloc_ == s.alloc_)) {
+		reserve (s.cur_size_);
+		Array_Ops<T, ALLOC>::relocate (alloc_, s.ptr_, s.ptr_+s.cur_size_, ptr_);
+		cur_size_ = s.cur_size_;
+		s.release ();
+	}
+	else {
+		ptr_ = s.ptr_;
+		max_size_ = s.max_size_;
+		cur_size_ = s.cur_size_;
+		s.ptr_ = s.inline_buffer ();
+		s.max_size_ = N;
+		s.cur_size_ = 0;
+	}
+}
+
+template <typename T, size_t N, typename ALLOC> void
+Small_Array<T, N, ALLOC>::release (void)
+{
+	Array_Ops<T, ALLOC>::destroy (alloc_, ptr_, ptr_+cur_size_);
+	if (!is_inline ())
+		traits::deallocate (alloc_, ptr_, max_size_);
+	ptr_ = inline_buffer ();
+	max_size_ = N;
+	cur_size_ = 0;
+}
+
+template <typename T, size_t N, typename ALLOC> void
+Small_Array<T, N, ALLOC>::reallocate (size_t new_capacity)
+{
+	new_capacity = std::max (new_capacity, N);
+	if (new_capacity == max_size_) return;
+
+	const bool spill = new_capacity > N;
+	scoped_array<T, ALLOC> new_array (spill ? new_capacity : size_t (0), alloc_);
+	T *dest = spill ? new_array.get () : inline_buffer ();
+
+	Array_Ops<T, ALLOC>::relocate (alloc_, ptr_, ptr_+cur_size_, dest);
+	Array_Ops<T, ALLOC>::destroy (alloc_, ptr_, ptr_+cur_size_);
+	if (!is_inline ())
+		traits::deallocate (alloc_, ptr_, max_size_);
+
+	ptr_ = spill ? new_array.release () : dest;
+	max_size_ = new_capacity;
+}
+
+template <typename T, size_t N, typename ALLOC> void
+Small_Array<T, N, ALLOC>::resize (size_t new_size)
+{
+	if (new_size == cur_size_) return;
+	else if (new_size < cur_size_) {
+		Array_Ops<T, ALLOC>::destroy (alloc_, ptr_+new_size, ptr_+cur_size_);
+		cur_size_ = new_size;
+	}
+	else {
+		if (new_size > max_size_)
+			reallocate (growth_.next_capacity (max_size_, new_size));
+		if (default_value_)
+			Array_Ops<T, ALLOC>::fill_construct (alloc_, ptr_+cur_size_, ptr_+new_size, *default_value_);
+		else
+			Array_Ops<T, ALLOC>::default_construct (alloc_, ptr_+cur_size_, ptr_+new_size);
+		cur_size_ = new_size;
+	}
+}
+
+template <typename T, size_t N, typename ALLOC> void
+Small_Array<T, N, ALLOC>::reserve (size_t new_capacity)
+{
+	if (new_capacity > max_size_)
+		reallocate (new_capacity);
+}
+
+template <typename T, size_t N, typename ALLOC> void
+Small_Array<T, N, ALLOC>::shrink_to_fit (void)
+{
+	if (!is_inline ())
+		reallocate (cur_size_);
+}
+
+template <typename T, size_t N, typename ALLOC> void
+Small_Array<T, N, ALLOC>::swap (Small_Array<T, N, ALLOC> &new_array)
+{
+	Small_Array<T, N, ALLOC> temp (std::move (new_array));
+	new_array = std::move (*this);
+	*this = std::move (temp);
+}
+
+template <typename T, size_t N, typename ALLOC> template <typename... ARGS> T &
+Small_Array<T, N, ALLOC>::construct_past_end (size_t index, ARGS &&... args)
+{
+	if (index >= max_size_) {
+		// <args> may refer to one of our own elements, so build the
+		// item before the old buffer goes away.
+		T item (std::forward<ARGS> (args)...);
+		reallocate (growth_.next_capacity (max_size_, index+1));
+		resize (index);
+		traits::construct (alloc_, ptr_+index, std::move (item));
+	}
+	else {
+		resize (index);
+		traits::construct (alloc_, ptr_+index, std::forward<ARGS> (args)...);
+	}
+	cur_size_ = index+1;
+	return ptr_[index];
+}
+
+template <typename T, size_t N, typename ALLOC> void
+Small_Array<T, N, ALLOC>::set (const T &new_item, size_t index)
+{
+	if (index >= cur_size_)
+		construct_past_end (index, new_item);
+	else
+		ptr_[index] = new_item;
+}
+
+template <typename T, size_t N, typename ALLOC> void
+Small_Array<T, N, ALLOC>::set (T &&new_item, size_t index)
+{
+	if (index >= cur_size_)
+		construct_past_end (index, std::move (new_item));
+	else
+		ptr_[index] = std::move (new_item);
+}
+
+template <typename T, size_t N, typename ALLOC> template <typename... ARGS> T &
+Small_Array<T, N, ALLOC>::emplace (size_t index, ARGS &&... args)
+{
+	if (index >= cur_size_)
+		return construct_past_end (index, std::forward<ARGS> (args)...);
+	ptr_[index] = T (std::forward<ARGS> (args)...);
+	return ptr_[index];
+}
+
+template <typename T, size_t N, typename ALLOC> void
+Small_Array<T, N, ALLOC>::get (T &item, size_t index)
+{
+	if (index >= cur_size_) throw std::out_of_range("Index out of range");
+	item = ptr_[index];
+}
+
+template <typename T, size_t N, typename ALLOC> bool
+Small_Array<T, N, ALLOC>::operator== (const Small_Array<T, N, ALLOC> &s) const
+{
+	return cur_size_ == s.cur_size_ && Array_Ops<T, ALLOC>::elements_equal (ptr_, s.ptr_, cur_size_);
+}
+
+template <typename T, size_t N, typename ALLOC> bool
+Small_Array<T, N, ALLOC>::operator!= (const Small_Array<T, N, ALLOC> &s) const
+{
+	return !(*this == s);
+}
+
+// = Accessors.
+
+template <typename T, size_t N, typename ALLOC> inline ALLOC
+Small_Array<T, N, ALLOC>::get_allocator (void) const
+{
+	return alloc_;
+}
+
+template <typename T, size_t N, typename ALLOC> inline T *
+Small_Array<T, N, ALLOC>::inline_buffer (void)
+{
+	return reinterpret_cast<T *> (buffer_);
+}
+
+template <typename T, size_t N, typename ALLOC> inline bool
+Small_Array<T, N, ALLOC>::is_inline (void) const
+{
+	return ptr_ == reinterpret_cast<const T *> (buffer_);
+}
+
+template <typename T, size_t N, typename ALLOC> inline size_t
+Small_Array<T, N, ALLOC>::size (void) const
+{
+	return cur_size_;
+}
+
+template <typename T, size_t N, typename ALLOC> inline size_t
+Small_Array<T, N, ALLOC>::capacity (void) const
+{
+	return max_size_;
+}
+
+template <typename T, size_t N, typename ALLOC> inline bool
+Small_Array<T, N, ALLOC>::in_range (size_t index) const
+{
+	return index < cur_size_;
+}
+
+template <typename T, size_t N, typename ALLOC> inline T &
+Small_Array<T, N, ALLOC>::operator[] (size_t index)
+{
+	if (ARRAY_BOUNDS_CHECK && !in_range(index)) throw std::out_of_range("Value out of range");
+	return ptr_[index];
+}
+
+template <typename T, size_t N, typename ALLOC> inline const T &
+Small_Array<T, N, ALLOC>::operator[] (size_t index) const
+{
+	if (ARRAY_BOUNDS_CHECK && !in_range(index)) throw std::out_of_range("Value out of range");
+	return ptr_[index];
+}
+
+template <typename T, size_t N, typename ALLOC> inline T &
+Small_Array<T, N, ALLOC>::at (size_t index)
+{
+	if (!in_range(index)) throw std::out_of_range("Value out of range");
+	return ptr_[index];
+}
+
+template <typename T, size_t N, typename ALLOC> inline const T &
+Small_Array<T, N, ALLOC>::at (size_t index) const
+{
+	if (!in_range(index)) throw std::out_of_range("Value out of range");
+	return ptr_[index];
+}
+
+template <typename T, size_t N, typename ALLOC> inline T *
+Small_Array<T, N, ALLOC>::data (void)
+{
+	return ptr_;
+}
+
+template <typename T, size_t N, typename ALLOC> inline const T *
+Small_Array<T, N, ALLOC>::data (void) const
+{
+	return ptr_;
+}
+
+template <typename T, size_t N, typename ALLOC> inline typename Small_Array<T, N, ALLOC>::iterator
+Small_Array<T, N, ALLOC>::begin (void)
+{
+	return iterator (ptr_);
+}
+
+template <typename T, size_t N, typename ALLOC> inline typename Small_Array<T, N, ALLOC>::iterator
+Small_Array<T, N, ALLOC>::end (void)
+{
+	return iterator (ptr_+cur_size_);
+}
+
+template <typename T, size_t N, typename ALLOC> inline typename Small_Array<T, N, ALLOC>::const_iterator
+Small_Array<T, N, ALLOC>::begin (void) const
+{
+	return const_iterator (ptr_);
+}
+
+template <typename T, size_t N, typename ALLOC> inline typename Small_Array<T, N, ALLOC>::const_iterator
+Small_Array<T, N, ALLOC>::end (void) const
+{
+	return const_iterator (ptr_+cur_size_);
+}
+
+#endif /* SMALL_ARRAY_CPP */
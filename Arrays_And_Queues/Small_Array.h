@@ -0,0 +1,194 @@
+/* -*- C++ -*- */
+
+#ifndef SMALL_ARRAY_H
+#define SMALL_ARRAY_H
+
+#include "Array.h"
+#include "Array_Ops.h"
+
+/**
+ * @class Small_Array
+ * @brief Implements a vector that resizes and keeps up to <N> elements
+ *        inline, without touching the heap.
+ *
+ * Small_Array has the same interface as <Array>, so it can be used
+ * wherever an <Array> is expected, e.g., as the ARRAY parameter of
+ * <AQueue>.  Only when it has to hold more than <N> elements does it
+ * spill its contents to a heap buffer.  Note that unlike <Array>,
+ * moving a Small_Array whose elements are inline moves each element,
+ * and iterators are invalidated by moves and swaps.  Heap buffers are
+ * obtained from an allocator of type <ALLOC>, which is propagated like
+ * the standard containers do.
+ */
+template <typename T, size_t N, typename ALLOC = std::allocator<T> >
+class Small_Array
+{
+  static_assert (N > 0, "Small_Array needs room for at least one element");
+
+public:
+  // Define a "trait"
+  typedef T value_type;
+  typedef ALLOC allocator_type;
+
+  // = Initialization and termination methods.
+
+  // Create an uninitialized array.  Allocates only if <size> > <N>.
+  // Throws <std::bad_alloc> if allocation fails.
+  Small_Array (size_t size,
+               const Array_Growth_Policy &growth = Array_Growth_Policy (),
+               const ALLOC &alloc = ALLOC ());
+
+  // Create an uninitialized array whose heap buffers, if any, come
+  // from <alloc>.
+  Small_Array (size_t size, const ALLOC &alloc);
+
+  // Initialize the entire array to the <default_value>.  Allocates
+  // only if <size> > <N>.  Throws <std::bad_alloc> if allocation fails.
+  Small_Array (size_t size,
+               const T &default_value,
+               const Array_Growth_Policy &growth = Array_Growth_Policy (),
+               const ALLOC &alloc = ALLOC ());
+
+  // The copy constructor makes an exact copy of <s>.  Throws
+  // <std::bad_alloc> if allocation fails.
+  Small_Array (const Small_Array<T, N, ALLOC> &s);
+
+  // The move constructor takes over the heap buffer of <s> in O(1), or
+  // moves its inline elements one by one, and leaves <s> empty.
+  Small_Array (Small_Array<T, N, ALLOC> &&s)
+    noexcept (std::is_nothrow_move_constructible<T>::value);
+
+  // Assignment operator with "strong exception guarantee" semantics.
+  Small_Array<T, N, ALLOC> &operator= (const Small_Array<T, N, ALLOC> &s);
+
+  // Move assignment releases our storage and takes over that of <s>.
+  Small_Array<T, N, ALLOC> &operator= (Small_Array<T, N, ALLOC> &&s)
+    noexcept (std::is_nothrow_move_constructible<T>::value
+              && (std::allocator_traits<ALLOC>::is_always_equal::value
+                  || std::allocator_traits<ALLOC>::propagate_on_container_move_assignment::value));
+
+  // Destroy the elements and release any heap buffer.
+  ~Small_Array (void);
+
+  // = Random access iterator definitions
+  typedef Array_Iterator<T> iterator;
+  typedef Const_Array_Iterator<T> const_iterator;
+
+  iterator begin (void);
+  const_iterator begin (void) const;
+  iterator end (void);
+  const_iterator end (void) const;
+
+  // Get a pointer to the first element of the array.
+  T *data (void);
+  const T *data (void) const;
+
+  // = Set/get methods.
+
+  // Set an item in the array at location index, resizing the array if
+  // <index> >= size().  Throws <std::bad_alloc> if resizing fails.
+  void set (const T &new_item, size_t index);
+  void set (T &&new_item, size_t index);
+
+  // Build a new item in the array at location index from <args>.
+  template <typename... ARGS>
+  T &emplace (size_t index, ARGS &&... args);
+
+  // Get an item in the array at location index.  Throws
+  // <std::out_of_range> if index is not <in_range>.
+  void get (T &item, size_t index);
+
+  // Returns the current size of the array.
+  size_t size (void) const;
+
+  // Returns how many elements fit before the next reallocation; never
+  // less than <N>.
+  size_t capacity (void) const;
+
+  // Returns true if the elements are stored inline.
+  bool is_inline (void) const;
+
+  // Element access, checked only if ARRAY_BOUNDS_CHECK is enabled.
+  const T &operator[] (size_t index) const;
+  T &operator[] (size_t index);
+
+  // Element access that always throws <std::out_of_range> if <index>
+  // is not <in_range>.
+  const T &at (size_t index) const;
+  T &at (size_t index);
+
+  // Compare this array with <s> for (in)equality.
+  bool operator== (const Small_Array<T, N, ALLOC> &s) const;
+  bool operator!= (const Small_Array<T, N, ALLOC> &s) const;
+
+  // Change the size of the array to be at least <new_size> elements,
+  // initializing new elements to the default value if one was given.
+  // Throws <std::bad_alloc> if allocation fails.
+  void resize (size_t new_size);
+
+  // Make sure the array can hold <new_capacity> elements without
+  // reallocating.
+  void reserve (size_t new_capacity);
+
+  // Release any capacity beyond size(), moving the elements back inline
+  // if they fit.
+  void shrink_to_fit (void);
+
+  // Swap the contents of this array with <new_array>.  Does not throw
+  // unless moving a <T> throws.
+  void swap (Small_Array<T, N, ALLOC> &new_array);
+
+  // Returns a copy of the allocator used for heap buffers.
+  ALLOC get_allocator (void) const;
+
+private:
+  typedef std::allocator_traits<ALLOC> traits;
+
+  // Returns true if <index> is within range.
+  bool in_range (size_t index) const;
+
+  // Returns the start of the inline buffer.
+  T *inline_buffer (void);
+
+  // Move the live elements to a buffer of <new_capacity> elements,
+  // which is the inline buffer if <new_capacity> <= <N>.
+  void reallocate (size_t new_capacity);
+
+  // Build a new item at location <index> >= <cur_size_>.
+  template <typename... ARGS>
+  T &construct_past_end (size_t index, ARGS &&... args);
+
+  // Take over the contents of <s>, leaving it empty.  Our own storage
+  // must not hold any elements or heap buffer.  Heap buffers from an
+  // unequal allocator are copied rather than taken over.
+  void steal (Small_Array<T, N, ALLOC> &s);
+
+  // Destroy the elements and release any heap buffer.
+  void release (void);
+
+  // Allocator for heap buffers.
+  [[no_unique_address]] ALLOC alloc_;
+
+  // Points either to <buffer_> or to a heap buffer of <max_size_>
+  // elements.
+  T *ptr_;
+
+  // Number of elements <ptr_> has room for.
+  size_t max_size_;
+
+  // Current size of the array.
+  size_t cur_size_;
+
+  // If a default value is needed, keep track of its value.
+  std::optional<T> default_value_;
+
+  // Decides the new <max_size_> whenever the array must grow.
+  Array_Growth_Policy growth_;
+
+  // Inline storage for up to <N> elements.
+  alignas (T) unsigned char buffer_[N * sizeof (T)];
+};
+
+#include "Small_Array.cpp"
+
+#endif /* SMALL_ARRAY_H */
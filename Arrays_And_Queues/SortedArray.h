@@ -0,0 +1,379 @@
+/* -*- C++ -*- */
+
+#ifndef SORTED_ARRAY_H
+#define SORTED_ARRAY_H
+
+#include <stdlib.h>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include "Array.h"
+
+/**
+ * @class SortedArray
+ * @brief Implements a set of unique <T>s kept sorted by <COMPARE> in
+ *        one contiguous <Array>.
+ *
+ * Lookups are binary searches over contiguous storage, so they touch
+ * far fewer cache lines than a node-based std::set.  Inserting or
+ * erasing a single element shifts the elements after it, so tables
+ * should be built in bulk: the range constructor and <assign> sort and
+ * deduplicate their input once, and the range <insert> merges a batch
+ * of k new elements in one O(n + k log k) pass.  Lookups accept any
+ * key <COMPARE> can compare with a <T>.  Elements are only reachable
+ * through const iterators and references, since changing one could
+ * break the order.
+ */
+template <typename T, typename COMPARE = std::less<T> >
+class SortedArray
+{
+public:
+  // Define a "trait"
+  typedef T value_type;
+  typedef COMPARE value_compare;
+
+  // = Random access iterator definitions.  Only const iterators are
+  // provided.
+  typedef Const_Array_Iterator<T> iterator;
+  typedef Const_Array_Iterator<T> const_iterator;
+
+  // = Initialization methods.
+
+  // Create an empty set.
+  explicit SortedArray (const COMPARE &compare = COMPARE ());
+
+  // Build a set from the elements in [<first>, <last>), which needn't
+  // be sorted or unique; of equal elements the first is kept.  Throws
+  // <std::bad_alloc> if allocation fails.
+  template <typename ITER>
+  SortedArray (ITER first, ITER last, const COMPARE &compare = COMPARE ());
+
+  // Replace the contents of the set with the elements in [<first>,
+  // <last>), as the constructor above does.
+  template <typename ITER>
+  void assign (ITER first, ITER last);
+
+  const_iterator begin (void) const;
+  const_iterator end (void) const;
+
+  // Get a pointer to the first (smallest) element.
+  const T *data (void) const;
+
+  // = Lookup methods.
+
+  // Returns an iterator to the element equivalent to <key>, or end ()
+  // if there is none.
+  template <typename K>
+  const_iterator find (const K &key) const;
+
+  // Returns true if the set holds an element equivalent to <key>.
+  template <typename K>
+  bool contains (const K &key) const;
+
+  // Returns the first element not less than (greater than) <key>.
+  template <typename K>
+  const_iterator lower_bound (const K &key) const;
+  template <typename K>
+  const_iterator upper_bound (const K &key) const;
+
+  // = Modifiers.
+
+  // Insert <item> unless an equivalent element is already present.
+  // Returns the position of the element equivalent to <item> and true
+  // if it was inserted.  Costs O(n) moves.
+  std::pair<const_iterator, bool> insert (const T &item);
+
+  // Insert the elements in [<first>, <last>) that aren't present yet,
+  // in one merge pass: the batch is sorted and deduplicated, then
+  // merged in from the back so every element moves at most once.
+  // Throws <std::bad_alloc> if allocation fails.
+  template <typename ITER>
+  void insert (ITER first, ITER last);
+
+  // Erase the element equivalent to <key>.  Returns the number of
+  // elements erased (0 or 1).
+  template <typename K>
+  size_t erase (const K &key);
+
+  // Erase the element at <pos>.
+  void erase (const_iterator pos);
+
+  // Remove all the elements, keeping the capacity.
+  void clear (void);
+
+  // = Set/get methods, as for <Array> but read only.
+
+  // Get the item at location index.  Throws <std::out_of_range> if
+  // index is out of range.
+  void get (T &item, size_t index) const;
+
+  // Returns the number of elements.
+  size_t size (void) const;
+
+  // Returns true if the set is empty.
+  bool empty (void) const;
+
+  // Returns how many elements fit before the storage grows.
+  size_t capacity (void) const;
+
+  // Element access, checked only if ARRAY_BOUNDS_CHECK is enabled.
+  const T &operator[] (size_t index) const;
+
+  // Element access that always throws <std::out_of_range> if <index>
+  // is out of range.
+  const T &at (size_t index) const;
+
+  // Compare this set with <s> for (in)equality.
+  bool operator== (const SortedArray<T, COMPARE> &s) const;
+  bool operator!= (const SortedArray<T, COMPARE> &s) const;
+
+  // Make sure the set can hold <new_capacity> elements without
+  // reallocating.
+  void reserve (size_t new_capacity);
+
+  // Swap the contents of this set with <s>.  Does not throw.
+  void swap (SortedArray<T, COMPARE> &s);
+
+  // Returns the comparison object.
+  COMPARE value_comp (void) const;
+
+private:
+  // Sort the elements and drop all but the first of each run of
+  // equivalent ones.
+  void sort_unique (Array<T> &items) const;
+
+  // Orders the elements.
+  [[no_unique_address]] COMPARE compare_;
+
+  // The elements, sorted and unique.
+  Array<T> items_;
+};
+
+template <typename T, typename COMPARE>
+SortedArray<T, COMPARE>::SortedArray (const COMPARE &compare) : compare_ (compare), items_ (0)
+{
+}
+
+template <typename T, typename COMPARE> template <typename ITER>
+SortedArray<T, COMPARE>::SortedArray (ITER first,
+				      ITER last,
+				      const COMPARE &compare) : compare_ (compare), items_ (0)
+{
+	assign (first, last);
+}
+
+template <typename T, typename COMPARE> void
+SortedArray<T, COMPARE>::sort_unique (Array<T> &items) const
+{
+	// Stable, so the first of equivalent elements survives.
+	std::stable_sort (items.begin (), items.end (), compare_);
+	typename Array<T>::iterator last
+		= std::unique (items.begin (), items.end (),
+			       [this] (const T &a, const T &b) { return !compare_ (a, b); });
+	items.resize (last - items.begin ());
+}
+
+template <typename T, typename COMPARE> template <typename ITER> void
+SortedArray<T, COMPARE>::assign (ITER first, ITER last)
+{
+	Array<T> items (0);
+	items.assign (first, last);
+	sort_unique (items);
+	items_.swap (items);
+}
+
+template <typename T, typename COMPARE> typename SortedArray<T, COMPARE>::const_iterator
+SortedArray<T, COMPARE>::begin (void) const
+{
+	return items_.begin ();
+}
+
+template <typename T, typename COMPARE> typename SortedArray<T, COMPARE>::const_iterator
+SortedArray<T, COMPARE>::end (void) const
+{
+	return items_.end ();
+}
+
+template <typename T, typename COMPARE> const T *
+SortedArray<T, COMPARE>::data (void) const
+{
+	return items_.data ();
+}
+
+// = Lookup methods.
+
+template <typename T, typename COMPARE> template <typename K> typename SortedArray<T, COMPARE>::const_iterator
+SortedArray<T, COMPARE>::lower_bound (const K &key) const
+{
+	return std::lower_bound (begin (), end (), key, compare_);
+}
+
+template <typename T, typename COMPARE> template <typename K> typename SortedArray<T, COMPARE>::const_iterator
+SortedArray<T, COMPARE>::upper_bound (const K &key) const
+{
+	return std::upper_bound (begin (), end (), key, compare_);
+}
+
+template <typename T, typename COMPARE> template <typename K> typename SortedArray<T, COMPARE>::const_iterator
+SortedArray<T, COMPARE>::find (const K &key) const
+{
+	const_iterator i = lower_bound (key);
+	return i != end () && !compare_ (key, *i) ? i : end ();
+}
+
+template <typename T, typename COMPARE> template <typename K> bool
+SortedArray<T, COMPARE>::contains (const K &key) const
+{
+	return find (key) != end ();
+}
+
+// = Modifiers.
+
+template <typename T, typename COMPARE> std::pair<typename SortedArray<T, COMPARE>::const_iterator, bool>
+SortedArray<T, COMPARE>::insert (const T &item)
+{
+	const size_t pos = lower_bound (item) - begin ();
+	if (pos < items_.size () && !compare_ (item, items_[pos]))
+		return std::make_pair (begin () + pos, false);
+
+	// <item> may not survive the array growing, so copy it first.
+	T copy (item);
+	const size_t old_size = items_.size ();
+	items_.resize (old_size+1);
+	T *p = items_.data ();
+	std::move_backward (p+pos, p+old_size, p+old_size+1);
+	p[pos] = std::move (copy);
+	return std::make_pair (begin () + pos, true);
+}
+
+template <typename T, typename COMPARE> template <typename ITER> void
+SortedArray<T, COMPARE>::insert (ITER first, ITER last)
+{
+	Array<T> batch (0);
+	batch.assign (first, last);
+	sort_unique (batch);
+
+	// Drop the elements we already have, in one linear pass over both.
+	const size_t n = items_.size ();
+	size_t kept = 0;
+	for (size_t i = 0, j = 0; j < batch.size (); ++j) {
+		while (i < n && compare_ (items_[i], batch[j]))
+			++i;
+		if (i < n && !compare_ (batch[j], items_[i]))
+			continue;
+		if (kept != j)
+			batch[kept] = std::move (batch[j]);
+		++kept;
+	}
+	if (kept == 0) return;
+
+	// Merge from the back, so each element moves once and nothing
+	// not yet merged is overwritten.
+	items_.resize (n + kept);
+	T *p = items_.data ();
+	size_t i = n, j = kept, out = n + kept;
+	while (j > 0) {
+		if (i > 0 && compare_ (batch[j-1], p[i-1]))
+			p[--out] = std::move (p[--i]);
+		else
+			p[--out] = std::move (batch[--j]);
+	}
+}
+
+template <typename T, typename COMPARE> template <typename K> size_t
+SortedArray<T, COMPARE>::erase (const K &key)
+{
+	const_iterator i = find (key);
+	if (i == end ()) return 0;
+	erase (i);
+	return 1;
+}
+
+template <typename T, typename COMPARE> void
+SortedArray<T, COMPARE>::erase (const_iterator pos)
+{
+	T *p = items_.data ();
+	const size_t index = pos - begin ();
+	std::move (p+index+1, p+items_.size (), p+index);
+	items_.resize (items_.size ()-1);
+}
+
+template <typename T, typename COMPARE> void
+SortedArray<T, COMPARE>::clear (void)
+{
+	items_.resize (0);
+}
+
+// = Set/get methods.
+
+template <typename T, typename COMPARE> void
+SortedArray<T, COMPARE>::get (T &item, size_t index) const
+{
+	if (index >= items_.size ()) throw std::out_of_range("Index out of range");
+	item = items_[index];
+}
+
+template <typename T, typename COMPARE> size_t
+SortedArray<T, COMPARE>::size (void) const
+{
+	return items_.size ();
+}
+
+template <typename T, typename COMPARE> bool
+SortedArray<T, COMPARE>::empty (void) const
+{
+	return items_.size () == 0;
+}
+
+template <typename T, typename COMPARE> size_t
+SortedArray<T, COMPARE>::capacity (void) const
+{
+	return items_.capacity ();
+}
+
+template <typename T, typename COMPARE> const T &
+SortedArray<T, COMPARE>::operator[] (size_t index) const
+{
+	return items_[index];
+}
+
+template <typename T, typename COMPARE> const T &
+SortedArray<T, COMPARE>::at (size_t index) const
+{
+	return items_.at (index);
+}
+
+template <typename T, typename COMPARE> bool
+SortedArray<T, COMPARE>::operator== (const SortedArray<T, COMPARE> &s) const
+{
+	return items_ == s.items_;
+}
+
+template <typename T, typename COMPARE> bool
+SortedArray<T, COMPARE>::operator!= (const SortedArray<T, COMPARE> &s) const
+{
+	return !(*this == s);
+}
+
+template <typename T, typename COMPARE> void
+SortedArray<T, COMPARE>::reserve (size_t new_capacity)
+{
+	items_.reserve (new_capacity);
+}
+
+template <typename T, typename COMPARE> void
+SortedArray<T, COMPARE>::swap (SortedArray<T, COMPARE> &s)
+{
+	std::swap (compare_, s.compare_);
+	items_.swap (s.items_);
+}
+
+template <typename T, typename COMPARE> COMPARE
+SortedArray<T, COMPARE>::value_comp (void) const
+{
+	return compare_;
+}
+
+#endif /* SORTED_ARRAY_H */
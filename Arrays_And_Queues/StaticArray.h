@@ -0,0 +1,260 @@
+/* -*- C++ -*- */
+
+#ifndef STATIC_ARRAY_H
+#define STATIC_ARRAY_H
+
+#include <stdlib.h>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include "Array.h"
+
+/**
+ * @class StaticArray
+ * @brief Implements a fixed-size array of exactly <N> elements stored
+ *        inline, with the interface of <Array>.
+ *
+ * A StaticArray never allocates, and all of its operations are
+ * constexpr, so one can be built and used in constant expressions.
+ * Its size is part of its type: <size> is a static constexpr function,
+ * so, e.g., an AQueue<T, StaticArray<T, 11> > holds 10 items without
+ * touching the heap and the compiler folds every queue_.size()-1.  The
+ * constructors take a size only so StaticArray can stand in for
+ * <Array>; it must be <N>.  Writing past the end throws rather than
+ * growing.  Iterators are plain pointers.
+ */
+template <typename T, size_t N>
+class StaticArray
+{
+  static_assert (N > 0, "StaticArray needs room for at least one element");
+
+public:
+  // Define a "trait"
+  typedef T value_type;
+
+  // = Initialization methods.  Copying, moving and destruction are
+  // those of the elements.
+
+  // Value-initialize the elements (e.g., to 0 for arithmetic types).
+  // Throws <std::length_error> if <size> isn't <N>.
+  constexpr explicit StaticArray (size_t size = N);
+
+  // Initialize all the elements to the <default_value>.  Throws
+  // <std::length_error> if <size> isn't <N>.
+  constexpr StaticArray (size_t size, const T &default_value);
+
+  // = Random access iterator definitions
+  typedef T *iterator;
+  typedef const T *const_iterator;
+
+  constexpr iterator begin (void);
+  constexpr const_iterator begin (void) const;
+  constexpr iterator end (void);
+  constexpr const_iterator end (void) const;
+
+  // Get a pointer to the first element of the array.
+  constexpr T *data (void);
+  constexpr const T *data (void) const;
+
+  // = Set/get methods.
+
+  // Set an item in the array at location index.  Throws
+  // <std::out_of_range> if <index> is not <in_range>.
+  constexpr void set (const T &new_item, size_t index);
+  constexpr void set (T &&new_item, size_t index);
+
+  // Replace the item at location index with one built from <args>.
+  // Throws <std::out_of_range> if <index> is not <in_range>.
+  template <typename... ARGS>
+  constexpr T &emplace (size_t index, ARGS &&... args);
+
+  // Get an item in the array at location index.  Throws
+  // <std::out_of_range> if <index> is not <in_range>.
+  constexpr void get (T &item, size_t index) const;
+
+  // Returns the size of the array, which is always <N>.
+  static constexpr size_t size (void) { return N; }
+
+  // Same as <size>.
+  static constexpr size_t capacity (void) { return N; }
+
+  // Element access, checked only if ARRAY_BOUNDS_CHECK is enabled.
+  constexpr const T &operator[] (size_t index) const;
+  constexpr T &operator[] (size_t index);
+
+  // Element access that always throws <std::out_of_range> if <index>
+  // is not <in_range>.
+  constexpr const T &at (size_t index) const;
+  constexpr T &at (size_t index);
+
+  // Compare this array with <s> for (in)equality.
+  constexpr bool operator== (const StaticArray<T, N> &s) const;
+  constexpr bool operator!= (const StaticArray<T, N> &s) const;
+
+  // Set all the elements to <value>.
+  constexpr void fill (const T &value);
+
+  // Swap the elements of this array with those of <new_array>, one by
+  // one.
+  constexpr void swap (StaticArray<T, N> &new_array);
+
+private:
+  // Returns true if <index> is within range.
+  static constexpr bool in_range (size_t index);
+
+  // Throws <std::length_error> unless <size> is <N>.
+  static constexpr size_t check_size (size_t size);
+
+  // The elements.
+  T array_[N];
+};
+
+template <typename T, size_t N> constexpr size_t
+StaticArray<T, N>::check_size (size_t size)
+{
+	if (size != N) throw std::length_error("StaticArray size mismatch");
+	return size;
+}
+
+template <typename T, size_t N> constexpr
+StaticArray<T, N>::StaticArray (size_t size) : array_ ()
+{
+	check_size (size);
+}
+
+template <typename T, size_t N> constexpr
+StaticArray<T, N>::StaticArray (size_t size,
+				const T &default_value) : array_ ()
+{
+	check_size (size);
+	fill (default_value);
+}
+
+template <typename T, size_t N> constexpr bool
+StaticArray<T, N>::in_range (size_t index)
+{
+	return index < N;
+}
+
+// = Iterators.
+
+template <typename T, size_t N> constexpr typename StaticArray<T, N>::iterator
+StaticArray<T, N>::begin (void)
+{
+	return array_;
+}
+
+template <typename T, size_t N> constexpr typename StaticArray<T, N>::const_iterator
+StaticArray<T, N>::begin (void) const
+{
+	return array_;
+}
+
+template <typename T, size_t N> constexpr typename StaticArray<T, N>::iterator
+StaticArray<T, N>::end (void)
+{
+	return array_ + N;
+}
+
+template <typename T, size_t N> constexpr typename StaticArray<T, N>::const_iterator
+StaticArray<T, N>::end (void) const
+{
+	return array_ + N;
+}
+
+template <typename T, size_t N> constexpr T *
+StaticArray<T, N>::data (void)
+{
+	return array_;
+}
+
+template <typename T, size_t N> constexpr const T *
+StaticArray<T, N>::data (void) const
+{
+	return array_;
+}
+
+// = Set/get methods.
+
+template <typename T, size_t N> constexpr void
+StaticArray<T, N>::set (const T &new_item, size_t index)
+{
+	if (!in_range (index)) throw std::out_of_range("Index out of range");
+	array_[index] = new_item;
+}
+
+template <typename T, size_t N> constexpr void
+StaticArray<T, N>::set (T &&new_item, size_t index)
+{
+	if (!in_range (index)) throw std::out_of_range("Index out of range");
+	array_[index] = std::move (new_item);
+}
+
+template <typename T, size_t N> template <typename... ARGS> constexpr T &
+StaticArray<T, N>::emplace (size_t index, ARGS &&... args)
+{
+	if (!in_range (index)) throw std::out_of_range("Index out of range");
+	array_[index] = T (std::forward<ARGS> (args)...);
+	return array_[index];
+}
+
+template <typename T, size_t N> constexpr void
+StaticArray<T, N>::get (T &item, size_t index) const
+{
+	if (!in_range (index)) throw std::out_of_range("Index out of range");
+	item = array_[index];
+}
+
+template <typename T, size_t N> constexpr const T &
+StaticArray<T, N>::operator[] (size_t index) const
+{
+	if (ARRAY_BOUNDS_CHECK && !in_range(index)) throw std::out_of_range("Value out of range");
+	return array_[index];
+}
+
+template <typename T, size_t N> constexpr T &
+StaticArray<T, N>::operator[] (size_t index)
+{
+	if (ARRAY_BOUNDS_CHECK && !in_range(index)) throw std::out_of_range("Value out of range");
+	return array_[index];
+}
+
+template <typename T, size_t N> constexpr const T &
+StaticArray<T, N>::at (size_t index) const
+{
+	if (!in_range(index)) throw std::out_of_range("Value out of range");
+	return array_[index];
+}
+
+template <typename T, size_t N> constexpr T &
+StaticArray<T, N>::at (size_t index)
+{
+	if (!in_range(index)) throw std::out_of_range("Value out of range");
+	return array_[index];
+}
+
+template <typename T, size_t N> constexpr bool
+StaticArray<T, N>::operator== (const StaticArray<T, N> &s) const
+{
+	return std::equal (array_, array_+N, s.array_);
+}
+
+template <typename T, size_t N> constexpr bool
+StaticArray<T, N>::operator!= (const StaticArray<T, N> &s) const
+{
+	return !(*this == s);
+}
+
+template <typename T, size_t N> constexpr void
+StaticArray<T, N>::fill (const T &value)
+{
+	std::fill (array_, array_+N, value);
+}
+
+template <typename T, size_t N> constexpr void
+StaticArray<T, N>::swap (StaticArray<T, N> &new_array)
+{
+	std::swap_ranges (array_, array_+N, new_array.array_);
+}
+
+#endif /* STATIC_ARRAY_H */
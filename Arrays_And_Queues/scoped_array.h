@@ -4,48 +4,145 @@
 #define _SCOPED_ARRAY
 
 #include <cstddef>
-
-// scoped_array extends auto_ptr to arrays. Deletion of the array
-// pointed to is guaranteed, either on destruction of the scoped_array
-// or via an explicit reset().  This implementation is based on the
-// boost scoped_array class. 
-
-template <typename T> 
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// True if <ALLOC> has an allocate_zeroed(n) member that returns storage
+// whose bytes are all zero and that deallocate() releases.
+template <typename ALLOC, typename = void>
+struct has_allocate_zeroed : std::false_type {};
+
+template <typename ALLOC>
+struct has_allocate_zeroed<ALLOC, std::void_t<decltype (std::declval<ALLOC &> ().allocate_zeroed (size_t ()))> >
+  : std::true_type {};
+
+// scoped_array owns a buffer of raw, uninitialized storage for <T>
+// objects obtained from an allocator of type <ALLOC> (any standard
+// conforming allocator, e.g., std::allocator or
+// std::pmr::polymorphic_allocator).  Deallocation of the buffer is
+// guaranteed, either on destruction of the scoped_array or via an
+// explicit reset().  The scoped_array never constructs or destroys the
+// <T>s that live in the buffer; its owner is responsible for
+// constructing them (e.g., via allocator_traits::construct) and
+// destroying them before the buffer is released.  This implementation
+// is based on the boost scoped_array class.
+
+template <typename T, typename ALLOC = std::allocator<T> > 
 class scoped_array 
 {
 public:
   typedef T value_type;
+  typedef ALLOC allocator_type;
+  typedef std::allocator_traits<ALLOC> traits;
+
+  // Start out without a buffer.
+
+  explicit scoped_array (const ALLOC &alloc = ALLOC ()) // never throws
+    : alloc_ (alloc), ptr_ (0), size_ (0), calloced_ (false)
+  {
+  }
+
+  // Allocate an uninitialized buffer for <n> objects.  No memory is
+  // allocated if <n> is 0.  Throws <std::bad_alloc> if allocation
+  // fails.
+
+  explicit scoped_array (size_t n, const ALLOC &alloc = ALLOC ())
+    : alloc_ (alloc), ptr_ (allocate (n)), size_ (n), calloced_ (false)
+  {
+  }
 
-  // Stash the array pointer away for later use.
+  // Same as above, but if <zeroed> the buffer's bytes are all zero.
+  // Allocators with an allocate_zeroed() member are asked for zeroed
+  // storage, and std::allocator buffers come from calloc(), so large
+  // buffers are mapped straight from the kernel and their pages are
+  // only materialized when first touched.  Other allocators' buffers
+  // are cleared with memset.
 
-  explicit scoped_array (T *p = 0) : ptr_ (p) // never throws
+  scoped_array (size_t n, const ALLOC &alloc, bool zeroed)
+    : alloc_ (alloc), ptr_ (0), size_ (n), calloced_ (false)
   {
+    ptr_ = zeroed ? allocate_zeroed (n) : allocate (n);
   }
 
-  // Delete the array pointer.
+  // Release the buffer.
 
   ~scoped_array () // never throws
   {
-    delete [] this->ptr_;
+    deallocate (this->ptr_, this->size_);
+  }
+
+  // Allocate an uninitialized buffer for <n> objects from our
+  // allocator.  Returns 0 if <n> is 0.
+
+  T *allocate (size_t n)
+  {
+    return n == 0 ? 0 : traits::allocate (this->alloc_, n);
+  }
+
+  // Allocate a buffer for <n> objects whose bytes are all zero, as
+  // described above.  Returns 0 if <n> is 0.
+
+  T *allocate_zeroed (size_t n)
+  {
+    if (n == 0)
+      return 0;
+    if constexpr (has_allocate_zeroed<ALLOC>::value)
+      return this->alloc_.allocate_zeroed (n);
+    else if constexpr (std::is_same<ALLOC, std::allocator<T> >::value
+                       && alignof (T) <= alignof (std::max_align_t))
+      {
+        void *p = std::calloc (n, sizeof (T));
+        if (p == 0)
+          throw std::bad_alloc ();
+        this->calloced_ = true;
+        return static_cast<T *> (p);
+      }
+    else
+      {
+        T *p = allocate (n);
+        std::memset (static_cast<void *> (p), 0, n * sizeof (T));
+        return p;
+      }
+  }
+
+  // Release our own buffer <p> of <n> objects.
+
+  void deallocate (T *p, size_t n) // never throws
+  {
+    if (p == 0)
+      return;
+    if (this->calloced_)
+      std::free (p);
+    else
+      traits::deallocate (this->alloc_, p, n);
   }
 
   // Releases ownership of the underlying pointer. Returns that pointer.
+  // The caller must later pass it to traits::deallocate, so this may
+  // not be used on a buffer allocated zeroed from std::allocator.
 
   T *release (void) 
   {
     T *old = this->ptr_;
     this->ptr_ = 0;
+    this->size_ = 0;
+    this->calloced_ = false;
     return old;
   }
 
-  // Requires that p points to an object of class T or a class derived
-  // from T for which delete p is defined and accessible, or p is a
-  // null pointer. Deletes the current underlying pointer, then resets
-  // it to p.
+  // Requires that p is a null pointer or was obtained from
+  // allocate(<n>).  Releases the current buffer, then resets it to p.
 
-  void reset (T *p = 0) // never throws
+  void reset (T *p = 0, size_t n = 0) // never throws
   {
-    this_type (p).swap (*this);
+    deallocate (this->ptr_, this->size_);
+    this->ptr_ = p;
+    this->size_ = n;
+    this->calloced_ = false;
   }
 
   // Return the subscript into the array.
@@ -62,38 +159,59 @@ public:
     return this->ptr_;
   }
 
-  // Implicit conversion to "bool"
-  bool operator! () const // never throws
+  // Return the number of <T>s the buffer has room for.
+
+  size_t size() const // never throws
   {
-    return this->ptr_ == 0;
+    return this->size_;
   }
 
-  // Swap the contents of this scoped array with <b>.
+  // Return the allocator used for the buffer.
 
-  void swap (scoped_array<T> &b) // never throws
+  ALLOC &get_allocator () // never throws
   {
-    T *tmp = b.ptr_;
-    b.ptr_ = this->ptr_;
-    this->ptr_ = tmp;
+    return this->alloc_;
   }
 
-  // Swap the contents of pointer <b> with <ptr_>.
+  const ALLOC &get_allocator () const // never throws
+  {
+    return this->alloc_;
+  }
 
-  void swap (T *&b) // never throws
+  // Implicit conversion to "bool"
+  bool operator! () const // never throws
   {
-    T *tmp = b;
-    b = this->ptr_;
-    this->ptr_ = tmp;
+    return this->ptr_ == 0;
+  }
+
+  // Swap the contents of this scoped array with <b>.  The allocators
+  // are only swapped if <ALLOC> propagates on swap; otherwise they
+  // must compare equal.
+
+  void swap (scoped_array<T, ALLOC> &b) // never throws
+  {
+    if constexpr (traits::propagate_on_container_swap::value)
+      std::swap (this->alloc_, b.alloc_);
+    std::swap (this->ptr_, b.ptr_);
+    std::swap (this->size_, b.size_);
+    std::swap (this->calloced_, b.calloced_);
   }
 
 private:
+  // Allocator that owns the buffer.
+  [[no_unique_address]] ALLOC alloc_;
+
   T *ptr_;
 
-  // Disallow copying
-  scoped_array (const scoped_array<T> &);
-  scoped_array &operator=(const scoped_array<T> &);
+  // Number of <T>s that <ptr_> has room for.
+  size_t size_;
 
-  typedef scoped_array<T> this_type;
+  // True if <ptr_> came from calloc() and must go back to free().
+  bool calloced_;
+
+  // Disallow copying
+  scoped_array (const scoped_array<T, ALLOC> &);
+  scoped_array &operator=(const scoped_array<T, ALLOC> &);
 };
 
 #endif /* _SCOPED_ARRAY_H */